@@ -40,6 +40,7 @@ int main(void) {
     VM *vm = vm_create();
     if (!vm) { fprintf(stderr, "vm_create failed\n"); return 1; }
     vm_reset(vm);
+    vm_nvram_file(vm, "nvram.bin");
 
     if (!vm_add_ram(vm, 512u * 1024u * 1024u)) {
         fprintf(stderr, "vm_add_ram(512MiB) failed\n");
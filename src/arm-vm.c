@@ -2,13 +2,17 @@
 #include <stdio.h>      // printf, stdin
 #include <stdbool.h>    // bool, true/false
 #include <stddef.h>     // NULL
+#include <string.h>     // strcmp
 
 #include "vm.h"         // VM*, vm_create(), vm_destroy(), vm_reset()
 #include "cli.h"        // CLI, cli_init(), cli_run()
-#include "dev_uart.h"        // CLI, cli_init(), cli_run()
+#include "batch.h"      // batch_main()
 
 int main(int argc, char **argv) {
-    (void)argc; (void)argv;
+    // arm-vm batch <manifest> [out <file>] [threads <n>] [tcache <dir>]: no REPL, exit
+    // status 0 only if every job passed.
+    if (argc >= 2 && strcmp(argv[1], "batch") == 0)
+        return batch_main(argc - 1, argv + 1) == 0 ? 0 : 1;
 
     // If you eventually add a logger with log_init(), include "log.h" and call it here.
 
@@ -18,6 +22,7 @@ int main(int argc, char **argv) {
         return 1;
     }
     vm_reset(vm);
+    vm_nvram_file(vm, "nvram.bin");   // the interactive VM keeps its NVRAM
 
 
 	// Hard-code 512 MiB (constant already in cpu.h)
@@ -25,10 +30,7 @@ int main(int argc, char **argv) {
 		fprintf(stderr, "vm_add_ram(512M) failed\n");
 		return 1;
 	}
-	
-	dev_uart_init(0x09000000u);           // <-- add this
-
-	// dev_uart_write_reg(0x09000000u, (uint32_t)'!');  // TEMP: should print "!"
+	// RTC, NVRAM and the UART (0x09000000) are mapped by vm_add_ram().
 
     CLI cli;
     cli_init(&cli, vm, stdin, true);
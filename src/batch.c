@@ -0,0 +1,434 @@
+// src/batch.c — parallel batch runner
+// Manifest: one job per line, '#' starts a comment.
+//
+//   <image> [name=<s>] [addr=<a>] [pc=<a>] [ram=<bytes>] [max=<cycles>]
+//           [r<n>=<v>] [cpsr=<v>] [halted=0|1] [uart="<text>"] [nvram=<file>]
+//
+// addr defaults to 0x8000, pc to addr, ram to 16 MiB, max to 10M cycles.
+// r<n>, cpsr and uart (C escapes \n \t \" \\) are checked against the final
+// state; the job must also halt unless halted=0. Relative image and nvram
+// paths are taken from the manifest's directory. Without nvram= a job's
+// NVRAM starts blank and lives in memory, so no job sees another's writes.
+//
+// Jobs are dealt round-robin onto per-worker deques. A worker pops from the
+// back of its own deque and, once that is empty, steals from the front of
+// the others, so a few slow images don't leave the rest of the pool idle.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>    // sysconf
+
+#include "batch.h"
+#include "vm.h"
+#include "log.h"
+#include "dev_uart.h"
+
+#define BATCH_MAX_THREADS 256
+#define BATCH_UART_CAP    4096u
+
+typedef struct {
+    // from the manifest
+    char      name[64];
+    char      path[260];
+    char      nvram[260];          // NVRAM backing file, "" = memory only
+    uint32_t  addr, pc;
+    size_t    ram;
+    uint64_t  max;
+    uint16_t  reg_mask;            // bit n: r<n> is checked
+    uint32_t  reg[16];
+    bool      want_cpsr;
+    uint32_t  cpsr;
+    bool      want_halted;
+    char     *uart;                // expected UART output, NULL = unchecked
+
+    // results
+    bool      pass;
+    bool      halted;
+    uint64_t  cycles;
+    double    ms;
+    char      why[160];            // first failed check
+    uint32_t  r[16], final_cpsr;
+} batch_job;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int            *ids;
+    int             head, tail;    // owner pops tail-1, thieves take head
+} batch_deque;
+
+typedef struct {
+    batch_job   *jobs;
+    batch_deque *dq;
+    int          nworkers;
+} batch_pool;
+
+typedef struct {
+    batch_pool *pool;
+    int         self;
+} batch_worker;
+
+// -----------------------------------------------------------------------------
+// Manifest parsing
+// -----------------------------------------------------------------------------
+
+// Next whitespace-separated token; a '"' starts a quoted run with C escapes.
+// Tokens are unescaped in place. NULL at end of line.
+static char *next_token(char **cur) {
+    char *s = *cur;
+    while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') s++;
+    if (!*s || *s == '#') return NULL;
+
+    char *tok = s, *out = s;
+    bool quoted = false;
+    for (; *s; s++) {
+        if (!quoted && (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')) break;
+        if (*s == '"') { quoted = !quoted; continue; }
+        if (quoted && *s == '\\' && s[1]) {
+            s++;
+            switch (*s) {
+                case 'n': *out++ = '\n'; break;
+                case 't': *out++ = '\t'; break;
+                case 'r': *out++ = '\r'; break;
+                default:  *out++ = *s;   break;
+            }
+            continue;
+        }
+        *out++ = *s;
+    }
+    if (*s) s++;
+    *out = '\0';
+    *cur = s;
+    return tok;
+}
+
+static bool parse_u64(const char *s, uint64_t *out) {
+    char *end;
+    if (!*s) return false;
+    unsigned long long v = strtoull(s, &end, 0);
+    if (*end) return false;
+    *out = v;
+    return true;
+}
+
+// A manifest path: absolute, or relative to the manifest's directory.
+static void manifest_path(char *out, size_t cap, const char *dir, const char *p) {
+    if (p[0] == '/' || !dir[0]) snprintf(out, cap, "%s", p);
+    else                        snprintf(out, cap, "%s/%s", dir, p);
+}
+
+static bool parse_job(batch_job *j, char *line, const char *dir, int lineno) {
+    char *cur = line;
+    char *img = next_token(&cur);
+    if (!img) return false;
+
+    memset(j, 0, sizeof *j);
+    j->addr = 0x8000;
+    j->pc   = UINT32_MAX;
+    j->ram  = 16u << 20;
+    j->max  = 10000000u;
+    j->want_halted = true;
+
+    manifest_path(j->path, sizeof j->path, dir, img);
+    snprintf(j->name, sizeof j->name, "%s", img);
+
+    for (char *t; (t = next_token(&cur)) != NULL; ) {
+        char *eq = strchr(t, '=');
+        if (!eq) {
+            log_printf("[BATCH] line %d: expected key=value, got '%s'\n", lineno, t);
+            return false;
+        }
+        *eq = '\0';
+        const char *k = t, *v = eq + 1;
+        uint64_t n = 0;
+        bool ok = true;
+
+        if (!strcmp(k, "name")) {
+            snprintf(j->name, sizeof j->name, "%s", v);
+        } else if (!strcmp(k, "nvram")) {
+            manifest_path(j->nvram, sizeof j->nvram, dir, v);
+        } else if (!strcmp(k, "uart")) {
+            free(j->uart);
+            j->uart = strdup(v);
+        } else if (!(ok = parse_u64(v, &n))) {
+            // bad number, reported below
+        } else if (!strcmp(k, "addr"))   { j->addr = (uint32_t)n;
+        } else if (!strcmp(k, "pc"))     { j->pc = (uint32_t)n;
+        } else if (!strcmp(k, "ram"))    { j->ram = (size_t)n;
+        } else if (!strcmp(k, "max"))    { j->max = n;
+        } else if (!strcmp(k, "cpsr"))   { j->want_cpsr = true; j->cpsr = (uint32_t)n;
+        } else if (!strcmp(k, "halted")) { j->want_halted = n != 0;
+        } else if (k[0] == 'r' && k[1] >= '0' && k[1] <= '9') {
+            int r = atoi(k + 1);
+            ok = r >= 0 && r < 16;
+            if (ok) { j->reg_mask |= (uint16_t)(1u << r); j->reg[r] = (uint32_t)n; }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            log_printf("[BATCH] line %d: bad option '%s=%s'\n", lineno, k, v);
+            free(j->uart);
+            j->uart = NULL;
+            return false;
+        }
+    }
+    if (j->pc == UINT32_MAX) j->pc = j->addr;
+    return true;
+}
+
+// Jobs in manifest order; -1 on a read or syntax error.
+static int load_manifest(const char *path, batch_job **out) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        log_printf("[BATCH] cannot open manifest '%s'\n", path);
+        return -1;
+    }
+
+    char dir[260] = "";
+    const char *slash = strrchr(path, '/');
+    if (slash) snprintf(dir, sizeof dir, "%.*s", (int)(slash - path), path);
+
+    batch_job *jobs = NULL;
+    int n = 0, cap = 0, lineno = 0;
+    bool ok = true;
+    char line[1024];
+    while (ok && fgets(line, sizeof line, f)) {
+        lineno++;
+        const char *p = line + strspn(line, " \t\r\n");
+        if (!*p || *p == '#') continue;             // blank or comment
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            batch_job *nj = (batch_job*)realloc(jobs, (size_t)cap * sizeof *jobs);
+            if (!nj) { ok = false; break; }
+            jobs = nj;
+        }
+        ok = parse_job(&jobs[n], line, dir, lineno);
+        if (ok) n++;
+    }
+    fclose(f);
+
+    if (!ok) {
+        for (int i = 0; i < n; i++) free(jobs[i].uart);
+        free(jobs);
+        return -1;
+    }
+    *out = jobs;
+    return n;
+}
+
+// -----------------------------------------------------------------------------
+// Running one job
+// -----------------------------------------------------------------------------
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void run_job(batch_job *j) {
+    double t0 = now_ms();
+    size_t cap = BATCH_UART_CAP;
+    if (j->uart && strlen(j->uart) + 2 > cap) cap = strlen(j->uart) + 2;
+    char *uart = (char*)malloc(cap);
+    VM *vm = vm_create();
+    if (vm) vm_nvram_file(vm, j->nvram[0] ? j->nvram : NULL);
+
+    if (!uart || !vm || !vm_add_ram(vm, j->ram)) {
+        snprintf(j->why, sizeof j->why, "cannot create a VM with %zu bytes of RAM", j->ram);
+        goto done;
+    }
+    dev_uart_set_capture(uart, cap);
+    if (!vm_load_binary(vm, j->path, j->addr)) {
+        snprintf(j->why, sizeof j->why, "cannot load %.*s at 0x%08X",
+                 (int)(sizeof j->why - 32), j->path, j->addr);
+        goto done;
+    }
+    vm_set_reg(vm, 15, j->pc);
+    j->halted = !vm_run(vm, j->max);
+    j->cycles = vm_cycles(vm);
+    for (int r = 0; r < 16; r++) j->r[r] = vm_get_reg(vm, r);
+    j->final_cpsr = vm_get_cpsr(vm);
+
+    j->pass = true;
+    if (j->want_halted && !j->halted) {
+        snprintf(j->why, sizeof j->why, "no halt within %" PRIu64 " cycles", j->max);
+        j->pass = false;
+    }
+    for (int r = 0; j->pass && r < 16; r++) {
+        if ((j->reg_mask >> r & 1u) && j->r[r] != j->reg[r]) {
+            snprintf(j->why, sizeof j->why, "r%d = 0x%08X, expected 0x%08X", r, j->r[r], j->reg[r]);
+            j->pass = false;
+        }
+    }
+    if (j->pass && j->want_cpsr && j->final_cpsr != j->cpsr) {
+        snprintf(j->why, sizeof j->why, "cpsr = 0x%08X, expected 0x%08X", j->final_cpsr, j->cpsr);
+        j->pass = false;
+    }
+    if (j->pass && j->uart && strcmp(uart, j->uart) != 0) {
+        snprintf(j->why, sizeof j->why, "uart output differs (%zu bytes)", dev_uart_captured());
+        j->pass = false;
+    }
+
+done:
+    vm_destroy(vm);
+    free(uart);
+    j->ms = now_ms() - t0;
+}
+
+// -----------------------------------------------------------------------------
+// Work-stealing pool
+// -----------------------------------------------------------------------------
+static int deque_pop(batch_deque *d) {
+    int id = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) id = d->ids[--d->tail];
+    pthread_mutex_unlock(&d->lock);
+    return id;
+}
+
+static int deque_steal(batch_deque *d) {
+    int id = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) id = d->ids[d->head++];
+    pthread_mutex_unlock(&d->lock);
+    return id;
+}
+
+static void *worker_main(void *arg) {
+    batch_worker *w = (batch_worker*)arg;
+    batch_pool   *p = w->pool;
+    log_set_quiet(true);
+
+    for (;;) {
+        int id = deque_pop(&p->dq[w->self]);
+        // Nothing is queued after start, so a full sweep that finds every
+        // deque empty means the batch is done for this worker.
+        for (int k = 1; id < 0 && k < p->nworkers; k++)
+            id = deque_steal(&p->dq[(w->self + k) % p->nworkers]);
+        if (id < 0) break;
+        run_job(&p->jobs[id]);
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Results
+// -----------------------------------------------------------------------------
+static void json_str(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')  fprintf(f, "\\%c", c);
+        else if (c == '\n')         fputs("\\n", f);
+        else if (c < 0x20)          fprintf(f, "\\u%04x", c);
+        else                        fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static bool write_results(const char *path, const batch_job *jobs, int n) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    for (int i = 0; i < n; i++) {
+        const batch_job *j = &jobs[i];
+        fputs("{\"name\":", f);
+        json_str(f, j->name);
+        fprintf(f, ",\"pass\":%s,\"halted\":%s,\"cycles\":%" PRIu64 ",\"ms\":%.3f",
+                j->pass ? "true" : "false", j->halted ? "true" : "false", j->cycles, j->ms);
+        fputs(",\"regs\":[", f);
+        for (int r = 0; r < 16; r++) fprintf(f, "%s%u", r ? "," : "", j->r[r]);
+        fprintf(f, "],\"cpsr\":%u", j->final_cpsr);
+        if (!j->pass) { fputs(",\"error\":", f); json_str(f, j->why); }
+        fputs("}\n", f);
+    }
+    return fclose(f) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Entry points
+// -----------------------------------------------------------------------------
+int batch_run(const char *manifest, const char *out_path, int threads) {
+    batch_job *jobs = NULL;
+    int n = load_manifest(manifest, &jobs);
+    if (n < 0) return -1;
+    if (n == 0) {
+        log_printf("[BATCH] %s: no jobs\n", manifest);
+        return 0;
+    }
+
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (threads > BATCH_MAX_THREADS) threads = BATCH_MAX_THREADS;
+    if (threads > n) threads = n;
+
+    batch_pool    pool = { .jobs = jobs, .nworkers = threads };
+    batch_deque  *dq   = (batch_deque*)calloc((size_t)threads, sizeof *dq);
+    int          *ids  = (int*)malloc((size_t)n * sizeof *ids);
+    batch_worker *w    = (batch_worker*)calloc((size_t)threads, sizeof *w);
+    pthread_t    *tid  = (pthread_t*)calloc((size_t)threads, sizeof *tid);
+    int failed = -1;
+    if (!dq || !ids || !w || !tid) goto out;
+    pool.dq = dq;
+
+    // Deal jobs round-robin; each deque gets a contiguous slice of ids[].
+    int filled = 0;
+    for (int t = 0; t < threads; t++) {
+        pthread_mutex_init(&dq[t].lock, NULL);
+        dq[t].ids = ids + filled;
+        for (int i = t; i < n; i += threads) dq[t].ids[dq[t].tail++] = i;
+        filled += dq[t].tail;
+    }
+
+    double t0 = now_ms();
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        w[t] = (batch_worker){ .pool = &pool, .self = t };
+        if (pthread_create(&tid[t], NULL, worker_main, &w[t]) != 0) break;
+        started++;
+    }
+    if (started == 0) worker_main(&w[0]);   // no threads: run inline
+    for (int t = 0; t < started; t++) pthread_join(tid[t], NULL);
+    log_set_quiet(false);
+    double ms = now_ms() - t0;
+
+    failed = 0;
+    for (int i = 0; i < n; i++) {
+        if (jobs[i].pass) continue;
+        failed++;
+        log_printf("[BATCH] FAIL %s: %s\n", jobs[i].name, jobs[i].why);
+    }
+    log_printf("[BATCH] %d jobs, %d passed, %d failed (%d threads, %.1f ms)\n",
+               n, n - failed, failed, started ? started : 1, ms);
+
+    if (out_path && !write_results(out_path, jobs, n))
+        log_printf("[BATCH] cannot write results to '%s'\n", out_path);
+
+    for (int t = 0; t < threads; t++) pthread_mutex_destroy(&dq[t].lock);
+out:
+    for (int i = 0; i < n; i++) free(jobs[i].uart);
+    free(jobs);
+    free(dq); free(ids); free(w); free(tid);
+    return failed;
+}
+
+int batch_main(int argc, char **argv) {
+    const char *usage = "usage: batch <manifest> [out <file>] [threads <n>] [tcache <dir>]\n";
+    if (argc < 2 || argc % 2 != 0) { log_printf("%s", usage); return -1; }
+
+    const char *out = NULL;
+    int threads = 0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if      (!strcmp(argv[i], "out"))     out = argv[i + 1];
+        else if (!strcmp(argv[i], "threads")) threads = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "tcache"))  vm_tcache_default_dir(argv[i + 1]);
+        else { log_printf("%s", usage); return -1; }
+    }
+    return batch_run(argv[1], out, threads);
+}
@@ -10,8 +10,12 @@
 #include "cli.h"
 #include "log.h"
 #include "vm.h"
+#include "cpu.h"   // CPU_ENGINE_*
 #include "debug.h"   // for debug_flags_t and DBG_* bits
 #include "dev_disk.h"
+#include "batch.h"
+#include "trace.h"     // trace_decode()
+#include "execute.h"   // execute_stats_*()
 
 static int ieq(const char* a, const char* b) {
     while (*a && *b) { if (tolower((unsigned char)*a++) != tolower((unsigned char)*b++)) return 0; }
@@ -27,6 +31,7 @@ static debug_flags_t debug_name_to_bit(const char* name) {
     if (ieq(name, "IRQ"))       return DBG_IRQ;
     if (ieq(name, "DISASM"))    return DBG_DISASM;
     if (ieq(name, "K12"))       return DBG_K12;
+    if (ieq(name, "K12STATS"))  return DBG_K12STATS;
     if (ieq(name, "TRACE"))     return DBG_TRACE;
     if (ieq(name, "CLI"))       return DBG_CLI;
     if (ieq(name, "ALL"))       return DBG_ALL;
@@ -100,7 +105,7 @@ static const char* find_eq_rhs(const char* token, const char* next_or_null) {
 }
 
 // cpu.c exports this global; we update it when "set cpu debug=..." is used
-extern debug_flags_t debug_flags;
+extern VM_TLS debug_flags_t debug_flags;
 
 // ---- command table ----
 typedef int (*cmd_fn)(CLI*, int argc, char **argv);   // 0=ok, -1=err, +1=quit
@@ -119,6 +124,12 @@ static int cmd_clrhalt (CLI*, int, char**);
 static int cmd_step    (CLI*, int, char**);
 static int cmd_version (CLI *cli, int argc, char **argv);
 static int cmd_examine (CLI *cli, int argc, char **argv);
+static int cmd_snapshot(CLI*, int, char**);
+static int cmd_batch   (CLI*, int, char**);
+static int cmd_trace   (CLI*, int, char**);
+static int cmd_profile (CLI*, int, char**);
+static int cmd_k12stats(CLI*, int, char**);
+static int cmd_tcache  (CLI*, int, char**);
 
 static const cmd_t CMDS[] = {
     {"run",      cmd_run,     "Run until halt"},
@@ -127,11 +138,17 @@ static const cmd_t CMDS[] = {
 	{"e",        cmd_examine, "examine memory (e addr[-end])" },
 	{"clrhalt",  cmd_clrhalt, "clear CPU halt" },
 	{"step",     cmd_step,    "step [N] (default 1)" },
-	{"attach",   cmd_attach,  "attach disk0 <image>"},
+	{"attach",   cmd_attach,  "attach disk0 <image> [overlay <delta>] (guest writes go to <image> unless overlaid)"},
+	{"snapshot", cmd_snapshot, "snapshot save|load <file>"},
+	{"batch",    cmd_batch,   "batch <manifest> [out <file>] [threads <n>] [tcache <dir>]"},
+	{"trace",    cmd_trace,   "trace on <file> | trace off | trace decode <file> [<out>]"},
+	{"profile",  cmd_profile, "profile on | off | report [<n>] | map <file>"},
+	{"k12stats", cmd_k12stats, "k12stats on | off | show [<n>] | csv <file> | reset"},
+	{"tcache",   cmd_tcache,  "tcache dir <path> | off | save"},
 	{"version",  cmd_version, "show emulator version" },
     {"logfile",  cmd_logfile, "logfile <path>"},
     {"do",       cmd_do,      "do <scriptfile>"},
-    {"set",      cmd_set,     "set rN <val> | set pc <val> | set cpu debug=<flag>"},
+    {"set",      cmd_set,     "set rN <val> | set pc <val> | set cpu debug=<flag> | set cpu engine=step|threaded"},
     {"quit",     cmd_quit,    "Exit"},
 };
 
@@ -254,13 +271,113 @@ static int cmd_examine(CLI *cli, int argc, char **argv) {
 
 static int cmd_attach(CLI *cli, int argc, char **argv) {
     (void)cli;
-    if (argc < 3) { log_printf("usage: attach disk0 <image>\n"); return -1; }
+    if (argc < 3 || (argc > 3 && (argc != 5 || strcmp(argv[3], "overlay") != 0))) {
+        log_printf("usage: attach disk0 <image> [overlay <delta>]\n");
+        return -1;
+    }
     if (strcmp(argv[1], "disk0") != 0) {
         log_printf("[ERROR] unknown device: %s\n", argv[1]);
         return -1;
     }
-    if (!dev_disk0_attach(cli->vm, argv[2])) return -1;
-    return 0;
+    bool ok = (argc == 5) ? dev_disk0_attach_overlay(cli->vm, argv[2], argv[4])
+                          : dev_disk0_attach(cli->vm, argv[2]);
+    return ok ? 0 : -1;
+}
+
+static int cmd_snapshot(CLI *cli, int argc, char **argv) {
+    if (argc != 3) { log_printf("usage: snapshot save|load <file>\n"); return -1; }
+    bool ok;
+    if      (strcmp(argv[1], "save") == 0) ok = vm_snapshot_save(cli->vm, argv[2]);
+    else if (strcmp(argv[1], "load") == 0) ok = vm_snapshot_load(cli->vm, argv[2]);
+    else { log_printf("usage: snapshot save|load <file>\n"); return -1; }
+    return ok ? 0 : -1;
+}
+
+// Runs in fresh VMs on worker threads; the CLI's own VM is left alone.
+static int cmd_batch(CLI *cli, int argc, char **argv) {
+    (void)cli;
+    return batch_main(argc, argv) == 0 ? 0 : -1;
+}
+
+static int cmd_trace(CLI *cli, int argc, char **argv) {
+    const char *usage = "usage: trace on <file> | trace off | trace decode <file> [<out>]\n";
+    bool ok;
+    if      (argc == 3 && strcmp(argv[1], "on") == 0)     ok = vm_trace_start(cli->vm, argv[2]);
+    else if (argc == 2 && strcmp(argv[1], "off") == 0)    ok = vm_trace_stop(cli->vm);
+    else if ((argc == 3 || argc == 4) && strcmp(argv[1], "decode") == 0)
+        ok = trace_decode(argv[2], argc == 4 ? argv[3] : NULL);
+    else { log_printf("%s", usage); return -1; }
+    return ok ? 0 : -1;
+}
+
+static int cmd_profile(CLI *cli, int argc, char **argv) {
+    const char *usage = "usage: profile on | profile off | profile report [<n>] | profile map <file>\n";
+    if (argc == 2 && strcmp(argv[1], "on") == 0)  return vm_profile_start(cli->vm) ? 0 : -1;
+    if (argc == 2 && strcmp(argv[1], "off") == 0) { vm_profile_stop(cli->vm); return 0; }
+    if (argc == 3 && strcmp(argv[1], "map") == 0) return vm_profile_load_map(cli->vm, argv[2]) ? 0 : -1;
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "report") == 0) {
+        unsigned top = 10;
+        if (argc == 3) {
+            uint32_t v;
+            if (!parse_u32(argv[2], &v) || v == 0) { log_printf("%s", usage); return -1; }
+            top = v;
+        }
+        vm_profile_report(cli->vm, top);
+        return 0;
+    }
+    log_printf("%s", usage);
+    return -1;
+}
+
+// Predecoded blocks on disk. The directory also applies to VMs created
+// later (batch jobs), and to images loaded after this command.
+static int cmd_tcache(CLI *cli, int argc, char **argv) {
+    const char *usage = "usage: tcache dir <path> | tcache off | tcache save\n";
+    if (argc == 3 && strcmp(argv[1], "dir") == 0) {
+        vm_tcache_dir(cli->vm, argv[2]);
+        vm_tcache_default_dir(argv[2]);
+        log_printf("[TCACHE] dir %s\n", argv[2]);
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "off") == 0) {
+        vm_tcache_dir(cli->vm, NULL);
+        vm_tcache_default_dir(NULL);
+        log_printf("[TCACHE] off\n");
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "save") == 0) return vm_tcache_save(cli->vm) ? 0 : -1;
+    log_printf("%s", usage);
+    return -1;
+}
+
+// Decoder statistics; "on"/"off" toggle DBG_K12STATS, keeping other flags.
+static int cmd_k12stats(CLI *cli, int argc, char **argv) {
+    const char *usage = "usage: k12stats on | off | show [<n>] | csv <file> | reset\n";
+    debug_flags_t flags = vm_get_debug(cli->vm);
+    if (argc == 2 && strcmp(argv[1], "on") == 0) {
+        vm_set_debug(cli->vm, flags | DBG_K12STATS);
+        log_printf("[K12STATS] on\n");
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "off") == 0) {
+        vm_set_debug(cli->vm, flags & ~(debug_flags_t)DBG_K12STATS);
+        log_printf("[K12STATS] off\n");
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) { execute_stats_reset(); return 0; }
+    if (argc == 3 && strcmp(argv[1], "csv") == 0)   return execute_stats_csv(argv[2]) ? 0 : -1;
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "show") == 0) {
+        unsigned top = 20;
+        if (argc == 3) {
+            uint32_t v;
+            if (!parse_u32(argv[2], &v) || v == 0) { log_printf("%s", usage); return -1; }
+            top = v;
+        }
+        execute_stats_report(top);
+        return 0;
+    }
+    log_printf("%s", usage);
+    return -1;
 }
 
 void cli_init(CLI *cli, VM *vm, FILE *in, bool interactive) {
@@ -396,6 +513,7 @@ static int cmd_quit(CLI *cli, int argc, char **argv) {
 //   set rN <value>
 //   set pc <value>
 //   set cpu debug=<flag>
+//   set cpu engine=step|threaded
 /* --------------- command: set --------------- */
 
 static int istarts_with(const char* s, const char* prefix) {
@@ -465,8 +583,9 @@ static int cmd_set(CLI *cli, int argc, char **argv) {
         log_printf("  set mem <bytes|K|M|G>\n");
         log_printf("  set debug=<hex|names>\n");
         log_printf("  set cpu debug=<hex|names>\n");
+        log_printf("  set cpu engine=step|threaded\n");
         log_printf("  set trace=on|off\n");
-        log_printf("Names: INSTR, MEM_READ, MEM_WRITE, MMIO, DISK, IRQ, DISASM, K12, TRACE, CLI, ALL, NONE\n");
+        log_printf("Names: INSTR, MEM_READ, MEM_WRITE, MMIO, DISK, IRQ, DISASM, K12, K12STATS, TRACE, CLI, ALL, NONE\n");
         return 0;
     }
 
@@ -516,7 +635,22 @@ static int cmd_set(CLI *cli, int argc, char **argv) {
             return 0;
         }
 
-        log_printf("Unknown CPU setting. Try: set cpu debug=<...>\n");
+        if (ieq(argv[2], "engine") || istarts_with(argv[2], "engine=")) {
+            const char *rhs = find_eq_rhs(argv[2], (argc >= 4 ? argv[3] : NULL));
+            if (rhs && ieq(rhs, "threaded")) {
+                vm_set_engine(cli->vm, CPU_ENGINE_THREADED_LOOP);
+            } else if (rhs && ieq(rhs, "step")) {
+                vm_set_engine(cli->vm, CPU_ENGINE_STEP);
+            } else {
+                log_printf("Usage: set cpu engine=step|threaded\n");
+                return -1;
+            }
+            log_printf("[CPU] engine set to %s\n",
+                       vm_get_engine(cli->vm) == CPU_ENGINE_THREADED_LOOP ? "threaded" : "step");
+            return 0;
+        }
+
+        log_printf("Unknown CPU setting. Try: set cpu debug=<...> | set cpu engine=step|threaded\n");
         return -1;
     }
 
@@ -578,7 +712,8 @@ static int cmd_set(CLI *cli, int argc, char **argv) {
     log_printf("  set mem <bytes|K|M|G>\n");
     log_printf("  set debug=<hex|names>\n");
     log_printf("  set cpu debug=<hex|names>\n");
+    log_printf("  set cpu engine=step|threaded\n");
     log_printf("  set trace=on|off\n");
-    log_printf("Names: INSTR, MEM_READ, MEM_WRITE, MMIO, DISK, IRQ, DISASM, K12, TRACE, CLI, ALL, NONE\n");
+    log_printf("Names: INSTR, MEM_READ, MEM_WRITE, MMIO, DISK, IRQ, DISASM, K12, K12STATS, TRACE, CLI, ALL, NONE\n");
     return -1;
 }
@@ -42,14 +42,7 @@ void handle_add(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        const uint32_t N = res >> 31;
-        const uint32_t Z = (res == 0);
-        const uint32_t C = (uint32_t)(wide >> 32);
-        const uint32_t V = (~(op1 ^ op2) & (op1 ^ res)) >> 31;
-        cpu.cpsr = (cpu.cpsr & ~((1u<<31)|(1u<<30)|(1u<<29)|(1u<<28)))
-                 | (N<<31) | (Z<<30) | (C<<29) | (V<<28);
-    }
+    if (S) cpsr_flags_add(op1, op2, res, (uint32_t)(wide >> 32));
 }
 
 // -----------------------------------------------------------------------------
@@ -72,13 +65,7 @@ void handle_adc(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from((wide >> 32) & 1u);
-        const uint32_t b = op2 + cin;
-        const int overflow = (~(op1 ^ b) & (op1 ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_add(op1, op2 + cin, res, (uint32_t)(wide >> 32));
 }
 
 // -----------------------------------------------------------------------------
@@ -98,12 +85,7 @@ void handle_sub(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(a >= op2); // NOT borrow
-        const int overflow = ((a ^ op2) & (a ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_sub(a, op2, res, a >= op2);   // C = NOT borrow
 }
 
 // -----------------------------------------------------------------------------
@@ -127,13 +109,7 @@ void handle_sbc(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from((wide >> 32) == 0); // no borrow => C=1
-        const uint32_t btot = op2 + borrow;
-        const int overflow = ((a ^ btot) & (a ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_sub(a, op2 + borrow, res, (wide >> 32) == 0);   // no borrow => C=1
 }
 
 // -----------------------------------------------------------------------------
@@ -153,12 +129,7 @@ void handle_rsb(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(op2 >= a);
-        const int overflow = ((op2 ^ a) & (op2 ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_sub(op2, a, res, op2 >= a);
 }
 
 // -----------------------------------------------------------------------------
@@ -182,13 +153,7 @@ void handle_rsc(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from((wide >> 32) == 0);
-        const uint32_t atot = a + borrow;
-        const int overflow = ((op2 ^ atot) & (op2 ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_sub(op2, a + borrow, res, (wide >> 32) == 0);
 }
 
 // -----------------------------------------------------------------------------
@@ -207,10 +172,7 @@ void handle_and(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(sh_carry & 1u);
-    }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // -----------------------------------------------------------------------------
@@ -229,10 +191,7 @@ void handle_eor(uint32_t instr)
     if (rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(sh_carry & 1u);
-    }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // -----------------------------------------------------------------------------
@@ -250,10 +209,7 @@ void handle_mov_dp(uint32_t instr)
     if (Rd == 15) { write_pc_or_npc(res, S); return; }
 
     cpu.r[Rd] = res;
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(sh_carry & 1u); // MOVS: C := shifter carry
-    }
+    if (S) cpsr_flags_logic(res, sh_carry);   // MOVS: C := shifter carry
 }
 
 // -----------------------------------------------------------------------------
@@ -271,10 +227,7 @@ void handle_mvn(uint32_t instr)
     if (Rd == 15) { write_pc_or_npc(res, S); return; }
     cpu.r[Rd] = res;
 
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(sh_carry & 1u);
-    }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // -----------------------------------------------------------------------------
@@ -289,10 +242,7 @@ void handle_cmp(uint32_t instr)
     const uint32_t a   = arm_read_src_reg(rn);
     const uint32_t res = a - op2;
 
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(a >= op2);
-    const int overflow = ((a ^ op2) & (a ^ res) & 0x80000000u) != 0;
-    cpsr_set_V(overflow);
+    cpsr_flags_sub(a, op2, res, a >= op2);
 }
 
 // -----------------------------------------------------------------------------
@@ -306,8 +256,7 @@ void handle_tst(uint32_t instr)
     const uint32_t op2 = dp_operand2(instr, &sh_carry);
     const uint32_t res = arm_read_src_reg(rn) & op2;
 
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(sh_carry & 1u);
+    cpsr_flags_logic(res, sh_carry);
 }
 
 // -----------------------------------------------------------------------------
@@ -321,8 +270,7 @@ void handle_teq(uint32_t instr)
     const uint32_t op2 = dp_operand2(instr, &sh_carry);
     const uint32_t res = arm_read_src_reg(rn) ^ op2;
 
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(sh_carry & 1u);
+    cpsr_flags_logic(res, sh_carry);
 }
 
 // -----------------------------------------------------------------------------
@@ -338,8 +286,5 @@ void handle_cmn(uint32_t instr)
     const uint64_t sum = (uint64_t)a + (uint64_t)op2;
     const uint32_t res = (uint32_t)sum;
 
-    cpsr_set_NZ(res);
-    cpsr_set_C_from((sum >> 32) & 1u);
-    const int overflow = (~(a ^ op2) & (a ^ res) & 0x80000000u) != 0;
-    cpsr_set_V(overflow);
+    cpsr_flags_add(a, op2, res, (uint32_t)(sum >> 32));
 }
@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include "cpu.h"       // CPU cpu, CPSR bits
 #include "cond.h"      // evaluate_condition(...)
+#include "cpu_flags.h" // cpsr_flags_logic(), cpu_flags_sync()
 #include "arm_mul.h"
 
 #ifndef BIT
@@ -11,6 +12,7 @@
 
 // Only set N/Z; leave C/V unchanged for these long-multiply ops.
 static inline void set_nz_64(uint64_t val) {
+    cpu_flags_sync();
     // Z = 1 if full 64-bit result is zero
     if (val == 0) cpu.cpsr |= BIT(30); else cpu.cpsr &= ~BIT(30);
     // N = bit[63] of the 64-bit result
@@ -113,9 +115,7 @@ void handle_mul(uint32_t instr) {
     cpu.r[Rd] = res;
 
     if (S) {
-        cpu.cpsr = (cpu.cpsr & 0x3FFFFFFFu) |
-                   (res & 0x80000000u)      |      // N
-                   ((res == 0) ? 0x40000000u : 0); // Z
+        cpsr_flags_logic(res, cpsr_get_C());   // N, Z
         // C and V are UNPREDICTABLE for MUL/MLA — leave unchanged
     }
 }
@@ -130,9 +130,29 @@ void handle_mla(uint32_t instr) {
     uint32_t res = cpu.r[Rm] * cpu.r[Rs] + cpu.r[Rn];
     cpu.r[Rd] = res;
 
-    if (S) {
-        cpu.cpsr = (cpu.cpsr & 0x3FFFFFFFu) |
-                   (res & 0x80000000u) |
-                   ((res == 0) ? 0x40000000u : 0);
-    }
+    if (S) cpsr_flags_logic(res, cpsr_get_C());
+}
+
+// UDIV/SDIV Rd,Rn,Rm (ARMv7 A32: Rd=[19:16], Rm=[11:8], Rn=[3:0])
+// Divide by zero gives 0 (no trap); flags unaffected.
+void handle_udiv(uint32_t instr) {
+    uint32_t Rd = (instr >> 16) & 0xFu;
+    uint32_t Rm = (instr >> 8)  & 0xFu;
+    uint32_t Rn =  instr        & 0xFu;
+    if (Rd == 15u) return;               // UNPREDICTABLE → ignore
+
+    uint32_t d = cpu.r[Rm];
+    cpu.r[Rd] = d ? cpu.r[Rn] / d : 0u;
+}
+
+void handle_sdiv(uint32_t instr) {
+    uint32_t Rd = (instr >> 16) & 0xFu;
+    uint32_t Rm = (instr >> 8)  & 0xFu;
+    uint32_t Rn =  instr        & 0xFu;
+    if (Rd == 15u) return;               // UNPREDICTABLE → ignore
+
+    int32_t n = (int32_t)cpu.r[Rn], d = (int32_t)cpu.r[Rm];
+    if (d == 0)                          cpu.r[Rd] = 0u;
+    else if (n == INT32_MIN && d == -1)  cpu.r[Rd] = (uint32_t)INT32_MIN;   // overflow wraps
+    else                                 cpu.r[Rd] = (uint32_t)(n / d);
 }
@@ -1,13 +1,22 @@
 #include "cond.h"
 #include "cpu.h"
+#include "cpu_flags.h"   // cpsr_nzcv()
 
-extern CPU cpu;
+extern VM_TLS CPU cpu;
+
+const uint16_t g_cond_pass[16] = {
+    0xF0F0, 0x0F0F, 0xCCCC, 0x3333,   // EQ NE CS CC
+    0xFF00, 0x00FF, 0xAAAA, 0x5555,   // MI PL VS VC
+    0x0C0C, 0xF3F3, 0xAA55, 0x55AA,   // HI LS GE LT
+    0x0A05, 0xF5FA, 0xFFFF, 0x0000    // GT LE AL NV
+};
 
 bool evaluate_condition(uint8_t cond) {
-    bool N = (cpu.cpsr >> 31) & 1;
-    bool Z = (cpu.cpsr >> 30) & 1;
-    bool C = (cpu.cpsr >> 29) & 1;
-    bool V = (cpu.cpsr >> 28) & 1;
+    uint32_t f = cpsr_nzcv();
+    bool N = (f >> 3) & 1;
+    bool Z = (f >> 2) & 1;
+    bool C = (f >> 1) & 1;
+    bool V =  f       & 1;
 
     switch (cond) {
         case 0x0: return Z;               // EQ
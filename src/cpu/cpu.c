@@ -9,23 +9,31 @@
 #include "mem.h"
 #include "hw.h"
 #include "execute.h"
+#include "tcache.h"
+#include "jit.h"        // jit_run()
+#include "cpu_flags.h"  // cpsr_nzcv(), cpu_flags_sync()
+#include "profile.h"    // g_prof, profile_block()
 #include "debug.h"    // debug_flags_t, trace_all
 #include "log.h"      // only used by cpu_dump_registers()
 
 extern bool trace_all;
-extern debug_flags_t debug_flags;
+extern VM_TLS debug_flags_t debug_flags;
 
-CPU cpu = {0};
-uint64_t cycle = 0;
+VM_TLS CPU cpu = {0};
+VM_TLS uint64_t cycle = 0;
 
-static bool g_cpu_halted = false;
+// Engine of the VM bound to this thread (vm_activate()), like debug_flags.
+static VM_TLS cpu_engine_t g_cpu_engine = CPU_ENGINE_DEFAULT;
 
 // -----------------------------------------------------------------------------
 // Run-state control
 // -----------------------------------------------------------------------------
-void cpu_halt(void)       { g_cpu_halted = true; }
-void cpu_clear_halt(void) { g_cpu_halted = false; }
-bool cpu_is_halted(void)  { return g_cpu_halted; }
+void cpu_halt(void)       { cpu.halted = true; }
+void cpu_clear_halt(void) { cpu.halted = false; }
+bool cpu_is_halted(void)  { return cpu.halted; }
+
+void         cpu_set_engine(cpu_engine_t e) { g_cpu_engine = e; }
+cpu_engine_t cpu_get_engine(void)           { return g_cpu_engine; }
 
 // -----------------------------------------------------------------------------
 // Small utilities
@@ -68,13 +76,11 @@ uint32_t cpu_fetch(void) {
     cpu.npc = pc + 4u;   // ARM state
 
     // Fetch instruction
-    return mem_read32(pc);
+    return mem_fetch32(pc);
 }
 
-// Execute exactly one instruction: fetch → execute → commit
-static int execute_one_instruction(void) {
-    if (cpu_is_halted()) return 0;
-
+// Uncached path: fetch → decode/execute → commit
+static int execute_fetched_instruction(void) {
     uint32_t instr = cpu_fetch();
 
     // Dispatch/execute (handlers may change cpu.npc)
@@ -89,6 +95,33 @@ static int execute_one_instruction(void) {
     return ok ? 1 : 0;  // simple cycle accounting placeholder
 }
 
+// Execute exactly one instruction: fetch → execute → commit
+static int execute_one_instruction(void) {
+    if (cpu_is_halted()) return 0;
+
+    // Predecoded path: same fetch side effects, no per-instruction decode.
+    // TRACE/K12 logging and K12 stats need the slow path, so they bypass
+    // the cache.
+    if (!(debug_flags & (DBG_TRACE | DBG_K12 | DBG_K12STATS))) {
+        uint32_t pc = cpu.r[15];
+#if defined(CPU_STRICT_FETCH)
+        const k12_op *op = (pc & 3u) ? NULL : tcache_lookup(pc);
+#else
+        const k12_op *op = tcache_lookup(pc);
+#endif
+        if (op) {
+            cpu.cpsr &= ~CPSR_T;
+            cpu.npc = pc + 4u;
+            tcache_run_op(op);
+            if (cpu_is_halted()) return 0;
+            cpu.r[15] = cpu.npc;
+            return 1;
+        }
+    }
+
+    return execute_fetched_instruction();
+}
+
 void cpu_dump_registers(void) {
     // Convenience printer (only called explicitly)
     log_printf("Registers:\n");
@@ -98,14 +131,322 @@ void cpu_dump_registers(void) {
     }
 }
 
+// -----------------------------------------------------------------------------
+// Interrupts
+// -----------------------------------------------------------------------------
+static inline void cpu_swap_irq_bank(void) {
+    uint32_t t;
+    t = cpu.r[13]; cpu.r[13] = cpu.sp_irq;   cpu.sp_irq   = t;
+    t = cpu.r[14]; cpu.r[14] = cpu.lr_irq;   cpu.lr_irq   = t;
+    t = cpu.spsr;  cpu.spsr  = cpu.spsr_irq; cpu.spsr_irq = t;
+}
+
+void cpu_write_cpsr(uint32_t value) {
+    uint32_t old = cpu.cpsr;
+    if (((old & CPSR_MODE_MASK) == CPSR_MODE_IRQ) != ((value & CPSR_MODE_MASK) == CPSR_MODE_IRQ))
+        cpu_swap_irq_bank();
+    cpu.cpsr = value;
+    if ((old & CPSR_I) && !(value & CPSR_I) && g_hw->irq) hw_irq_kick();
+}
+
+void cpu_take_irq(void) {
+    cpu_flags_sync();
+    uint32_t old = cpu.cpsr;
+    uint32_t p = (old & ~(CPSR_MODE_MASK | CPSR_T | (0x3Fu << 10) | (0x3u << 25)))
+               | CPSR_MODE_IRQ | CPSR_I;
+    cpu_write_cpsr(p);
+    cpu.spsr  = old;
+    cpu.r[14] = cpu.r[15] + 4u;          // SUBS PC, LR, #4 resumes at r15
+    cpu.r[15] = 0x00000018u;             // IRQ vector (low vectors)
+    cpu.npc   = cpu.r[15];
+}
+
+// Between instructions, once the clock has moved (so anything due at this
+// boundary has fired).
+static inline void cpu_sample_irq(void) {
+    if (g_hw->irq && !(cpu.cpsr & CPSR_I) && !cpu.halted) cpu_take_irq();
+}
+
+// Threaded loop: first instruction of the running block not yet counted on
+// the device clock.
+static VM_TLS bool     g_in_block;
+static VM_TLS uint32_t g_block_unsynced;
+
+void cpu_sync_clock(void) {
+    if (!g_in_block) return;
+    g_hw->now += (cpu.r[15] - g_block_unsynced) >> 2;   // straight-line block
+    g_block_unsynced = cpu.r[15];
+}
+
 // -----------------------------------------------------------------------------
 // Public stepping
 // -----------------------------------------------------------------------------
 void cpu_step(void) {
+    uint32_t pc = cpu.r[15];
     int cycles_used = execute_one_instruction();
+    if (g_prof) profile_block(pc, 1);
     if (cycles_used <= 0) cycles_used = 1;
-    hw_bus_tick(cycles_used);
-    // TODO: IRQ/FIQ sampling would go here later
+    hw_bus_advance((uint64_t)cycles_used);
+    cpu_sample_irq();
+}
+
+// -----------------------------------------------------------------------------
+// Threaded run loop
+// -----------------------------------------------------------------------------
+// Runs predecoded blocks back to back: each op dispatches straight to the next
+// (computed goto on GCC/Clang, a switch elsewhere), blocks are cut at the next
+// device deadline, and there are no per-instruction debug checks -- callers only
+// pick this loop when DISASM/TRACE/K12 output and K12 stats are off. Anything
+// the cache can't serve (first miss, MMIO, undecodable word) takes the uncached
+// path.
+// Architectural results match cpu_step() instruction for instruction.
+#if defined(__GNUC__) && !defined(CPU_NO_COMPUTED_GOTO)
+#define CPU_THREADED_GOTO 1
+#else
+#define CPU_THREADED_GOTO 0
+#endif
+
+// ---- Idle loops ----
+// A block that branches back to its own first op, is built only from
+// reads_only ops and reads the bus: once a whole iteration ends with r0-r14
+// and CPSR as the previous one did, no event fired or was armed and every
+// bus read was plain, each further iteration repeats it exactly until the
+// next event is due. Those iterations are retired in one go -- clock and
+// instruction count as if executed -- stopping one cycle short of the
+// deadline so the event lands inside a real iteration.
+#define CPU_IDLE_MAX_SKIP (1u << 20)    // per skip while no event is armed
+
+typedef struct {
+    uint32_t pc, len, gen;  // loop being watched (len 0 = none)
+    bool     ok;            // short and reads_only throughout
+    bool     armed;         // fields below are from a polling iteration
+    uint64_t reads, reads_volatile;
+    uint64_t next, seq;
+    uint32_t cpsr;
+    uint32_t r[15];
+} cpu_idle_t;
+
+static VM_TLS cpu_idle_t g_idle;
+
+// The block at first (len ops from pc0) just ended by branching back to pc0.
+// Returns the instructions skipped, already put on the clock.
+static uint64_t cpu_idle_skip(uint32_t pc0, const k12_op *first, uint32_t len, uint64_t room) {
+    hw_ctx *hw = g_hw;
+    cpu_idle_t *s = &g_idle;
+    if (s->pc != pc0 || s->len != len || s->gen != g_tc->gen) {
+        s->pc = pc0; s->len = len; s->gen = g_tc->gen;
+        s->ok = len <= CPU_IDLE_MAX_OPS;
+        for (uint32_t i = 0; s->ok && i < len; ++i) s->ok = first[i].reads_only;
+        s->armed = false;
+        s->reads = hw->reads; s->reads_volatile = hw->reads_volatile;
+        return 0;
+    }
+    if (!s->ok) return 0;
+
+    bool polled = hw->reads != s->reads && hw->reads_volatile == s->reads_volatile;
+    s->reads = hw->reads; s->reads_volatile = hw->reads_volatile;
+    if (!polled) { s->armed = false; return 0; }
+
+    cpu_flags_sync();
+    if (s->armed && s->next == hw->next && s->seq == hw->seq && s->cpsr == cpu.cpsr &&
+        memcmp(s->r, cpu.r, sizeof s->r) == 0) {
+        uint64_t span = hw->next == UINT64_MAX ? CPU_IDLE_MAX_SKIP : hw_bus_until_next();
+        span = span ? span - 1u : 0;
+        if (span > room) span = room;
+        span -= span % len;
+        g_hw->now += span;              // short of the deadline: nothing fires
+        return span;
+    }
+    s->armed = true;
+    s->next = hw->next; s->seq = hw->seq;
+    s->cpsr = cpu.cpsr;
+    memcpy(s->r, cpu.r, sizeof s->r);
+    return 0;
+}
+
+uint64_t cpu_run_threaded(uint64_t max_instrs) {
+    uint64_t limit = max_instrs ? max_instrs : UINT64_MAX;
+    uint64_t n = 0;
+    g_idle.len = 0;
+
+#if CPU_THREADED_GOTO
+    static void *const k_dispatch[K12_OP_KINDS] = {
+        [K12_OP_PLAIN] = &&op_plain,
+        [K12_OP_COND]  = &&op_cond,
+        [K12_OP_B]     = &&op_b,
+        [K12_OP_MOVWT]  = &&op_movwt,
+        [K12_OP_CMPB]   = &&op_cmpb,
+        [K12_OP_LDRADD] = &&op_ldradd,
+    };
+#endif
+
+    while (n < limit && !cpu.halted) {
+        uint32_t pc = cpu.r[15];
+        uint32_t left = 0;
+        const k12_op *op = NULL;
+#if defined(CPU_STRICT_FETCH)
+        if (!(pc & 3u))
+#endif
+            op = tcache_lookup_run(pc, &left);
+        if (!op) {
+            // Not a second lookup via cpu_step(): a first miss stays a miss.
+            execute_fetched_instruction();
+            if (g_prof) profile_block(pc, 1);
+            hw_bus_advance(1);
+            cpu_sample_irq();
+            n++;
+            continue;
+        }
+
+#if CPU_JIT
+        // At a block's start, its x86-64 translation once it is hot. Inline
+        // ops skip the handlers' logging, so only with debug output off.
+        if (op == g_tc->cur->ops && !g_prof && !debug_flags && !trace_all) {
+            uint64_t room = limit - n, due = hw_bus_until_next();
+            if (room > due) room = due ? due : 1u;
+            if (room > UINT32_MAX) room = UINT32_MAX;
+            uint32_t end;
+            g_in_block = true;
+            g_block_unsynced = pc;
+            uint32_t done = jit_run(g_tc->cur, (uint32_t)room, &g_block_unsynced, &end);
+            g_in_block = false;
+            if (done) {
+                const tc_block *b = g_tc->cur;
+                n += done;
+                hw_bus_advance((end - g_block_unsynced) >> 2);
+                cpu_sample_irq();
+                if (cpu.r[15] == pc && !cpu.halted && done == b->jit_ops)
+                    n += cpu_idle_skip(pc, b->ops, done, limit - n);
+                continue;
+            }
+        }
+#endif
+
+        uint32_t pc0  = pc;
+        uint32_t gen  = g_tc->gen;
+        uint64_t next = g_hw->next;
+        uint64_t due  = hw_bus_until_next();
+        if (left > limit - n) left = (uint32_t)(limit - n);
+        if (left > due) left = due ? (uint32_t)due : 1u;
+        uint32_t done = 0;
+        g_in_block = true;
+        g_block_unsynced = pc0;
+
+        // One instruction: fetch side effects, body, commit. Leaves the block
+        // on halt, taken branch, end of run or device deadline, a store into
+        // cached code, or an MMIO access that armed an earlier event.
+#define OP_BEGIN()  do { cpu.cpsr &= ~CPSR_T; cpu.npc = pc + 4u; } while (0)
+#define OP_END()                                                        \
+        do {                                                            \
+            done++;                                                     \
+            if (cpu.halted) goto block_done;                          \
+            cpu.r[15] = cpu.npc;                                        \
+            if (--left == 0 || cpu.npc != pc + 4u || g_tc->gen != gen || \
+                g_hw->next != next)                                     \
+                goto block_done;                                        \
+            pc += 4u; op++;                                             \
+        } while (0)
+        // Fused pair (execute_fuse()), with both ops left in the run: step
+        // from the first op to the second once the first's work is done;
+        // the second's OP_END() follows.
+#define OP_FUSED()  do { done++; left--; pc += 4u; op++; cpu.npc = pc + 4u; } while (0)
+
+#if CPU_THREADED_GOTO
+#define OP_NEXT()   do { OP_BEGIN(); goto *k_dispatch[op->kind]; } while (0)
+        OP_NEXT();
+    op_cond:
+        if (cond_passed(op->cond, cpsr_nzcv())) op->fn(op->instr);
+        OP_END();
+        OP_NEXT();
+    op_plain:
+        op->fn(op->instr);
+        OP_END();
+        OP_NEXT();
+    op_b:
+        if (cond_passed(op->cond, cpsr_nzcv())) cpu.npc = pc + (uint32_t)op->imm;
+        OP_END();
+        OP_NEXT();
+    op_movwt:
+        if (left < 2) goto op_plain;
+        cpu.r[op->rd] = (uint32_t)op->imm;
+        OP_FUSED();
+        OP_END();
+        OP_NEXT();
+    op_cmpb:
+        if (left < 2) goto op_plain;
+        {
+            uint32_t a = cpu.r[op->rn], b = (uint32_t)op->imm;
+            cpsr_flags_sub(a, b, a - b, a >= b);
+            OP_FUSED();
+            if (cond_passed(op->cond, lf_pack(LF_SUB, a, b, a - b, a >= b, 0)))
+                cpu.npc = pc + (uint32_t)op->imm;
+        }
+        OP_END();
+        OP_NEXT();
+    op_ldradd:
+        op->fn(op->instr);
+        if (left >= 2 && !cpu.halted && g_tc->gen == gen && g_hw->next == next) {
+            uint32_t inc = (uint32_t)op->imm;
+            OP_FUSED();
+            cpu.r[op->rd] += inc;
+        }
+        OP_END();
+        OP_NEXT();
+#undef OP_NEXT
+#else
+        for (;;) {
+            OP_BEGIN();
+            switch (op->kind) {
+            case K12_OP_B:
+                if (cond_passed(op->cond, cpsr_nzcv())) cpu.npc = pc + (uint32_t)op->imm;
+                break;
+            case K12_OP_MOVWT:
+                if (left < 2) { op->fn(op->instr); break; }
+                cpu.r[op->rd] = (uint32_t)op->imm;
+                OP_FUSED();
+                break;
+            case K12_OP_CMPB:
+                if (left < 2) { op->fn(op->instr); break; }
+                {
+                    uint32_t a = cpu.r[op->rn], b = (uint32_t)op->imm;
+                    cpsr_flags_sub(a, b, a - b, a >= b);
+                    OP_FUSED();
+                    if (cond_passed(op->cond, lf_pack(LF_SUB, a, b, a - b, a >= b, 0)))
+                        cpu.npc = pc + (uint32_t)op->imm;
+                }
+                break;
+            case K12_OP_LDRADD:
+                op->fn(op->instr);
+                if (left >= 2 && !cpu.halted && g_tc->gen == gen && g_hw->next == next) {
+                    uint32_t inc = (uint32_t)op->imm;
+                    OP_FUSED();
+                    cpu.r[op->rd] += inc;
+                }
+                break;
+            case K12_OP_COND:
+                if (!cond_passed(op->cond, cpsr_nzcv())) break;
+                /* fall through */
+            default:
+                op->fn(op->instr);
+                break;
+            }
+            OP_END();
+        }
+#endif
+#undef OP_BEGIN
+#undef OP_END
+#undef OP_FUSED
+
+    block_done:
+        if (g_prof) profile_block(pc0, done);
+        n += done;
+        g_in_block = false;
+        hw_bus_advance(done - ((g_block_unsynced - pc0) >> 2));
+        cpu_sample_irq();
+        if (cpu.r[15] == pc0 && !cpu.halted && !g_prof)
+            n += cpu_idle_skip(pc0, op - (done - 1u), done, limit - n);
+    }
+    return n;
 }
 
 // -----------------------------------------------------------------------------
@@ -119,7 +460,8 @@ static inline uint32_t cpu_get_spsr_current(void) {
 
 void cpu_exception_return(uint32_t new_pc) {
     // Restore CPSR and schedule the branch by writing NPC (not PC).
-    cpu.cpsr = cpu_get_spsr_current();
+    cpu_flags_sync();   // pending NZCV is dead once CPSR is replaced
+    cpu_write_cpsr(cpu_get_spsr_current());
 
     // If you later support Thumb, align based on CPSR.T before writing npc.
     // bool T = (cpu.cpsr >> 5) & 1u;
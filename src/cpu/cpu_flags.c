@@ -7,7 +7,7 @@
 #include "log.h"
 #include "cpu_flags.h"
 
-extern debug_flags_t debug_flags;
+extern VM_TLS debug_flags_t debug_flags;
 
 void psr_write(uint32_t *psr, uint32_t value, uint32_t fields, int is_cpsr)
 {
@@ -0,0 +1,241 @@
+// src/cpu/dp_variants.c — specialized data-processing handlers
+// One handler per (opcode, Operand2 shape, S), stamped out by DP_VARIANT().
+// Opcode, shape and S are compile-time constants inside each handler, so the
+// switch in dp_exec() and the shape helpers fold away: `ADD r0, r1, #4`
+// becomes a load, an add and a store. Shape semantics follow dp_operand2()
+// (operand.c) case for case; dp_variant() only hands out a variant where the
+// generic handler would behave identically (no PC operands, Rd != PC).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+#include "cpu_flags.h"
+#include "dp_variants.h"
+
+enum {
+    DP_AND, DP_EOR, DP_SUB, DP_RSB, DP_ADD, DP_ADC, DP_SBC, DP_RSC,
+    DP_TST, DP_TEQ, DP_CMP, DP_CMN, DP_ORR, DP_MOV, DP_BIC, DP_MVN
+};
+
+enum { DP_SHAPE_IMM, DP_SHAPE_IMM_ROT, DP_SHAPE_REG, DP_SHAPE_REG_SHIFT, DP_SHAPE_REG_REG, DP_SHAPES };
+
+static inline uint32_t ror32(uint32_t val, unsigned int rot) {
+    return (val >> rot) | (val << ((32u - rot) & 31u));
+}
+
+// -----------------------------------------------------------------------------
+// Operand2 shapes: value, and *c where the shifter defines a carry
+// -----------------------------------------------------------------------------
+#define OP2_KEEPS_C_imm       1
+#define OP2_KEEPS_C_imm_rot   0
+#define OP2_KEEPS_C_reg       1
+#define OP2_KEEPS_C_reg_shift 0     // every imm shift but LSL #0 sets C
+#define OP2_KEEPS_C_reg_reg   1     // Rs[7:0] == 0 leaves C alone
+
+static inline uint32_t op2_imm(uint32_t instr, uint32_t *c) {
+    (void)c;
+    return instr & 0xFFu;
+}
+
+static inline uint32_t op2_imm_rot(uint32_t instr, uint32_t *c) {
+    uint32_t val = ror32(instr & 0xFFu, ((instr >> 8) & 0xFu) * 2u);
+    *c = val >> 31;
+    return val;
+}
+
+static inline uint32_t op2_reg(uint32_t instr, uint32_t *c) {
+    (void)c;
+    return cpu.r[instr & 0xFu];
+}
+
+// Immediate shift other than LSL #0 (that is the reg shape).
+static inline uint32_t op2_reg_shift(uint32_t instr, uint32_t *c) {
+    const uint32_t rmval = cpu.r[instr & 0xFu];
+    const uint32_t shimm = (instr >> 7) & 0x1Fu;
+    switch ((instr >> 5) & 3u) {
+    case 0:                                             // LSL #1..31
+        *c = (rmval >> (32u - shimm)) & 1u;
+        return rmval << shimm;
+    case 1:                                             // LSR (#0 = #32)
+        if (!shimm) { *c = rmval >> 31; return 0u; }
+        *c = (rmval >> (shimm - 1u)) & 1u;
+        return rmval >> shimm;
+    case 2:                                             // ASR (#0 = #32)
+        if (!shimm) { *c = rmval >> 31; return (uint32_t)((int32_t)rmval >> 31); }
+        *c = (rmval >> (shimm - 1u)) & 1u;
+        return (uint32_t)((int32_t)rmval >> shimm);
+    default:                                            // ROR (#0 = RRX)
+        if (!shimm) {
+            const uint32_t cin = cpsr_get_C();
+            *c = rmval & 1u;
+            return (rmval >> 1) | (cin << 31);
+        }
+        *c = (rmval >> (shimm - 1u)) & 1u;
+        return ror32(rmval, shimm);
+    }
+}
+
+static inline uint32_t op2_reg_reg(uint32_t instr, uint32_t *c) {
+    const uint32_t rmval  = cpu.r[instr & 0xFu];
+    const uint32_t amount = cpu.r[(instr >> 8) & 0xFu] & 0xFFu;
+    if (amount == 0) return rmval;
+    switch ((instr >> 5) & 3u) {
+    case 0:                                             // LSL
+        if (amount < 32)  { *c = (rmval >> (32u - amount)) & 1u; return rmval << amount; }
+        *c = (amount == 32) ? (rmval & 1u) : 0u;
+        return 0u;
+    case 1:                                             // LSR
+        if (amount < 32)  { *c = (rmval >> (amount - 1u)) & 1u; return rmval >> amount; }
+        *c = (amount == 32) ? (rmval >> 31) : 0u;
+        return 0u;
+    case 2:                                             // ASR
+        if (amount < 32)  { *c = (rmval >> (amount - 1u)) & 1u; return (uint32_t)((int32_t)rmval >> amount); }
+        *c = rmval >> 31;
+        return (uint32_t)((int32_t)rmval >> 31);
+    default: {                                          // ROR
+        const uint32_t rot = amount & 31u;
+        if (!rot) { *c = rmval >> 31; return rmval; }
+        *c = (rmval >> (rot - 1u)) & 1u;
+        return ror32(rmval, rot);
+    }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Opcode bodies (op, S constant per variant)
+// -----------------------------------------------------------------------------
+static inline bool dp_is_test(int op)    { return op >= DP_TST && op <= DP_CMN; }
+static inline bool dp_uses_c(int op, bool S) {
+    switch (op) {
+    case DP_TST: case DP_TEQ: return true;
+    case DP_AND: case DP_EOR: case DP_ORR: case DP_MOV: case DP_BIC: case DP_MVN: return S;
+    default: return false;
+    }
+}
+
+static inline void dp_exec(int op, bool S, uint32_t instr, uint32_t b, uint32_t c) {
+    const uint32_t a  = cpu.r[(instr >> 16) & 0xFu];
+    const uint32_t rd = (instr >> 12) & 0xFu;
+    uint32_t res;
+    uint64_t wide;
+
+    switch (op) {
+    case DP_AND: res = a & b;  break;
+    case DP_EOR: res = a ^ b;  break;
+    case DP_ORR: res = a | b;  break;
+    case DP_BIC: res = a & ~b; break;
+    case DP_MOV: res = b;      break;
+    case DP_MVN: res = ~b;     break;
+    case DP_SUB:
+        res = a - b;
+        if (S) cpsr_flags_sub(a, b, res, a >= b);
+        cpu.r[rd] = res;
+        return;
+    case DP_RSB:
+        res = b - a;
+        if (S) cpsr_flags_sub(b, a, res, b >= a);
+        cpu.r[rd] = res;
+        return;
+    case DP_ADD:
+        wide = (uint64_t)a + b;
+        res  = (uint32_t)wide;
+        if (S) cpsr_flags_add(a, b, res, (uint32_t)(wide >> 32));
+        cpu.r[rd] = res;
+        return;
+    case DP_ADC: {
+        const uint32_t cin = cpsr_get_C();
+        wide = (uint64_t)a + b + cin;
+        res  = (uint32_t)wide;
+        if (S) cpsr_flags_add(a, b + cin, res, (uint32_t)(wide >> 32));
+        cpu.r[rd] = res;
+        return;
+    }
+    case DP_SBC: {
+        const uint32_t borrow = 1u - (cpsr_get_C() & 1u);
+        wide = (uint64_t)a - b - borrow;
+        res  = (uint32_t)wide;
+        if (S) cpsr_flags_sub(a, b + borrow, res, (wide >> 32) == 0);
+        cpu.r[rd] = res;
+        return;
+    }
+    case DP_RSC: {
+        const uint32_t borrow = 1u - (cpsr_get_C() & 1u);
+        wide = (uint64_t)b - a - borrow;
+        res  = (uint32_t)wide;
+        if (S) cpsr_flags_sub(b, a + borrow, res, (wide >> 32) == 0);
+        cpu.r[rd] = res;
+        return;
+    }
+    case DP_TST: cpsr_flags_logic(a & b, c); return;
+    case DP_TEQ: cpsr_flags_logic(a ^ b, c); return;
+    case DP_CMP: cpsr_flags_sub(a, b, a - b, a >= b); return;
+    default:     // DP_CMN
+        wide = (uint64_t)a + b;
+        cpsr_flags_add(a, b, (uint32_t)wide, (uint32_t)(wide >> 32));
+        return;
+    }
+    // Logical ops that write Rd
+    cpu.r[rd] = res;
+    if (S) cpsr_flags_logic(res, c);
+}
+
+// -----------------------------------------------------------------------------
+// Variants
+// -----------------------------------------------------------------------------
+#define DP_VARIANT(OP, SHAPE, S)                                              \
+    static void dp_##OP##_##SHAPE##_s##S(uint32_t instr) {                    \
+        uint32_t c = (dp_uses_c(DP_##OP, S) && OP2_KEEPS_C_##SHAPE)           \
+                   ? cpsr_get_C() : 0u;                                       \
+        const uint32_t b = op2_##SHAPE(instr, &c);                            \
+        dp_exec(DP_##OP, S, instr, b, c);                                     \
+    }
+
+#define DP_SHAPE_VARIANTS(OP, SHAPE) DP_VARIANT(OP, SHAPE, 0) DP_VARIANT(OP, SHAPE, 1)
+#define DP_OP_VARIANTS(OP)                                                    \
+    DP_SHAPE_VARIANTS(OP, imm)       DP_SHAPE_VARIANTS(OP, imm_rot)           \
+    DP_SHAPE_VARIANTS(OP, reg)       DP_SHAPE_VARIANTS(OP, reg_shift)         \
+    DP_SHAPE_VARIANTS(OP, reg_reg)
+
+#define DP_SHAPE_ROW(OP, SHAPE) { dp_##OP##_##SHAPE##_s0, dp_##OP##_##SHAPE##_s1 }
+#define DP_OP_ROW(OP)                                                         \
+    { DP_SHAPE_ROW(OP, imm), DP_SHAPE_ROW(OP, imm_rot), DP_SHAPE_ROW(OP, reg), \
+      DP_SHAPE_ROW(OP, reg_shift), DP_SHAPE_ROW(OP, reg_reg) }
+
+DP_OP_VARIANTS(AND) DP_OP_VARIANTS(EOR) DP_OP_VARIANTS(SUB) DP_OP_VARIANTS(RSB)
+DP_OP_VARIANTS(ADD) DP_OP_VARIANTS(ADC) DP_OP_VARIANTS(SBC) DP_OP_VARIANTS(RSC)
+DP_OP_VARIANTS(TST) DP_OP_VARIANTS(TEQ) DP_OP_VARIANTS(CMP) DP_OP_VARIANTS(CMN)
+DP_OP_VARIANTS(ORR) DP_OP_VARIANTS(MOV) DP_OP_VARIANTS(BIC) DP_OP_VARIANTS(MVN)
+
+// [opcode][shape][S]
+static const insn_handler_t DP_VARIANTS[16][DP_SHAPES][2] = {
+    DP_OP_ROW(AND), DP_OP_ROW(EOR), DP_OP_ROW(SUB), DP_OP_ROW(RSB),
+    DP_OP_ROW(ADD), DP_OP_ROW(ADC), DP_OP_ROW(SBC), DP_OP_ROW(RSC),
+    DP_OP_ROW(TST), DP_OP_ROW(TEQ), DP_OP_ROW(CMP), DP_OP_ROW(CMN),
+    DP_OP_ROW(ORR), DP_OP_ROW(MOV), DP_OP_ROW(BIC), DP_OP_ROW(MVN),
+};
+
+insn_handler_t dp_variant(uint32_t instr) {
+    const int      op = (int)((instr >> 21) & 0xFu);
+    const uint32_t rn = (instr >> 16) & 0xFu;
+    const uint32_t rd = (instr >> 12) & 0xFu;
+    const uint32_t rm =  instr        & 0xFu;
+
+    if (!dp_is_test(op) && rd == 15u) return NULL;
+    if (op != DP_MOV && op != DP_MVN && rn == 15u) return NULL;
+
+    int shape;
+    if (instr & (1u << 25)) {
+        shape = (instr & 0xF00u) ? DP_SHAPE_IMM_ROT : DP_SHAPE_IMM;
+    } else {
+        if (rm == 15u) return NULL;
+        if (instr & 0x10u) {
+            if (((instr >> 8) & 0xFu) == 15u) return NULL;
+            shape = DP_SHAPE_REG_REG;
+        } else {
+            shape = (instr & 0xFF0u) ? DP_SHAPE_REG_SHIFT : DP_SHAPE_REG;
+        }
+    }
+    return DP_VARIANTS[op][shape][(instr >> 20) & 1u];
+}
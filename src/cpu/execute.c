@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>   // qsort
 
 #include "cpu.h"      // extern CPU cpu; extern debug_flags_t debug_flags;
 #include "log.h"      // log_printf
@@ -18,6 +20,8 @@
 #include "memops.h"
 #include "execute.h"
 #include "arm_mul.h"
+#include "dp_variants.h"
+#include "k12_rules_hash.h"
 
 // ------------------------ key12 helper ------------------------
 static inline uint16_t key12(uint32_t instr) {
@@ -27,8 +31,6 @@ static inline uint16_t key12(uint32_t instr) {
     return (uint16_t)((op1 << 9) | (op2 << 4) | op3);
 }
 
-typedef void (*insn_handler_t)(uint32_t instr);
-
 typedef struct {
     uint16_t       mask12;      // mask in 12-bit key space
     uint16_t       value12;     // value in 12-bit key space
@@ -41,282 +43,436 @@ typedef struct {
 
 // -------------------- seed rules (order not critical; priority is) --------------------
 static const k12_entry K12_TABLE[] = {
-
-    // --- Bitfield Clear (BFC), A32 ---
-    { 0x0FFFu, 0x07D1u, 0x0FE3C1FFu, 0x07C3001Fu, true, handle_bfc, "BFC" },
-    { 0x0FFFu, 0x07C1u, 0x0FE3C1FFu, 0x07C3001Fu, true, handle_bfc, "BFC" },
-
-    // --- Bitfield Insert (BFI), A32 ---
-    { 0x0FFFu, 0x07C1u, 0x0FE00070u, 0x07C00010u, true, handle_bfi, "BFI" },
-    { 0x0FFFu, 0x07D1u, 0x0FE00070u, 0x07C00010u, true, handle_bfi, "BFI" },
-
-    // BEFORE CMN
-    { 0x0FFFu, 0x0161u, 0x0FFF0FF0u, 0x016F0F10u, true, handle_clz, "CLZ" },
-
-    // Key12 for these words shows up as 0x574 in your logs
-    { 0x0FFFu, 0x0574u, 0x0FFF0FF0u, 0x057F0040u, false, handle_dsb, "DSB" }, // F57FF04x
-    { 0x0FFFu, 0x0575u, 0x0FFF0FF0u, 0x057F0050u, false, handle_dmb, "DMB" }, // F57FF05x
-    { 0x0FFFu, 0x0576u, 0x0FFF0FF0u, 0x057F0060u, false, handle_isb, "ISB" }, // F57FF06x
-
-    // LDR (literal)
-    { 0x0F50u, 0x0510u, 0x033F0000u, 0x011F0000u, true, handle_ldr_literal, "LDR(literal)" },
-
-    // BKPT
-    { 0x0FFFu, 0x0127u, 0x0FF000F0u, 0x01200070u, false, handle_bkpt, "BKPT" },
-
-    { 0x0F00u, 0x0100u, 0xFF00F000u, 0xF1000000u, true, handle_cps, "CPS" },
-
-    // MSR
-    { 0x0FFFu, 0x0120u, 0x0FBF0FFFu, 0x0120F000u, true, handle_msr, "MSR reg->CPSR" },
-    { 0x0FFFu, 0x0320u, 0x0FBF0F00u, 0x0320F000u, true, handle_msr, "MSR imm->CPSR" },
-
-    // BLX (imm)
-    { 0x0E00u, 0x0A00u, 0xFE000000u, 0xFA000000u, false, handle_blx_imm, "BLX (imm)" },
-
-    // MUL / MLA
-    { 0x0E0Fu, 0x0009u, 0x0FEF00F0u, 0x00000090u, true, handle_mul, "MUL" }, // A=0, Rn=0000
-    { 0x0E0Fu, 0x0009u, 0x0FE000F0u, 0x00200090u, true, handle_mla, "MLA" }, // A=1
-
-    // PUSH / POP
-    { 0x0F10u, 0x0800u, 0x0FFF0000u, 0x092D0000u, true, handle_stm, "PUSH (STMDB sp!)" },
-    { 0x0F10u, 0x0810u, 0x0FFF0000u, 0x08BD0000u, true, handle_ldm, "POP (LDMIA sp!)" },
-
-    // LDM / STM generic
-    { 0x0E10u, 0x0810u, 0, 0, true, handle_ldm, "LDM" },
-    { 0x0E10u, 0x0800u, 0, 0, true, handle_stm, "STM" },
-
-    // Halfword / signed load/store
-    { 0x0E0Fu, 0x000Bu, 0x00500000u, 0x00400000u, true, handle_strh,  "STRH(imm)" },
-    { 0x0E0Fu, 0x000Bu, 0x00500000u, 0x00000000u, true, handle_strh,  "STRH(reg)" },
-    { 0x0E0Fu, 0x000Bu, 0x00500000u, 0x00100000u, true, handle_ldrh,  "LDRH"      },
-    { 0x0E0Fu, 0x000Du, 0x00100000u, 0x00100000u, true, handle_ldrsb, "LDRSB"     },
-    { 0x0E0Fu, 0x000Fu, 0x00100000u, 0x00100000u, true, handle_ldrsh, "LDRSH"     },
-
-    // BX / BLX (reg)
-    { 0x0FFFu, 0x0121u, 0x0FFFFFF0u, 0x012FFF10u, true, handle_bx,      "BX (reg)"  },
-    { 0x0FFFu, 0x0123u, 0x0FFFFFF0u, 0x012FFF30u, true, handle_blx_reg, "BLX (reg)" },
-
-	{ 0x0DE0u, 0x01A0u, 0, 0, true, handle_mov, "MOV" }, // DP MOV (reg or reg-shift via dp_operand2)
-
-    // MOVW / MOVT
-    { 0x0F00u, 0x0300u, 0x0FF00000u, 0x03000000u, true, handle_movw, "MOVW" },
-    { 0x0F00u, 0x0300u, 0x0FF00000u, 0x03400000u, true, handle_movt, "MOVT" },
-
-	// Shift by register (aliases of MOV) — ignore S (bit20)
-	{ 0x0FE0u, 0x01A0u, 0x0FE000F0u, 0x01A00010u, true, handle_mov, "LSL (reg)" },
-	{ 0x0FE0u, 0x01A0u, 0x0FE000F0u, 0x01A00030u, true, handle_mov, "LSR (reg)" },
-	{ 0x0FE0u, 0x01A0u, 0x0FE000F0u, 0x01A00050u, true, handle_mov, "ASR (reg)" },
-	{ 0x0FE0u, 0x01A0u, 0x0FE000F0u, 0x01A00070u, true, handle_mov, "ROR (reg)" },
-
-    // STR / STRB reg offset
-    { 0x0E50u, 0x0600u, 0, 0, true, handle_str_regoffset,  "STR reg-offset" },
-    { 0x0F7Fu, 0x0740u, 0, 0, true, handle_strb_reg_shift, "STRB reg LSL#0" },
-    { 0x0F71u, 0x0740u, 0, 0, true, handle_strb_reg_shift, "STRB reg imm-shift" },
-
-    // SWP / SWPB
-    { 0x0E0Fu, 0x0009u, 0x0FB00FF0u, 0x01000090u, true, handle_swp,  "SWP"  },
-    { 0x0E0Fu, 0x0009u, 0x0FB00FF0u, 0x01400090u, true, handle_swpb, "SWPB" },
-
-    // MRS / MSR (SPSR variants)
-    { 0x0FBFu, 0x0100u, 0x0FBF0FFFu, 0x014F0000u, true, handle_mrs, "MRS (SPSR)" },
-    { 0x0FFFu, 0x0120u, 0x0FBF0FFFu, 0x0160F000u, true, handle_msr, "MSR reg->SPSR" },
-    { 0x0FFFu, 0x0320u, 0x0FBF0F00u, 0x0360F000u, true, handle_msr, "MSR imm->SPSR" },
-
-    // Doubleword transfers
-    { 0x0E0Fu, 0x000Du, 0x00400000u, 0x00400000u, true, exec_ldrd_imm, "LDRD(imm)" },
-    { 0x0E0Fu, 0x000Du, 0x00400000u, 0x00000000u, true, exec_ldrd_reg, "LDRD(reg)" },
-    { 0x0E0Fu, 0x000Fu, 0x00400000u, 0x00400000u, true, exec_strd_imm, "STRD(imm)" },
-    { 0x0E0Fu, 0x000Fu, 0x00400000u, 0x00000000u, true, exec_strd_reg, "STRD(reg)" },
-
-    // ---- DP (register) class ----
-    { 0x0DE0u, 0x0000u, 0, 0, true, handle_and, "AND" },
-    { 0x0DE0u, 0x0020u, 0, 0, true, handle_eor, "EOR" },
-    { 0x0DE0u, 0x0100u, 0, 0, true, handle_tst, "TST" },
-    { 0x0DE0u, 0x0120u, 0, 0, true, handle_teq, "TEQ" },
-    { 0x0DE0u, 0x0140u, 0, 0, true, handle_cmp, "CMP" },
-    { 0x0DE0u, 0x0160u, 0, 0, true, handle_cmn, "CMN" },
-    { 0x0DE0u, 0x0040u, 0, 0, true, handle_sub, "SUB" },
-    { 0x0DE0u, 0x0060u, 0, 0, true, handle_rsb, "RSB" },
-    { 0x0DE0u, 0x0080u, 0, 0, true, handle_add, "ADD" },
-    { 0x0DE0u, 0x00A0u, 0, 0, true, handle_adc, "ADC" },
-    { 0x0DE0u, 0x00C0u, 0, 0, true, handle_sbc, "SBC" },
-    { 0x0DE0u, 0x00E0u, 0, 0, true, handle_rsc, "RSC" },
-    { 0x0DE0u, 0x0180u, 0, 0, true, handle_orr, "ORR" },
-    { 0x0DE0u, 0x01C0u, 0, 0, true, handle_bic, "BIC" },
-    { 0x0DE0u, 0x01E0u, 0, 0, true, handle_mvn, "MVN" },
-
-    // ---- DP (immediate) class ----
-    { 0x0FE0u, 0x0200u, 0, 0, true, handle_and, "AND (imm)" },
-    { 0x0FE0u, 0x0310u, 0, 0, true, handle_tst_imm, "TST (imm)" },
-    { 0x0FE0u, 0x0330u, 0, 0, true, handle_teq, "TEQ (imm)" },
-    { 0x0FE0u, 0x0350u, 0, 0, true, handle_cmp_imm, "CMP (imm)" },
-    { 0x0FE0u, 0x0370u, 0, 0, true, handle_cmn, "CMN (imm)" },
-    { 0x0FE0u, 0x0380u, 0, 0, true, handle_orr, "ORR (imm)" },
-    { 0x0FE0u, 0x03A0u, 0, 0, true, handle_mov, "MOV (imm)" },
-    { 0x0FE0u, 0x03C0u, 0, 0, true, handle_bic, "BIC (imm)" },
-    { 0x0FE0u, 0x03E0u, 0, 0, true, handle_mvn, "MVN (imm)" },
-
-    // ---- Single data transfer ----
-    { 0x0F50u, 0x0510u, 0, 0, true, handle_ldr_preimm,   "LDR  pre-imm" },
-    { 0x0F50u, 0x0500u, 0, 0, true, handle_str_preimm,   "STR  pre-imm" },
-    { 0x0F50u, 0x0540u, 0, 0, true, handle_strb_preimm,  "STRB pre-imm" },
-    { 0x0F50u, 0x0550u, 0, 0, true, handle_ldrb_preimm,  "LDRB pre-imm" },
-    { 0x0F50u, 0x0440u, 0, 0, true, handle_strb_postimm, "STRB(post,imm)" },
-    { 0x0F50u, 0x0410u, 0, 0, true, handle_ldr_postimm,  "LDR (post,imm)" },
-    { 0x0F70u, 0x0400u, 0, 0, true, handle_str_postimm,  "STR (post,imm)" },
-    { 0x0F70u, 0x0450u, 0, 0, true, handle_ldrb_postimm, "LDRB post-imm"  }, // W=0
-    { 0x0F70u, 0x0470u, 0, 0, true, handle_ldrb_postimm, "LDRB post-imm W"}, // W=1
-    { 0x0E50u, 0x0610u, 0, 0, true, handle_ldr_regoffset,"LDR reg-offset" },
-
-    // Multiply-long
-    { 0x0E0Fu, 0x0009u, 0x0FE000F0u, 0x00800090u, true, handle_umull, "UMULL" },
-    { 0x0E0Fu, 0x0009u, 0x0FE000F0u, 0x00A00090u, true, handle_umlal, "UMLAL" },
-    { 0x0E0Fu, 0x0009u, 0x0FE000F0u, 0x00C00090u, true, handle_smull, "SMULL" },
-    { 0x0E0Fu, 0x0009u, 0x0FE000F0u, 0x00E00090u, true, handle_smlal, "SMLAL" },
-
-    // LDRB (register) split
-    { 0x0F7Fu, 0x0750u, 0, 0, true, handle_ldrb_reg,       "LDRB reg pre LSL#0" },
-    { 0x0F71u, 0x0750u, 0, 0, true, handle_ldrb_reg_shift, "LDRB reg imm-shift" },
-
-    // Stack-ish specials
-    { 0x0FF0u, 0x0520u, 0x000F0000u, 0x000D0000u, true, handle_str_predec, "STR(pre-dec SP,imm)" },
-    { 0x0FFFu, 0x0490u, 0x0FFFF000u, 0x049DF000u, true, handle_pop_pc,     "POP{..,pc}" },
-
-    // Branch family
-    { 0x0F00u, 0x0A00u, 0, 0, true, handle_b,  "B"  },
-    { 0x0F00u, 0x0B00u, 0, 0, true, handle_bl, "BL" },
-	
- // ---- System / exact 32-bit patterns ----
-    { 0x0F00u, 0x0F00u, 0x0F000000u, 0x0F000000u, true,  handle_svc, "SVC" },
-    { 0x0FBFu, 0x0100u, 0x0FBF0FFFu, 0x010F0000u, true,  handle_mrs, "MRS" },
-    { 0x0FFFu, 0x0320u, 0xFFFFFFFFu, 0xE320F000u, false, handle_nop, "NOP" },
-    { 0x0FFFu, 0x0320u, 0xFFFFFFFFu, 0xE320F003u, false, handle_wfi, "WFI" },
-
-    // ---- Easter egg / halt ----
-    { 0x0FFFu, 0x0EAEu, 0xFFFFFFFFu, 0xDEADBEEFu, false, handle_deadbeef, "DEADBEEF" },
+#define K12_RULE(m12, v12, xm, xv, cc, fn, name) { m12, v12, xm, xv, cc, fn, name },
+#include "k12_rules.def"
+#undef K12_RULE
 };
 
 // -------------------- 4096 per-key candidate lists --------------------
+// Generated at build time by k12gen (same rules, same priority order), so
+// there is nothing to build on first decode. A bucket is one 24-byte record;
+// when it has a single candidate -- the common case -- that rule's handler,
+// xmask32 and cond flag sit in the bucket itself and dispatch never touches
+// K12_CANDS or K12_TABLE.
 #define KEY12_SPACE 4096
 #define MAX_PER_KEY 16
+#define K12_RULES   (sizeof(K12_TABLE)/sizeof(K12_TABLE[0]))
 
-static uint16_t g_keylist[KEY12_SPACE][MAX_PER_KEY];
-static uint8_t  g_keyprio[KEY12_SPACE][MAX_PER_KEY];
-static uint8_t  g_keycount[KEY12_SPACE];
-static bool     g_k12_ready = false;
-
-// --- popcounts for priority ---
-static inline uint8_t popcnt16(uint16_t x){
-    x = (x & 0x5555u) + ((x >> 1) & 0x5555u);
-    x = (x & 0x3333u) + ((x >> 2) & 0x3333u);
-    x = (x + (x >> 4)) & 0x0F0Fu;
-    x = x + (x >> 8);
-    return (uint8_t)(x & 0x1Fu);
+typedef struct {
+    insn_handler_t fn;          // count == 1: the candidate's handler
+    uint32_t       xmask32;     // count == 1: its disambiguation (0 => none)
+    uint32_t       xvalue32;
+    uint16_t       first;       // candidates: K12_CANDS[first .. first+count)
+    uint8_t        count;       // 0 = no rule for this key
+    uint8_t        dropped;     // matching rules cut at MAX_PER_KEY
+    bool           check_cond;  // count == 1: apply cond?
+} k12_bucket;
+
+#include "k12_dispatch.inc"
+
+// The .inc holds k12gen's fold of the rules list; an edited, added, removed
+// or moved rule changes this one (k12_rules_hash.h).
+#define K12_RULE K12_RULE_HASH
+_Static_assert(K12_GEN_RULES_HASH == (0ull
+#include "k12_rules.def"
+               ), "k12_dispatch.inc is stale: rerun k12gen");
+#undef K12_RULE
+
+// Generic DP handlers (alu.c/logic.c, Operand2 via dp_operand2()) and the
+// opcode (bits 24:21) each implements; -1 for anything else.
+static int k12_dp_opcode(insn_handler_t fn) {
+    static const struct { insn_handler_t fn; int op; } DP[] = {
+        { handle_and, 0x0 }, { handle_eor, 0x1 }, { handle_sub, 0x2 }, { handle_rsb, 0x3 },
+        { handle_add, 0x4 }, { handle_adc, 0x5 }, { handle_sbc, 0x6 }, { handle_rsc, 0x7 },
+        { handle_tst, 0x8 }, { handle_tst_imm, 0x8 }, { handle_teq, 0x9 },
+        { handle_cmp, 0xA }, { handle_cmp_imm, 0xA }, { handle_cmn, 0xB },
+        { handle_orr, 0xC }, { handle_mov, 0xD }, { handle_bic, 0xE }, { handle_mvn, 0xF },
+    };
+    for (size_t i = 0; i < sizeof(DP)/sizeof(DP[0]); ++i)
+        if (DP[i].fn == fn) return DP[i].op;
+    return -1;
 }
-static inline uint8_t popcnt32(uint32_t x){
-    x = x - ((x >> 1) & 0x55555555u);
-    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
-    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
-    x = x + (x >> 8);
-    x = x + (x >> 16);
-    return (uint8_t)(x & 0x3Fu);
+
+// Branch/trap class handlers: predecoding past these is wasted work.
+static bool k12_ends_block(insn_handler_t fn) {
+    return fn == handle_b       || fn == handle_bl      ||
+           fn == handle_bx      || fn == handle_blx_reg ||
+           fn == handle_blx_imm || fn == handle_svc     ||
+           fn == handle_bkpt    || fn == handle_deadbeef ||
+           fn == handle_pop_pc  || fn == handle_wfi;
 }
 
-// Priority = specificity of mask12 + specificity of xmask32.
-// This makes MOVW/MOVT outrank generic DP; STRD/LDRD (tiny xmask32) won’t outrank them.
-static inline uint8_t k12_priority(const k12_entry *e) {
-    uint8_t p = popcnt16(e->mask12);   // 0..12
-    p += popcnt32(e->xmask32);         // 0..32 (often small; MOVW/MOVT are larger)
-    return p;
+// Handlers whose only effects are register and NZCV writes (plus memory
+// reads): the ops an idle loop may be built from. DP and LDM forms that
+// restore CPSR from SPSR (S with Rd = PC, LDM ^) switch modes and are out.
+static bool k12_reads_only(insn_handler_t fn, uint32_t instr) {
+    if (k12_dp_opcode(fn) >= 0)
+        return !(((instr >> 12) & 0xFu) == 15u && (instr & (1u << 20)));
+    if (fn == handle_ldm || fn == handle_pop_pc)
+        return !(instr & (1u << 22));
+    if (fn == handle_b)
+        return (instr >> 28) != 0xFu;
+    return fn == handle_ldr_literal  || fn == handle_ldr_preimm    ||
+           fn == handle_ldr_postimm  || fn == handle_ldr_regoffset ||
+           fn == handle_ldrb_preimm  || fn == handle_ldrb_postimm  ||
+           fn == handle_ldrb_reg     || fn == handle_ldrb_reg_shift ||
+           fn == handle_ldrh         || fn == handle_ldrsb         ||
+           fn == handle_ldrsh        || fn == handle_movw          ||
+           fn == handle_movt         || fn == handle_mrs           ||
+           fn == handle_clz          || fn == handle_bfc           ||
+           fn == handle_bfi          || fn == handle_mul           ||
+           fn == handle_mla          || fn == handle_umull         ||
+           fn == handle_umlal        || fn == handle_smull         ||
+           fn == handle_smlal        || fn == handle_nop           ||
+           fn == handle_dsb          || fn == handle_dmb           ||
+           fn == handle_isb          || fn == handle_udiv          ||
+           fn == handle_sdiv         || fn == handle_rev           ||
+           fn == handle_rev16        || fn == handle_revsh         ||
+           fn == handle_rbit         || fn == handle_uxtb          ||
+           fn == handle_uxth         || fn == handle_sxtb          ||
+           fn == handle_sxth         || fn == handle_extend        ||
+           fn == handle_ubfx         || fn == handle_sbfx          ||
+           fn == handle_pkh;
 }
 
-// Build per-key lists, sorted by priority (desc). Seed order is irrelevant.
-static void k12_build_table(void) {
-    for (int k = 0; k < KEY12_SPACE; ++k) g_keycount[k] = 0;
+// ------------------------- decoder statistics -------------------------
+// Filled only while DBG_K12STATS is set (which keeps every instruction on
+// this decoder rather than the predecoded paths). Shared by all VMs, so the
+// counters are bumped atomically.
+static uint64_t g_st_rule_hits[K12_RULES];      // rule selected
+static uint64_t g_st_rule_fail[K12_RULES];      // ... but its condition failed
+static uint64_t g_st_key_lookups[KEY12_SPACE];
+static uint64_t g_st_key_walk[KEY12_SPACE];     // candidates examined
+static uint64_t g_st_key_miss[KEY12_SPACE];     // no candidate matched
+
+#if defined(__GNUC__)
+#define STAT_ADD(x, v) __atomic_fetch_add(&(x), (v), __ATOMIC_RELAXED)
+#define STAT_GET(x)    __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STAT_SET(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#else
+#define STAT_ADD(x, v) ((x) += (v))
+#define STAT_GET(x)    (x)
+#define STAT_SET(x, v) ((x) = (v))
+#endif
+
+// Lookup of key k that examined walk candidates and picked rule (or none).
+static void k12_stats_note(uint16_t k, uint32_t walk, int rule, bool cond_fail) {
+    STAT_ADD(g_st_key_lookups[k], 1);
+    STAT_ADD(g_st_key_walk[k], walk);
+    if (rule < 0) { STAT_ADD(g_st_key_miss[k], 1); return; }
+    STAT_ADD(g_st_rule_hits[rule], 1);
+    if (cond_fail) STAT_ADD(g_st_rule_fail[rule], 1);
+}
 
-    const size_t N = sizeof(K12_TABLE)/sizeof(K12_TABLE[0]);
+void execute_stats_reset(void) {
+    for (size_t i = 0; i < K12_RULES; ++i) {
+        STAT_SET(g_st_rule_hits[i], 0);
+        STAT_SET(g_st_rule_fail[i], 0);
+    }
     for (int k = 0; k < KEY12_SPACE; ++k) {
-        uint8_t cnt = 0;
-        for (uint16_t ei = 0; ei < N; ++ei) {
-            const k12_entry *e = &K12_TABLE[ei];
-            if (((uint16_t)k & e->mask12) == e->value12) {
-                uint8_t pr = k12_priority(e);
-
-                if (cnt < MAX_PER_KEY) {
-                    // insert by priority (desc), stable on ties
-                    uint8_t pos = cnt;
-                    while (pos > 0 && pr > g_keyprio[k][pos-1]) {
-                        g_keyprio[k][pos] = g_keyprio[k][pos-1];
-                        g_keylist[k][pos] = g_keylist[k][pos-1];
-                        --pos;
-                    }
-                    g_keyprio[k][pos] = pr;
-                    g_keylist[k][pos] = ei;
-                    ++cnt;
-                } else {
-                    // list full: bump in only if more specific than last slot
-                    if (pr > g_keyprio[k][cnt-1]) {
-                        uint8_t pos = cnt - 1;
-                        while (pos > 0 && pr > g_keyprio[k][pos-1]) {
-                            g_keyprio[k][pos] = g_keyprio[k][pos-1];
-                            g_keylist[k][pos] = g_keylist[k][pos-1];
-                            --pos;
-                        }
-                        g_keyprio[k][pos] = pr;
-                        g_keylist[k][pos] = ei;
-                    }
-                }
-            }
-        }
-        g_keycount[k] = cnt;
+        STAT_SET(g_st_key_lookups[k], 0);
+        STAT_SET(g_st_key_walk[k], 0);
+        STAT_SET(g_st_key_miss[k], 0);
+    }
+}
+
+static int cmp_desc_u64(uint64_t a, uint64_t b) { return (a < b) - (a > b); }
+
+static int cmp_rule_hits(const void *x, const void *y) {
+    uint16_t a = *(const uint16_t*)x, b = *(const uint16_t*)y;
+    int c = cmp_desc_u64(STAT_GET(g_st_rule_hits[a]), STAT_GET(g_st_rule_hits[b]));
+    return c ? c : (a > b) - (a < b);
+}
+
+static int cmp_key_walk(const void *x, const void *y) {
+    uint16_t a = *(const uint16_t*)x, b = *(const uint16_t*)y;
+    int c = cmp_desc_u64(STAT_GET(g_st_key_walk[a]), STAT_GET(g_st_key_walk[b]));
+    return c ? c : (a > b) - (a < b);
+}
+
+static double ratio(uint64_t a, uint64_t b) { return b ? (double)a / (double)b : 0.0; }
+
+void execute_stats_report(unsigned top) {
+    uint64_t lookups = 0, walk = 0, miss = 0, fail = 0;
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        lookups += STAT_GET(g_st_key_lookups[k]);
+        walk    += STAT_GET(g_st_key_walk[k]);
+        miss    += STAT_GET(g_st_key_miss[k]);
+    }
+    for (size_t i = 0; i < K12_RULES; ++i) fail += STAT_GET(g_st_rule_fail[i]);
+    log_printf("[K12STATS] %" PRIu64 " decodes, %" PRIu64 " unmatched, %" PRIu64
+               " cond-fail (%.2f%%), avg walk %.2f\n",
+               lookups, miss, fail, 100.0 * ratio(fail, lookups), ratio(walk, lookups));
+
+    uint16_t order[KEY12_SPACE > K12_RULES ? KEY12_SPACE : K12_RULES];
+    for (uint16_t i = 0; i < K12_RULES; ++i) order[i] = i;
+    qsort(order, K12_RULES, sizeof order[0], cmp_rule_hits);
+    log_printf("Rules by hits:\n          hits   cond-fail   fail%%  rule  name\n");
+    for (unsigned i = 0; i < top && i < K12_RULES; ++i) {
+        uint16_t r = order[i];
+        uint64_t h = STAT_GET(g_st_rule_hits[r]), f = STAT_GET(g_st_rule_fail[r]);
+        if (!h) break;
+        log_printf("%14" PRIu64 " %11" PRIu64 " %6.2f  %4u  %s\n",
+                   h, f, 100.0 * ratio(f, h), r, K12_TABLE[r].name);
+    }
+
+    for (uint16_t k = 0; k < KEY12_SPACE; ++k) order[k] = k;
+    qsort(order, KEY12_SPACE, sizeof order[0], cmp_key_walk);
+    log_printf("Buckets by candidates walked:\n   key       lookups   avg walk  cands  dropped  unmatched\n");
+    for (unsigned i = 0; i < top && i < KEY12_SPACE; ++i) {
+        uint16_t k = order[i];
+        uint64_t l = STAT_GET(g_st_key_lookups[k]);
+        if (!l) break;
+        log_printf("   0x%03X %12" PRIu64 " %10.2f %6u %8u %10" PRIu64 "\n",
+                   k, l, ratio(STAT_GET(g_st_key_walk[k]), l), K12_BUCKETS[k].count, K12_BUCKETS[k].dropped,
+                   STAT_GET(g_st_key_miss[k]));
+    }
+
+    unsigned trunc = 0;
+    for (int k = 0; k < KEY12_SPACE; ++k) trunc += K12_BUCKETS[k].dropped != 0;
+    if (trunc) {
+        log_printf("Truncated buckets (more than %d candidates):", MAX_PER_KEY);
+        for (int k = 0; k < KEY12_SPACE; ++k)
+            if (K12_BUCKETS[k].dropped) log_printf(" 0x%03X(-%u)", k, K12_BUCKETS[k].dropped);
+        log_printf("\n");
     }
-    g_k12_ready = true;
 }
 
-static inline void k12_ensure_built(void) {
-    if (!g_k12_ready) k12_build_table();
+bool execute_stats_csv(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        log_printf("[K12STATS] cannot create '%s'\n", path);
+        return false;
+    }
+    fprintf(f, "kind,index,name,hits,cond_fail,lookups,walk,unmatched,candidates,dropped\n");
+    for (size_t i = 0; i < K12_RULES; ++i)
+        fprintf(f, "rule,%u,\"%s\",%" PRIu64 ",%" PRIu64 ",,,,,\n", (unsigned)i, K12_TABLE[i].name,
+                STAT_GET(g_st_rule_hits[i]), STAT_GET(g_st_rule_fail[i]));
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        uint64_t l = STAT_GET(g_st_key_lookups[k]);
+        if (!l && !K12_BUCKETS[k].dropped) continue;
+        fprintf(f, "bucket,0x%03X,,,,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u,%u\n", k, l,
+                STAT_GET(g_st_key_walk[k]), STAT_GET(g_st_key_miss[k]), K12_BUCKETS[k].count, K12_BUCKETS[k].dropped);
+    }
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) ok = false;
+    log_printf("[K12STATS] wrote %s\n", path);
+    return ok;
+}
+
+// ------------------------- word memo -------------------------
+// Direct-mapped cache from a whole instruction word to the rule the
+// candidate walk picked for it (with the handler already specialized for DP
+// shapes), so a word seen before dispatches in one probe wherever it sits.
+// Keyed by content, so guest writes never invalidate it. Only multi-candidate
+// buckets use it; single-candidate ones already resolve in one step.
+#define K12_MEMO_BITS  10u
+#define K12_MEMO_SLOTS (1u << K12_MEMO_BITS)
+
+typedef struct {
+    uint32_t       instr;
+    uint16_t       rule;
+    bool           check_cond;
+    insn_handler_t fn;          // NULL = empty slot
+} k12_memo;
+
+static VM_TLS k12_memo g_memo[K12_MEMO_SLOTS];
+
+static inline uint32_t k12_memo_slot(uint32_t instr) {
+    return (instr * 0x9E3779B1u) >> (32u - K12_MEMO_BITS);
+}
+
+// Memo entry for instr (bucket b), walking the candidates on a miss; NULL
+// when no rule matches.
+static const k12_memo *k12_memo_get(uint32_t instr, const k12_bucket *b) {
+    k12_memo *m = &g_memo[k12_memo_slot(instr)];
+    if (m->fn && m->instr == instr) return m;
+
+    const uint16_t *cand = &K12_CANDS[b->first];
+    for (uint8_t i = 0; i < b->count; ++i) {
+        const k12_entry *e = &K12_TABLE[cand[i]];
+        if (e->xmask32 && ((instr & e->xmask32) != e->xvalue32))
+            continue;
+        m->instr      = instr;
+        m->rule       = cand[i];
+        m->check_cond = e->check_cond;
+        m->fn         = e->fn;
+        if (k12_dp_opcode(e->fn) == (int)((instr >> 21) & 0xFu)) {
+            insn_handler_t v = dp_variant(instr);
+            if (v) m->fn = v;
+        }
+        return m;
+    }
+    return NULL;
 }
 
 // ---------------------- fast dispatcher with xmask32 ----------------------
+// Run rule (found after walking `walk` candidates of bucket k): cond check,
+// logs/stats, handler.
+static inline bool k12_dispatch(uint32_t instr, uint16_t k, uint32_t walk, uint16_t rule,
+                                bool check_cond, insn_handler_t fn) {
+    // Condition check (unless suppressed for this entry)
+    if (check_cond) {
+        uint8_t cond = (instr >> 28) & 0xF;
+        if (cond != 0xF && !evaluate_condition(cond)) {
+            if (debug_flags & DBG_K12STATS)
+                k12_stats_note(k, walk, rule, true);
+            if (debug_flags & DBG_K12)
+                log_printf("[K12] %s cond fail (0x%X)\n", K12_TABLE[rule].name, cond);
+            return true; // decoded but skipped by condition
+        }
+    }
+
+    if (debug_flags & DBG_K12STATS)
+        k12_stats_note(k, walk, rule, false);
+    if (debug_flags & DBG_K12)
+        log_printf("[K12] %s match (key=0x%03X)\n", K12_TABLE[rule].name, k);
+
+    fn(instr);
+    return true;
+}
+
 static inline bool try_decode_key12_fast(uint32_t instr) {
     uint16_t k = key12(instr);
+    const k12_bucket *b = &K12_BUCKETS[k];
 
     if (debug_flags & DBG_K12) {
         log_printf("[K12] key=0x%03X op1=%u op2=%u op3=%u\n",
                    k, (instr>>25)&7, (instr>>20)&31, (instr>>4)&15);
     }
 
-    uint8_t cnt = g_keycount[k];
-    for (uint8_t i = 0; i < cnt; ++i) {
-        const k12_entry *e = &K12_TABLE[g_keylist[k][i]];
-
-        // Optional exact 32-bit disambiguation
-        if (e->xmask32 && ((instr & e->xmask32) != e->xvalue32))
-            continue;
-
-        // Condition check (unless suppressed for this entry)
-        if (e->check_cond) {
-            uint8_t cond = (instr >> 28) & 0xF;
-            if (cond != 0xF && !evaluate_condition(cond)) {
-                if (debug_flags & DBG_K12)
-                    log_printf("[K12] %s cond fail (0x%X)\n", e->name, cond);
-                return true; // decoded but skipped by condition
-            }
+    // Single candidate: everything needed is in the bucket.
+    if (b->count == 1) {
+        if (!b->xmask32 || (instr & b->xmask32) == b->xvalue32)
+            return k12_dispatch(instr, k, 1, K12_CANDS[b->first], b->check_cond, b->fn);
+    } else if (!(debug_flags & (DBG_K12 | DBG_K12STATS))) {
+        const k12_memo *m = k12_memo_get(instr, b);
+        if (m) return k12_dispatch(instr, k, 1, m->rule, m->check_cond, m->fn);
+    } else {
+        // Logging and stats want the walk itself.
+        const uint16_t *cand = &K12_CANDS[b->first];
+        for (uint8_t i = 0; i < b->count; ++i) {
+            const k12_entry *e = &K12_TABLE[cand[i]];
+
+            // Optional exact 32-bit disambiguation
+            if (e->xmask32 && ((instr & e->xmask32) != e->xvalue32))
+                continue;
+
+            return k12_dispatch(instr, k, i + 1u, cand[i], e->check_cond, e->fn);
         }
+    }
+    if (debug_flags & DBG_K12STATS) k12_stats_note(k, b->count, -1, false);
+    return false; // no rule matched this key/xmask
+}
 
-        if (debug_flags & DBG_K12)
-            log_printf("[K12] %s match (key=0x%03X)\n", e->name, k);
+// ------------------------- predecode (no execute) -------------------------
+static void k12_fill_op(uint32_t instr, uint16_t rule, k12_op *out) {
+    const k12_entry *e = &K12_TABLE[rule];
+    out->fn         = e->fn;
+    out->instr      = instr;
+    out->rule       = rule;
+    out->cond       = (uint8_t)((instr >> 28) & 0xF);
+    out->rn         = (uint8_t)((instr >> 16) & 0xF);
+    out->rd         = (uint8_t)((instr >> 12) & 0xF);
+    out->rm         = (uint8_t)( instr        & 0xF);
+    out->kind       = (e->check_cond && out->cond < 0xE) ? K12_OP_COND : K12_OP_PLAIN;
+    out->imm        = 0;
+    if (e->fn == handle_b && out->cond != 0xF) {
+        out->kind = K12_OP_B;
+        out->imm  = ((int32_t)((instr & 0x00FFFFFFu) << 8) >> 6) + 8;
+    }
+    out->ends_block = k12_ends_block(e->fn);
+    out->reads_only = k12_reads_only(e->fn, instr);
 
-        e->fn(instr);
+    // DP words get a handler specialized for their Operand2 shape and S.
+    if (k12_dp_opcode(e->fn) == (int)((instr >> 21) & 0xFu)) {
+        insn_handler_t v = dp_variant(instr);
+        if (v) out->fn = v;
+    }
+}
+
+bool execute_decode(uint32_t instr, k12_op *out) {
+    uint16_t k = key12(instr);
+    const k12_bucket *b = &K12_BUCKETS[k];
+    if (b->count > 1) {
+        const k12_memo *m = k12_memo_get(instr, b);
+        if (!m) return false;
+        k12_fill_op(instr, m->rule, out);
         return true;
     }
-    return false; // no rule matched this key/xmask
+    if (b->count == 1 && (!b->xmask32 || (instr & b->xmask32) == b->xvalue32)) {
+        k12_fill_op(instr, K12_CANDS[b->first], out);
+        return true;
+    }
+    return false;
+}
+
+bool execute_decode_rule(uint32_t instr, uint16_t rule, k12_op *out) {
+    if (rule >= K12_RULES) return false;
+    const k12_entry *e = &K12_TABLE[rule];
+    if ((key12(instr) & e->mask12) != e->value12) return false;
+    if (e->xmask32 && (instr & e->xmask32) != e->xvalue32) return false;
+    k12_fill_op(instr, rule, out);
+    return true;
+}
+
+// FNV-1a over everything that decides which rule index a word resolves to.
+uint64_t execute_rules_hash(void) {
+    uint64_t h = 0xCBF29CE484222325ull;
+#define K12_HASH_BYTE(v) do { h ^= (uint8_t)(v); h *= 0x100000001B3ull; } while (0)
+    for (size_t r = 0; r < K12_RULES; ++r) {
+        const k12_entry *e = &K12_TABLE[r];
+        uint32_t f[5] = { e->mask12, e->value12, e->xmask32, e->xvalue32, e->check_cond };
+        for (unsigned i = 0; i < 5; ++i)
+            for (unsigned j = 0; j < 4; ++j) K12_HASH_BYTE(f[i] >> (8 * j));
+        for (const char *c = e->name; *c; ++c) K12_HASH_BYTE(*c);
+        K12_HASH_BYTE(0);
+    }
+#undef K12_HASH_BYTE
+    return h;
+}
+
+// ------------------------- superinstructions -------------------------
+// Compiler idioms the threaded loop runs with one dispatch: a 32-bit
+// constant built by MOVW+MOVT, a compare-immediate feeding a conditional
+// branch (flags recorded once, the branch decided from the same operands),
+// and a load followed by a base increment. Both ops must be unconditional
+// but the branch.
+static uint32_t k12_dp_imm(uint32_t instr) {
+    uint32_t rot = ((instr >> 8) & 0xFu) * 2u, v = instr & 0xFFu;
+    return rot ? (v >> rot) | (v << (32u - rot)) : v;
+}
+
+void execute_fuse(k12_op *first, const k12_op *second) {
+    const uint32_t a = first->instr, b = second->instr;
+    if (first->kind != K12_OP_PLAIN || first->cond != 0xE) return;
+
+    if (first->fn == handle_movw && second->fn == handle_movt && second->cond == 0xE &&
+        first->rd == second->rd && first->rd != 15) {
+        uint32_t lo = ((a >> 4) & 0xF000u) | (a & 0xFFFu);
+        uint32_t hi = ((b >> 4) & 0xF000u) | (b & 0xFFFu);
+        first->kind = K12_OP_MOVWT;
+        first->imm  = (int32_t)(lo | (hi << 16));
+    } else if ((a & 0x0FF00000u) == 0x03500000u && first->rn != 15 &&      // CMP Rn,#imm
+               first->fn == dp_variant(a) && second->kind == K12_OP_B) {
+        first->kind = K12_OP_CMPB;
+        first->imm  = (int32_t)k12_dp_imm(a);
+    } else if (first->fn == handle_ldr_preimm && first->rd != 15 && first->rn != 15 &&
+               first->rd != first->rn && (b & 0x0FF00000u) == 0x02800000u &&   // ADD, no S
+               second->cond == 0xE && second->rn == first->rn && second->rd == first->rn &&
+               second->fn == dp_variant(b)) {
+        first->kind = K12_OP_LDRADD;
+        first->imm  = (int32_t)k12_dp_imm(b);
+    }
+}
+
+const char *execute_rule_name(uint16_t rule) {
+    const size_t N = sizeof(K12_TABLE)/sizeof(K12_TABLE[0]);
+    return (rule < N) ? K12_TABLE[rule].name : "?";
 }
 
 // ------------------------------- executor --------------------------------
 bool execute(uint32_t instr) {
-    k12_ensure_built();
-
     if (debug_flags & DBG_TRACE) {
         uint32_t pc = cpu.r[15];
         log_printf("[TRACE] PC=0x%08X Instr=0x%08X\n", pc, instr);
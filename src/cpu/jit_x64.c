@@ -0,0 +1,763 @@
+// src/cpu/jit_x64.c — tier 2: hot tcache blocks as x86-64 host code
+// One translation per block, emitted into a per-VM code buffer. Register
+// use inside translated code:
+//   rbx  &cpu            rbp  &jit_env (run state, see below)
+//   r12-r15  up to four guest registers cached for the whole block
+//   rax rcx rdx, ARG0/ARG1  scratch (clobbered by every helper call)
+// Cached registers are written back before anything that reads cpu.r[]
+// (handler calls, exits) and reloaded after a handler call. Flags are kept
+// in cpu.cpsr: inline flag-setting ops write NZCV there and clear lf_op,
+// and anything that reads NZCV first folds a handler's lazy flags.
+// All code is discarded at once whenever the tcache generation moves (a
+// write into cached code, a flush), so chained jumps never outlive what they
+// were made from.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "jit.h"
+
+#if CPU_JIT
+
+// Native Windows allocates code with VirtualAlloc; everything else,
+// Cygwin included, with mmap. Win64 and Cygwin64 both call with the
+// Microsoft x64 convention (args in rcx, rdx, 32 bytes of shadow space).
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define JIT_VIRTUALALLOC 1
+#include <windows.h>
+#else
+#define JIT_VIRTUALALLOC 0
+#include <sys/mman.h>
+#endif
+
+#if defined(_WIN64) || defined(__CYGWIN__)
+#define JIT_MS_ABI 1
+#else
+#define JIT_MS_ABI 0
+#endif
+
+#include "cpu.h"
+#include "cpu_flags.h"   // cpu_flags_sync()
+#include "cond.h"        // g_cond_pass
+#include "execute.h"
+#include "dp_variants.h"
+#include "memops.h"
+#include "branch.h"
+#include "logic.h"      // handle_movw/movt
+#include "tcache.h"
+#include "mem.h"
+#include "hw.h"
+
+#define JIT_CODE_SIZE  (4u << 20)       // per VM; when full, start over
+#define JIT_BLOCK_MAX  (24u << 10)      // room checked before each translation
+#define JIT_MAX_EXITS  (4u * TC_MAX_OPS)
+#define JIT_CACHED     4                // guest registers held in host registers
+
+// State of one run through translated code (jit_run() to return).
+typedef struct {
+    CPU            *cpu;
+    uint64_t       *now;        // &g_hw->now
+    uint32_t       *unsynced;   // threaded loop's clock cursor
+    const uint32_t *tc_gen;     // &g_tc->gen
+    const uint64_t *hw_next;    // &g_hw->next
+    const bool     *irq;        // &g_hw->irq
+    uint64_t        next;       // g_hw->next at entry
+    uint32_t        gen;        // g_tc->gen at entry
+    uint32_t        budget;     // instructions still allowed; blocks take theirs on entry
+    uint32_t        end;        // straight-line pc after the last op retired
+    uint8_t        *chain;      // rel32 of the direct exit taken into an untranslated block
+} jit_env;
+
+struct jit_state {
+    uint8_t  *code;
+    size_t    used;
+    size_t    base;             // enter/leave stubs live below this
+    uint32_t  epoch;            // bumped whenever the code is discarded
+    uint32_t  gen;              // g_tc->gen the code was made under
+    uint8_t  *leave;            // epilogue (return to jit_run)
+    void    (*enter)(jit_env *env, void *entry);
+};
+
+// ---------------------------------------------------------------------------
+// x86-64 encoding
+// ---------------------------------------------------------------------------
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum { CC_O = 0, CC_NO, CC_B, CC_AE, CC_E, CC_NE, CC_BE, CC_A };
+enum { ALU_ADD = 0, ALU_OR = 1, ALU_ADC = 2, ALU_SBB = 3, ALU_AND = 4, ALU_SUB = 5, ALU_XOR = 6, ALU_CMP = 7 };
+enum { SH_ROR = 1, SH_SHL = 4, SH_SHR = 5, SH_SAR = 7 };
+
+#if JIT_MS_ABI
+#define ARG0 RCX
+#define ARG1 RDX
+#else
+#define ARG0 RDI
+#define ARG1 RSI
+#endif
+
+#define CPU_OFF(f)   ((int32_t)offsetof(CPU, f))
+#define CPU_R(n)     ((int32_t)(offsetof(CPU, r) + 4u * (n)))
+#define ENV_OFF(f)   ((int32_t)offsetof(jit_env, f))
+
+typedef struct {
+    uint8_t  kind;              // JX_*
+    uint8_t *site;              // rel32 jumping here
+    uint32_t pc;                // JX_PC: new r15
+    uint32_t end;
+    uint32_t giveback;          // budget the block took but did not use
+    uint16_t dirty;
+} jit_exit;
+
+enum { JX_PC, JX_NPC, JX_HALT };
+
+typedef struct {
+    jit_state *js;
+    uint8_t   *p, *lim;
+    bool       full;
+    int8_t     host[16];        // guest reg -> host reg, -1 = cpu.r[]
+    uint16_t   cached;          // guest regs in host regs
+    uint16_t   dirty;           // ... newer than cpu.r[]
+    bool       flags_synced;    // lf_op known to be LF_NONE
+    jit_exit   exits[JIT_MAX_EXITS];
+    unsigned   n_exits;
+} jit_cg;
+
+static inline void e8(jit_cg *g, uint32_t v) {
+    if (g->p < g->lim) *g->p++ = (uint8_t)v;
+    else g->full = true;
+}
+static void e32(jit_cg *g, uint32_t v) { for (int i = 0; i < 4; ++i) e8(g, v >> (8 * i)); }
+static void e64(jit_cg *g, uint64_t v) { e32(g, (uint32_t)v); e32(g, (uint32_t)(v >> 32)); }
+
+static void rex(jit_cg *g, int w, int r, int b) {
+    uint8_t x = (uint8_t)(0x40 | (w << 3) | (((r >> 3) & 1) << 2) | ((b >> 3) & 1));
+    if (x != 0x40) e8(g, x);
+}
+
+// op r/m32, r32 (register form): dst is r/m
+static void x_rr(jit_cg *g, uint8_t op, int src, int dst) {
+    rex(g, 0, src, dst); e8(g, op); e8(g, 0xC0 | ((src & 7) << 3) | (dst & 7));
+}
+// op with a [base + disp32] operand; base is never rsp/r12
+static void x_mem(jit_cg *g, int w, const uint8_t *op, int nop, int reg, int base, int32_t disp) {
+    rex(g, w, reg, base);
+    for (int i = 0; i < nop; ++i) e8(g, op[i]);
+    e8(g, 0x80 | ((reg & 7) << 3) | (base & 7));
+    e32(g, (uint32_t)disp);
+}
+static void x_mov_rr(jit_cg *g, int dst, int src) { if (dst != src) x_rr(g, 0x89, src, dst); }
+static void x_ld32(jit_cg *g, int dst, int base, int32_t d) { static const uint8_t o[] = {0x8B}; x_mem(g, 0, o, 1, dst, base, d); }
+static void x_st32(jit_cg *g, int base, int32_t d, int src) { static const uint8_t o[] = {0x89}; x_mem(g, 0, o, 1, src, base, d); }
+static void x_ld64(jit_cg *g, int dst, int base, int32_t d) { static const uint8_t o[] = {0x8B}; x_mem(g, 1, o, 1, dst, base, d); }
+static void x_st64(jit_cg *g, int base, int32_t d, int src) { static const uint8_t o[] = {0x89}; x_mem(g, 1, o, 1, src, base, d); }
+static void x_mov_ri(jit_cg *g, int r, uint32_t imm) { rex(g, 0, 0, r); e8(g, 0xB8 + (r & 7)); e32(g, imm); }
+static void x_mov_ri64(jit_cg *g, int r, uint64_t imm) { rex(g, 1, 0, r); e8(g, 0xB8 + (r & 7)); e64(g, imm); }
+static void x_alu_ri(jit_cg *g, int ext, int r, uint32_t imm) {
+    rex(g, 0, 0, r); e8(g, 0x81); e8(g, 0xC0 | (ext << 3) | (r & 7)); e32(g, imm);
+}
+static void x_alu_mi(jit_cg *g, int ext, int base, int32_t d, uint32_t imm) {
+    static const uint8_t o[] = {0x81}; x_mem(g, 0, o, 1, ext, base, d); e32(g, imm);
+}
+static void x_mov_mi(jit_cg *g, int base, int32_t d, uint32_t imm) {
+    static const uint8_t o[] = {0xC7}; x_mem(g, 0, o, 1, 0, base, d); e32(g, imm);
+}
+static void x_cmp_m8i(jit_cg *g, int base, int32_t d, uint8_t imm) {
+    static const uint8_t o[] = {0x80}; x_mem(g, 0, o, 1, 7, base, d); e8(g, imm);
+}
+static void x_mov_m8i(jit_cg *g, int base, int32_t d, uint8_t imm) {
+    static const uint8_t o[] = {0xC6}; x_mem(g, 0, o, 1, 0, base, d); e8(g, imm);
+}
+static void x_bt_mi(jit_cg *g, int base, int32_t d, uint8_t bit) {
+    static const uint8_t o[] = {0x0F, 0xBA}; x_mem(g, 0, o, 2, 4, base, d); e8(g, bit);
+}
+static void x_shift(jit_cg *g, int ext, int r, uint8_t n) {
+    rex(g, 0, 0, r); e8(g, 0xC1); e8(g, 0xC0 | (ext << 3) | (r & 7)); e8(g, n);
+}
+static void x_not(jit_cg *g, int r) { rex(g, 0, 0, r); e8(g, 0xF7); e8(g, 0xD0 | (r & 7)); }
+static void x_setcc(jit_cg *g, int cc, int r8) { e8(g, 0x0F); e8(g, 0x90 + cc); e8(g, 0xC0 | r8); }  // al..bl
+static void x_movzx8(jit_cg *g, int dst, int src8) { e8(g, 0x0F); e8(g, 0xB6); e8(g, 0xC0 | (dst << 3) | src8); }
+static void x_call(jit_cg *g, const void *fn) {
+    x_mov_ri64(g, RAX, (uint64_t)(uintptr_t)fn);
+    e8(g, 0xFF); e8(g, 0xD0);
+}
+static uint8_t *x_jcc(jit_cg *g, int cc) { e8(g, 0x0F); e8(g, 0x80 + cc); uint8_t *s = g->p; e32(g, 0); return s; }
+static uint8_t *x_jmp(jit_cg *g) { e8(g, 0xE9); uint8_t *s = g->p; e32(g, 0); return s; }
+
+static void x_patch(uint8_t *site, const uint8_t *to) {
+    if (!site) return;
+    int32_t rel = (int32_t)(to - (site + 4));
+    memcpy(site, &rel, 4);
+}
+
+// ---------------------------------------------------------------------------
+// Guest state helpers
+// ---------------------------------------------------------------------------
+static void jit_flags_sync(void) { cpu_flags_sync(); }
+
+static void g_get(jit_cg *g, int hr, unsigned gr) {
+    if (g->host[gr] >= 0) x_mov_rr(g, hr, g->host[gr]);
+    else                  x_ld32(g, hr, RBX, CPU_R(gr));
+}
+static void g_put(jit_cg *g, unsigned gr, int hr) {
+    if (g->host[gr] >= 0) { x_mov_rr(g, g->host[gr], hr); g->dirty |= (uint16_t)(1u << gr); }
+    else                  x_st32(g, RBX, CPU_R(gr), hr);
+}
+static void g_writeback(jit_cg *g, uint16_t dirty) {
+    for (unsigned r = 0; r < 15; ++r)
+        if (dirty & (1u << r)) x_st32(g, RBX, CPU_R(r), g->host[r]);
+}
+static void g_reload(jit_cg *g) {
+    for (unsigned r = 0; r < 15; ++r)
+        if (g->cached & (1u << r)) x_ld32(g, g->host[r], RBX, CPU_R(r));
+}
+
+static void g_sync_flags(jit_cg *g) {
+    if (g->flags_synced) return;
+    x_cmp_m8i(g, RBX, CPU_OFF(lf_op), LF_NONE);
+    e8(g, 0x74); e8(g, 12);                     // je over the call
+    x_call(g, (const void *)jit_flags_sync);
+    g->flags_synced = true;
+}
+
+// Jump taken when cond fails (NULL for AL).
+static uint8_t *g_cond_skip(jit_cg *g, uint8_t cond) {
+    if (cond >= 0xE) return NULL;
+    g_sync_flags(g);
+    x_ld32(g, RAX, RBX, CPU_OFF(cpsr));
+    x_shift(g, SH_SHR, RAX, 28);
+    x_mov_ri(g, RCX, g_cond_pass[cond]);
+    e8(g, 0x0F); e8(g, 0xA3); e8(g, 0xC0 | (RAX << 3) | RCX);   // bt ecx, eax
+    return x_jcc(g, CC_AE);
+}
+
+static void g_exit(jit_cg *g, uint8_t *site, uint8_t kind, uint32_t pc, uint32_t end, uint32_t giveback) {
+    if (!site) return;
+    if (g->n_exits == JIT_MAX_EXITS) { g->full = true; return; }
+    g->exits[g->n_exits++] = (jit_exit){ kind, site, pc, end, giveback, g->dirty };
+}
+
+// After a memory access: leave if it moved a deadline (MMIO) or, for a
+// store, hit cached code -- the threaded loop's block-end conditions.
+static void g_check_bus(jit_cg *g, bool store, uint32_t pc, uint32_t giveback) {
+    if (store) {
+        x_ld64(g, RAX, RBP, ENV_OFF(tc_gen));
+        x_ld32(g, RAX, RAX, 0);
+        static const uint8_t cmp[] = {0x3B};
+        x_mem(g, 0, cmp, 1, RAX, RBP, ENV_OFF(gen));
+        g_exit(g, x_jcc(g, CC_NE), JX_PC, pc + 4u, pc + 4u, giveback);
+    }
+    x_ld64(g, RAX, RBP, ENV_OFF(hw_next));
+    x_ld64(g, RAX, RAX, 0);
+    static const uint8_t cmp64[] = {0x3B};
+    x_mem(g, 1, cmp64, 1, RAX, RBP, ENV_OFF(next));
+    g_exit(g, x_jcc(g, CC_NE), JX_PC, pc + 4u, pc + 4u, giveback);
+}
+
+// Leave for guest pc `to` after a full block (end = straight-line end).
+// chain: account the block on the clock and jump into to's translation
+// once jit_run() has patched it in; until then return to the caller.
+static void g_leave_to(jit_cg *g, uint32_t to, uint32_t end, bool chain) {
+    g_writeback(g, g->dirty);
+    x_mov_mi(g, RBX, CPU_R(15), to);
+    if (chain) {
+        x_ld64(g, RCX, RBP, ENV_OFF(unsynced));
+        x_mov_ri(g, RAX, end);
+        static const uint8_t sub[] = {0x2B};
+        x_mem(g, 0, sub, 1, RAX, RCX, 0);                  // sub eax, [rcx]
+        x_shift(g, SH_SHR, RAX, 2);
+        x_mov_mi(g, RCX, 0, to);
+        x_ld64(g, RDX, RBP, ENV_OFF(now));
+        static const uint8_t add[] = {0x01};
+        x_mem(g, 1, add, 1, RAX, RDX, 0);                  // add [rdx], rax
+        x_ld64(g, RAX, RBP, ENV_OFF(irq));
+        x_cmp_m8i(g, RAX, 0, 0);
+        uint8_t *irq = x_jcc(g, CC_NE);                    // sampled between blocks
+        uint8_t *site = x_jmp(g);
+        x_patch(site, g->p);                               // not chained yet
+        x_patch(irq, g->p);
+        x_mov_mi(g, RBP, ENV_OFF(end), to);
+        x_mov_ri64(g, RAX, (uint64_t)(uintptr_t)site);
+        x_st64(g, RBP, ENV_OFF(chain), RAX);
+    } else {
+        x_mov_mi(g, RBP, ENV_OFF(end), end);
+    }
+    x_patch(x_jmp(g), g->js->leave);
+}
+
+// ---------------------------------------------------------------------------
+// Flags
+// ---------------------------------------------------------------------------
+enum { C_KEEP, C_CLEAR, C_SET, C_EDX };     // logical ops: where C comes from
+
+// x86 flags of the add/sub just done -> NZCV (ARM C is NOT borrow).
+static void g_flags_arith(jit_cg *g, bool sub) {
+    x_setcc(g, CC_O, RDX);
+    e8(g, 0x9F);                                    // lahf: SF ZF . . . . . CF
+    x_movzx8(g, RAX, 4);                            // movzx eax, ah
+    x_mov_rr(g, RCX, RAX);
+    x_alu_ri(g, ALU_AND, RCX, 1u);
+    if (sub) x_alu_ri(g, ALU_XOR, RCX, 1u);
+    x_shift(g, SH_SHL, RCX, 29);
+    x_alu_ri(g, ALU_AND, RAX, 0xC0u);
+    x_shift(g, SH_SHL, RAX, 24);
+    x_rr(g, 0x09, RCX, RAX);
+    x_movzx8(g, RDX, RDX);
+    x_shift(g, SH_SHL, RDX, 28);
+    x_rr(g, 0x09, RDX, RAX);
+    x_ld32(g, RCX, RBX, CPU_OFF(cpsr));
+    x_alu_ri(g, ALU_AND, RCX, 0x0FFFFFFFu);
+    x_rr(g, 0x09, RAX, RCX);
+    x_st32(g, RBX, CPU_OFF(cpsr), RCX);
+    x_mov_m8i(g, RBX, CPU_OFF(lf_op), LF_NONE);
+    g->flags_synced = true;
+}
+
+// N, Z from res; C per cmode; V kept. Flags must be synced.
+static void g_flags_logic(jit_cg *g, int res, int cmode) {
+    uint32_t mask = CPSR_N | CPSR_Z | (cmode == C_KEEP ? 0u : CPSR_C);
+    x_rr(g, 0x85, res, res);                        // test
+    e8(g, 0x9F);
+    x_movzx8(g, RAX, 4);
+    x_alu_ri(g, ALU_AND, RAX, 0xC0u);
+    x_shift(g, SH_SHL, RAX, 24);
+    if (cmode == C_SET) x_alu_ri(g, ALU_OR, RAX, CPSR_C);
+    if (cmode == C_EDX) { x_shift(g, SH_SHL, RDX, 29); x_rr(g, 0x09, RDX, RAX); }
+    x_ld32(g, RCX, RBX, CPU_OFF(cpsr));
+    x_alu_ri(g, ALU_AND, RCX, ~mask);
+    x_rr(g, 0x09, RAX, RCX);
+    x_st32(g, RBX, CPU_OFF(cpsr), RCX);
+}
+
+// ---------------------------------------------------------------------------
+// Ops
+// ---------------------------------------------------------------------------
+enum { JK_CALL, JK_DP, JK_MOVW, JK_MOVT, JK_MEM, JK_B, JK_BL };
+enum {
+    DP_AND, DP_EOR, DP_SUB, DP_RSB, DP_ADD, DP_ADC, DP_SBC, DP_RSC,
+    DP_TST, DP_TEQ, DP_CMP, DP_CMN, DP_ORR, DP_MOV, DP_BIC, DP_MVN
+};
+
+static bool dp_is_logic(int opc) {
+    return opc == DP_AND || opc == DP_EOR || opc == DP_TST || opc == DP_TEQ ||
+           opc == DP_ORR || opc == DP_MOV || opc == DP_BIC || opc == DP_MVN;
+}
+
+static int jit_kind(const k12_op *op) {
+    const uint32_t in = op->instr;
+    if (op->kind == K12_OP_B) return JK_B;
+    if (op->cond == 0xF) return JK_CALL;
+    if (op->fn == handle_bl) return JK_BL;
+    if (op->fn == handle_movw || op->fn == handle_movt) {
+        if (op->rd == 15) return JK_CALL;
+        return op->fn == handle_movw ? JK_MOVW : JK_MOVT;
+    }
+    // DP words dp_variant() accepts have no PC operand and Rd != PC.
+    if (op->fn && op->fn == dp_variant(in)) {
+        int opc = (int)((in >> 21) & 0xFu);
+        if ((in & (1u << 20)) && (opc == DP_ADC || opc == DP_SBC || opc == DP_RSC))
+            return JK_CALL;                         // carry-in folded into lazy V
+        if (!(in & (1u << 25))) {
+            if (in & 0x10u) return JK_CALL;         // shift by register
+            if (!(in & 0xF80u) && ((in >> 5) & 3u)) return JK_CALL;   // LSR/ASR #32, RRX
+        }
+        return JK_DP;
+    }
+    if (op->rd == 15) return JK_CALL;
+    if (op->fn == handle_ldr_literal) return JK_MEM;
+    if (op->rn == 15) return JK_CALL;
+    if (op->fn == handle_ldr_preimm  || op->fn == handle_ldr_postimm  ||
+        op->fn == handle_ldrb_preimm || op->fn == handle_ldrb_postimm ||
+        op->fn == handle_str_preimm  || op->fn == handle_str_postimm  ||
+        op->fn == handle_str_predec  || op->fn == handle_strb_preimm  ||
+        op->fn == handle_strb_postimm)
+        return JK_MEM;
+    return JK_CALL;
+}
+
+static inline uint8_t op_cond(const k12_op *op) {
+    return op->kind == K12_OP_COND ? op->cond : 0xEu;
+}
+
+static void emit_dp(jit_cg *g, const k12_op *op) {
+    const uint32_t in  = op->instr;
+    const int      opc = (int)((in >> 21) & 0xFu);
+    // TST/TEQ/CMP/CMN set flags with S clear too (as dp_exec() does).
+    const bool     S   = ((in >> 20) & 1u) || (opc >= DP_TST && opc <= DP_CMN);
+    const bool     logic = dp_is_logic(opc);
+    int cmode = C_KEEP;
+
+    if ((S && logic) || opc == DP_ADC || opc == DP_SBC || opc == DP_RSC) g_sync_flags(g);
+    uint8_t *skip = g_cond_skip(g, op_cond(op));
+
+    // Operand2 -> ecx (shifter carry -> edx when a logical S op needs it)
+    if (in & (1u << 25)) {
+        uint32_t rot = ((in >> 8) & 0xFu) * 2u, v = in & 0xFFu;
+        if (rot) { v = (v >> rot) | (v << (32u - rot)); cmode = (v >> 31) ? C_SET : C_CLEAR; }
+        x_mov_ri(g, RCX, v);
+    } else {
+        static const int SH[4] = { SH_SHL, SH_SHR, SH_SAR, SH_ROR };
+        const unsigned type = (in >> 5) & 3u, n = (in >> 7) & 0x1Fu;
+        g_get(g, RCX, in & 0xFu);
+        if (n) {
+            if (S && logic) {
+                x_mov_rr(g, RDX, RCX);
+                x_shift(g, SH_SHR, RDX, (uint8_t)(type == 0 ? 32u - n : n - 1u));
+                x_alu_ri(g, ALU_AND, RDX, 1u);
+                cmode = C_EDX;
+            }
+            x_shift(g, SH[type], RCX, (uint8_t)n);
+        }
+    }
+    if (opc != DP_MOV && opc != DP_MVN) g_get(g, RAX, op->rn);
+
+    int  res = RAX;
+    bool arith = false, sub = false;
+    switch (opc) {
+    case DP_AND: case DP_TST: x_rr(g, 0x21, RCX, RAX); break;
+    case DP_EOR: case DP_TEQ: x_rr(g, 0x31, RCX, RAX); break;
+    case DP_ORR:              x_rr(g, 0x09, RCX, RAX); break;
+    case DP_BIC: x_not(g, RCX); x_rr(g, 0x21, RCX, RAX); break;
+    case DP_MOV: res = RCX; break;
+    case DP_MVN: x_not(g, RCX); res = RCX; break;
+    case DP_SUB: x_rr(g, 0x29, RCX, RAX); arith = sub = true; break;
+    case DP_CMP: x_rr(g, 0x39, RCX, RAX); arith = sub = true; break;
+    case DP_RSB: x_rr(g, 0x29, RAX, RCX); res = RCX; arith = sub = true; break;
+    case DP_ADD: case DP_CMN: x_rr(g, 0x01, RCX, RAX); arith = true; break;
+    case DP_ADC:
+        x_bt_mi(g, RBX, CPU_OFF(cpsr), 29);
+        x_rr(g, 0x11, RCX, RAX);
+        break;
+    case DP_SBC:                                    // x86 borrow = NOT C
+        x_bt_mi(g, RBX, CPU_OFF(cpsr), 29); e8(g, 0xF5);
+        x_rr(g, 0x19, RCX, RAX);
+        break;
+    default:                                        // DP_RSC
+        x_bt_mi(g, RBX, CPU_OFF(cpsr), 29); e8(g, 0xF5);
+        x_rr(g, 0x19, RAX, RCX); res = RCX;
+        break;
+    }
+    if (opc < DP_TST || opc > DP_CMN) g_put(g, op->rd, res);   // mov keeps the flags
+    if (S) {
+        if (arith) g_flags_arith(g, sub);
+        else       g_flags_logic(g, res, cmode);
+    }
+    x_patch(skip, g->p);
+}
+
+static void emit_movwt(jit_cg *g, const k12_op *op, bool top) {
+    const uint32_t imm16 = ((op->instr >> 4) & 0xF000u) | (op->instr & 0xFFFu);
+    uint8_t *skip = g_cond_skip(g, op->cond);       // the handlers test cond themselves
+    if (top) {
+        g_get(g, RAX, op->rd);
+        x_alu_ri(g, ALU_AND, RAX, 0xFFFFu);
+        x_alu_ri(g, ALU_OR, RAX, imm16 << 16);
+    } else {
+        x_mov_ri(g, RAX, imm16);
+    }
+    g_put(g, op->rd, RAX);
+    x_patch(skip, g->p);
+}
+
+// Immediate-offset LDR/STR(B): the matching memops.c handler, step for step
+// (including which forms write the base back).
+static void emit_mem(jit_cg *g, const k12_op *op, uint32_t pc, uint32_t giveback) {
+    const uint32_t in = op->instr, imm = in & 0xFFFu;
+    const bool     U  = (in >> 23) & 1u, W = (in >> 21) & 1u;
+    const unsigned rn = op->rn, rd = op->rd;
+    const insn_handler_t fn = op->fn;
+    const int      step = U ? ALU_ADD : ALU_SUB;
+    bool store = false;
+
+    uint8_t *skip = g_cond_skip(g, op_cond(op));
+    x_mov_mi(g, RBX, CPU_R(15), pc);                // cpu_sync_clock() on MMIO
+
+    if (fn == handle_ldr_literal) {
+        uint32_t base = (pc & ~3u) + 8u;
+        x_mov_ri(g, ARG0, U ? base + imm : base - imm);
+        x_call(g, (const void *)mem_read32);
+        g_put(g, rd, RAX);
+    } else if (fn == handle_ldr_preimm) {
+        g_get(g, ARG0, rn); x_alu_ri(g, step, ARG0, imm);
+        x_call(g, (const void *)mem_read32);
+        g_put(g, rd, RAX);
+    } else if (fn == handle_ldr_postimm) {
+        g_get(g, ARG0, rn); x_mov_rr(g, RAX, ARG0); x_alu_ri(g, step, RAX, imm);
+        g_put(g, rn, RAX);
+        x_call(g, (const void *)mem_read32);
+        if (rd != rn) g_put(g, rd, RAX);
+    } else if (fn == handle_ldrb_preimm) {
+        g_get(g, ARG0, rn); x_alu_ri(g, step, ARG0, imm);
+        if (W) g_put(g, rn, ARG0);
+        x_call(g, (const void *)mem_read8);
+        x_movzx8(g, RAX, RAX);
+        if (!(W && rd == rn)) g_put(g, rd, RAX);
+    } else if (fn == handle_ldrb_postimm) {
+        g_get(g, ARG0, rn); x_mov_rr(g, RAX, ARG0); x_alu_ri(g, ALU_ADD, RAX, imm);
+        g_put(g, rn, RAX);
+        x_call(g, (const void *)mem_read8);
+        x_movzx8(g, RAX, RAX);
+        if (rd != rn) g_put(g, rd, RAX);
+    } else {
+        store = true;
+        const bool byte = fn == handle_strb_preimm || fn == handle_strb_postimm;
+        g_get(g, ARG1, rd);
+        if (byte) x_alu_ri(g, ALU_AND, ARG1, 0xFFu);
+        g_get(g, ARG0, rn);
+        if (fn == handle_str_preimm) {
+            x_alu_ri(g, step, ARG0, imm);
+            if (W) g_put(g, rn, ARG0);
+        } else if (fn == handle_strb_preimm) {
+            x_alu_ri(g, step, ARG0, imm);
+        } else if (fn == handle_str_predec) {
+            x_alu_ri(g, ALU_SUB, ARG0, imm);
+            g_put(g, rn, ARG0);
+        } else {                                    // STR/STRB post-imm: always up
+            x_mov_rr(g, RAX, ARG0); x_alu_ri(g, ALU_ADD, RAX, imm);
+            g_put(g, rn, RAX);
+        }
+        x_call(g, byte ? (const void *)mem_write8 : (const void *)mem_write32);
+    }
+    g_check_bus(g, store, pc, giveback);
+    x_patch(skip, g->p);
+}
+
+// Anything else: the K12 handler, with the threaded loop's per-op checks.
+static void emit_call(jit_cg *g, const k12_op *op, uint32_t pc, uint32_t giveback) {
+    g_writeback(g, g->dirty);
+    g->dirty = 0;
+    uint8_t *skip = g_cond_skip(g, op_cond(op));
+    x_mov_mi(g, RBX, CPU_R(15), pc);
+    x_mov_mi(g, RBX, CPU_OFF(npc), pc + 4u);
+    x_mov_ri(g, ARG0, op->instr);
+    x_call(g, (const void *)op->fn);
+    g_reload(g);
+    g->flags_synced = false;
+    x_cmp_m8i(g, RBX, CPU_OFF(halted), 0);
+    g_exit(g, x_jcc(g, CC_NE), JX_HALT, 0, pc + 4u, giveback);
+    x_alu_mi(g, ALU_CMP, RBX, CPU_OFF(npc), pc + 4u);
+    g_exit(g, x_jcc(g, CC_NE), JX_NPC, 0, pc + 4u, giveback);
+    g_check_bus(g, true, pc, giveback);
+    x_patch(skip, g->p);
+}
+
+// ---------------------------------------------------------------------------
+// Blocks
+// ---------------------------------------------------------------------------
+static void pick_cached(jit_cg *g, const tc_block *b) {
+    static const int HOST[JIT_CACHED] = { R12, R13, R14, R15 };
+    unsigned use[16] = {0};
+    for (unsigned i = 0; i < b->n_ops; ++i) {
+        const k12_op *op = &b->ops[i];
+        switch (jit_kind(op)) {
+        case JK_DP:
+            use[op->rn]++; use[op->rd]++;
+            if (!(op->instr & (1u << 25))) use[op->rm]++;
+            break;
+        case JK_MEM:  use[op->rn]++; use[op->rd]++; break;
+        case JK_MOVW: case JK_MOVT: use[op->rd]++; break;
+        case JK_BL:   use[14]++; break;
+        default: break;
+        }
+    }
+    memset(g->host, -1, sizeof g->host);
+    g->cached = 0;
+    for (int h = 0; h < JIT_CACHED; ++h) {
+        unsigned best = 15;
+        for (unsigned r = 0; r < 15; ++r)
+            if (!(g->cached & (1u << r)) && use[r] >= 2 && (best == 15 || use[r] > use[best])) best = r;
+        if (best == 15) break;
+        g->host[best] = (int8_t)HOST[h];
+        g->cached |= (uint16_t)(1u << best);
+    }
+}
+
+static void jit_discard(jit_state *js) {
+    js->used = js->base;
+    js->epoch++;
+}
+
+static bool jit_translate(jit_state *js, tc_block *b) {
+    if (JIT_CODE_SIZE - js->used < JIT_BLOCK_MAX) jit_discard(js);
+
+    static VM_TLS jit_cg cg;
+    jit_cg *g = &cg;
+    const uint32_t n = b->n_ops, start = b->start;
+    g->js = js;
+    g->p = js->code + js->used;
+    g->lim = js->code + js->used + JIT_BLOCK_MAX;
+    g->full = false;
+    g->dirty = 0;
+    g->flags_synced = false;
+    g->n_exits = 0;
+    pick_cached(g, b);
+
+    // A short loop over its own start made of reads_only ops goes back to
+    // the threaded loop every iteration, where idle polling is recognized.
+    bool idle = n <= CPU_IDLE_MAX_OPS;
+    for (uint32_t i = 0; idle && i < n; ++i) idle = b->ops[i].reads_only;
+
+    uint8_t *entry = g->p;
+    x_alu_mi(g, ALU_SUB, RBP, ENV_OFF(budget), n);
+    uint8_t *no_room = x_jcc(g, CC_B);
+    g_reload(g);
+
+    bool t_clear = true, ended = false;
+    for (uint32_t i = 0; i < n && !ended; ++i) {
+        const k12_op *op = &b->ops[i];
+        const uint32_t pc = start + 4u * i, give = n - 1u - i;
+        if (t_clear) { x_alu_mi(g, ALU_AND, RBX, CPU_OFF(cpsr), ~CPSR_T); t_clear = false; }
+
+        const int kind = jit_kind(op);
+        if (kind == JK_B || kind == JK_BL) {
+            const uint32_t to = pc + (kind == JK_B ? (uint32_t)op->imm
+                                                   : 8u + (uint32_t)(((int32_t)(op->instr << 8)) >> 6));
+            uint8_t *skip = g_cond_skip(g, op->cond);
+            const uint16_t dirty = g->dirty;
+            if (kind == JK_BL) { x_mov_ri(g, RAX, pc + 4u); g_put(g, 14, RAX); }
+            g_leave_to(g, to, pc + 4u, !(idle && to == start));
+            if (skip) {
+                x_patch(skip, g->p);
+                g->dirty = dirty;
+                g_leave_to(g, pc + 4u, pc + 4u, true);
+            }
+            ended = true;
+            break;
+        }
+
+        switch (kind) {
+        case JK_DP:   emit_dp(g, op); break;
+        case JK_MOVW: emit_movwt(g, op, false); break;
+        case JK_MOVT: emit_movwt(g, op, true); break;
+        case JK_MEM:  emit_mem(g, op, pc, give); break;
+        default:      emit_call(g, op, pc, give); t_clear = true; break;
+        }
+    }
+    if (!ended) g_leave_to(g, start + 4u * n, start + 4u * n, true);
+
+    for (unsigned i = 0; i < g->n_exits; ++i) {
+        const jit_exit *x = &g->exits[i];
+        x_patch(x->site, g->p);
+        g_writeback(g, x->dirty);
+        if (x->kind == JX_PC) {
+            x_mov_mi(g, RBX, CPU_R(15), x->pc);
+        } else if (x->kind == JX_NPC) {
+            x_ld32(g, RAX, RBX, CPU_OFF(npc));
+            x_st32(g, RBX, CPU_R(15), RAX);
+        }
+        if (x->giveback) x_alu_mi(g, ALU_ADD, RBP, ENV_OFF(budget), x->giveback);
+        x_mov_mi(g, RBP, ENV_OFF(end), x->end);
+        x_patch(x_jmp(g), js->leave);
+    }
+    x_patch(no_room, g->p);
+    x_alu_mi(g, ALU_ADD, RBP, ENV_OFF(budget), n);
+    x_mov_mi(g, RBP, ENV_OFF(end), start);
+    x_patch(x_jmp(g), js->leave);
+
+    if (g->full) return false;
+    js->used = (size_t)(g->p - js->code);
+    b->jit       = entry;
+    b->jit_ops   = (uint16_t)n;
+    b->jit_epoch = js->epoch;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// State, entry
+// ---------------------------------------------------------------------------
+static void *jit_alloc_exec(size_t size) {
+#if JIT_VIRTUALALLOC
+    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : p;
+#endif
+}
+
+static void jit_free_exec(void *p, size_t size) {
+#if JIT_VIRTUALALLOC
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+
+// enter(env, entry): save callee-saved registers, 16-byte align the stack
+// (with MS x64 shadow space), point rbp/rbx at env/cpu, jump to the block.
+static void jit_emit_stubs(jit_state *js) {
+    static const int SAVED[] = { RBX, RBP, R12, R13, R14, R15, RSI, RDI };
+    jit_cg g0 = { .js = js, .p = js->code, .lim = js->code + 256 };
+    jit_cg *g = &g0;
+    for (unsigned i = 0; i < 8; ++i) { rex(g, 0, 0, SAVED[i]); e8(g, 0x50 + (SAVED[i] & 7)); }
+    e8(g, 0x48); e8(g, 0x83); e8(g, 0xEC); e8(g, 40);         // sub rsp, 40
+    rex(g, 1, ARG0, RBP); e8(g, 0x89); e8(g, 0xC0 | ((ARG0 & 7) << 3) | RBP);
+    x_ld64(g, RBX, RBP, ENV_OFF(cpu));
+    e8(g, 0xFF); e8(g, 0xE0 | (ARG1 & 7));                     // jmp ARG1
+    js->leave = g->p;
+    e8(g, 0x48); e8(g, 0x83); e8(g, 0xC4); e8(g, 40);         // add rsp, 40
+    for (int i = 7; i >= 0; --i) { rex(g, 0, 0, SAVED[i]); e8(g, 0x58 + (SAVED[i] & 7)); }
+    e8(g, 0xC3);
+    js->base = js->used = (size_t)(g->p - js->code);
+    void *enter = js->code;
+    memcpy(&js->enter, &enter, sizeof enter);
+}
+
+static jit_state *jit_create(void) {
+    jit_state *js = (jit_state *)calloc(1, sizeof *js);
+    if (!js) return NULL;
+    js->code  = (uint8_t *)jit_alloc_exec(JIT_CODE_SIZE);   // NULL: interpreter only
+    js->epoch = 1;
+    js->gen   = g_tc->gen;
+    if (js->code) jit_emit_stubs(js);
+    return js;
+}
+
+void jit_state_free(jit_state *js) {
+    if (!js) return;
+    if (js->code) jit_free_exec(js->code, JIT_CODE_SIZE);
+    free(js);
+}
+
+uint32_t jit_run(tc_block *b, uint32_t budget, uint32_t *unsynced, uint32_t *end) {
+    jit_state *js = g_tc->jit;
+    if (!js && !(js = g_tc->jit = jit_create())) return 0;
+    if (!js->code) return 0;
+    if (js->gen != g_tc->gen) {
+        js->gen = g_tc->gen;
+        jit_discard(js);
+    }
+
+    if (!b->jit || b->jit_epoch != js->epoch || b->jit_ops != b->n_ops) {
+        if (++b->hits >= JIT_HOT) {
+            b->hits = 0;
+            jit_translate(js, b);
+        }
+        if (!b->jit || b->jit_epoch != js->epoch) return 0;
+    }
+    if (b->jit_ops > budget) return 0;
+
+    jit_env env = {
+        .cpu = &cpu, .now = &g_hw->now, .unsynced = unsynced,
+        .tc_gen = &g_tc->gen, .hw_next = &g_hw->next, .irq = &g_hw->irq,
+        .next = g_hw->next, .gen = g_tc->gen,
+        .budget = budget, .end = b->start, .chain = NULL,
+    };
+    js->enter(&env, b->jit);
+
+    // Left through a direct branch into a block that was not translated
+    // then: if it is now, jump there directly from now on.
+    if (env.chain) {
+        const tc_block *t = tcache_block_at(cpu.r[15]);
+        if (t && t->jit && t->jit_epoch == js->epoch) x_patch(env.chain, (const uint8_t *)t->jit);
+    }
+    *end = env.end;
+    return budget - env.budget;
+}
+
+#else   // !CPU_JIT
+
+void jit_state_free(jit_state *js) { (void)js; }
+
+#endif
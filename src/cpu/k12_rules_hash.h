@@ -0,0 +1,21 @@
+// src/cpu/k12_rules_hash.h — compile-time fingerprint of k12_rules.def
+// With K12_RULE defined as K12_RULE_HASH, including k12_rules.def inside
+// "(0ull ... )" sums one term per rule into a constant expression: its
+// mask/value words, cond flag, line in the .def and the lengths of its
+// handler and name spellings (their characters are not constant
+// expressions in C). k12gen writes the value it was built with into
+// k12_dispatch.inc as K12_GEN_RULES_HASH and execute.c asserts on it, so
+// any edit to the rules list fails the build until k12gen is rerun.
+#ifndef K12_RULES_HASH_H
+#define K12_RULES_HASH_H
+
+#define K12_HASH_MIX(x) (((x) ^ ((x) >> 31)) * 0x9E3779B97F4A7C15ull)
+
+#define K12_RULE_HASH(m12, v12, xm, xv, cc, fn, name)                              \
+    + K12_HASH_MIX(K12_HASH_MIX(((unsigned long long)(m12) << 48 |                 \
+                                 (unsigned long long)(v12) << 32 | (xm)) ^         \
+                                (unsigned long long)__LINE__ * 0xBF58476D1CE4E5B9ull) + \
+                   ((unsigned long long)(xv) << 32 | (unsigned long long)!!(cc) << 24 | \
+                    (unsigned long long)sizeof(#fn) << 12 | sizeof(name)))
+
+#endif
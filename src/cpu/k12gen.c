@@ -0,0 +1,150 @@
+// src/cpu/k12gen.c — build-time generator for the key12 dispatch table
+// Host tool, not part of the emulator: expands k12_rules.def, sorts each of
+// the 4096 key12 buckets' candidates by priority (the algorithm execute.c
+// used to run on first decode), and writes k12_dispatch.inc.
+//
+//   k12gen <out.inc>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "k12_rules_hash.h"
+
+#define KEY12_SPACE 4096
+#define MAX_PER_KEY 16
+
+typedef struct {
+    uint16_t    mask12, value12;
+    uint32_t    xmask32, xvalue32;
+    bool        check_cond;
+    const char *fn;             // handler identifier, emitted as-is
+    const char *name;
+} gen_rule;
+
+static const gen_rule RULES[] = {
+#define K12_RULE(m12, v12, xm, xv, cc, fn, name) { m12, v12, xm, xv, cc, #fn, name },
+#include "k12_rules.def"
+#undef K12_RULE
+};
+#define NRULES (sizeof(RULES) / sizeof(RULES[0]))
+
+// Fingerprint of the same list, folded at compile time; execute.c asserts
+// its own fold against the copy written into the .inc.
+static const unsigned long long RULES_HASH = 0ull
+#define K12_RULE K12_RULE_HASH
+#include "k12_rules.def"
+#undef K12_RULE
+    ;
+
+static uint16_t g_list[KEY12_SPACE][MAX_PER_KEY];
+static uint8_t  g_prio[KEY12_SPACE][MAX_PER_KEY];
+static uint8_t  g_count[KEY12_SPACE];
+static uint8_t  g_drop[KEY12_SPACE];
+
+static unsigned popcount(uint32_t x) {
+    unsigned n = 0;
+    for (; x; x &= x - 1u) n++;
+    return n;
+}
+
+// Priority = specificity of mask12 + specificity of xmask32.
+static uint8_t priority(const gen_rule *r) {
+    return (uint8_t)(popcount(r->mask12) + popcount(r->xmask32));
+}
+
+// Per-key lists sorted by priority (desc), stable on ties; a full list only
+// takes a rule more specific than its last entry.
+static void build(void) {
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        uint8_t cnt = 0;
+        for (uint16_t ri = 0; ri < NRULES; ++ri) {
+            const gen_rule *r = &RULES[ri];
+            if (((uint16_t)k & r->mask12) != r->value12) continue;
+            uint8_t pr = priority(r);
+            uint8_t pos;
+            if (cnt < MAX_PER_KEY) {
+                pos = cnt++;
+            } else {
+                if (g_drop[k] < UINT8_MAX) g_drop[k]++;
+                if (pr <= g_prio[k][cnt - 1]) continue;
+                pos = cnt - 1;
+            }
+            while (pos > 0 && pr > g_prio[k][pos - 1]) {
+                g_prio[k][pos] = g_prio[k][pos - 1];
+                g_list[k][pos] = g_list[k][pos - 1];
+                --pos;
+            }
+            g_prio[k][pos] = pr;
+            g_list[k][pos] = ri;
+        }
+        g_count[k] = cnt;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: k12gen <out.inc>\n");
+        return 2;
+    }
+    build();
+
+    FILE *f = fopen(argv[1], "w");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    unsigned used = 0, single = 0, longest = 0, ncands = 0, truncated = 0;
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        used      += g_count[k] != 0;
+        single    += g_count[k] == 1;
+        truncated += g_drop[k] != 0;
+        ncands    += g_count[k];
+        if (g_count[k] > longest) longest = g_count[k];
+    }
+
+    fprintf(f, "// src/cpu/k12_dispatch.inc — generated by k12gen from k12_rules.def; do not edit.\n");
+    fprintf(f, "// %u rules, %u/%d buckets used, %u with a single candidate, longest list %u,\n",
+            (unsigned)NRULES, used, KEY12_SPACE, single, longest);
+    fprintf(f, "// %u truncated at MAX_PER_KEY=%d.\n\n", truncated, MAX_PER_KEY);
+    fprintf(f, "#define K12_GEN_RULES %u\n", (unsigned)NRULES);
+    fprintf(f, "#define K12_GEN_RULES_HASH 0x%016llXull\n\n", RULES_HASH);
+
+    // Candidate rule indices, bucket after bucket, highest priority first.
+    fprintf(f, "static const uint16_t K12_CANDS[%u] = {\n", ncands ? ncands : 1u);
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        if (!g_count[k]) continue;
+        fprintf(f, "    /* 0x%03X */", k);
+        for (unsigned i = 0; i < g_count[k]; ++i) fprintf(f, " %u,", g_list[k][i]);
+        fprintf(f, "\n");
+    }
+    if (!ncands) fprintf(f, "    0\n");
+    fprintf(f, "};\n\n");
+
+    // { fn, xmask32, xvalue32, first, count, dropped, check_cond }
+    // fn/xmask32/xvalue32/check_cond are filled only for one-candidate buckets.
+    fprintf(f, "static const k12_bucket K12_BUCKETS[KEY12_SPACE] = {\n");
+    unsigned first = 0;
+    for (int k = 0; k < KEY12_SPACE; ++k) {
+        if (!g_count[k]) continue;
+        if (g_count[k] == 1) {
+            const gen_rule *r = &RULES[g_list[k][0]];
+            fprintf(f, "    [0x%03X] = { %s, 0x%08Xu, 0x%08Xu, %u, 1, %u, %s },\n",
+                    k, r->fn, r->xmask32, r->xvalue32, first, g_drop[k],
+                    r->check_cond ? "true" : "false");
+        } else {
+            fprintf(f, "    [0x%03X] = { NULL, 0, 0, %u, %u, %u, false },\n",
+                    k, first, g_count[k], g_drop[k]);
+        }
+        first += g_count[k];
+    }
+    fprintf(f, "};\n");
+
+    if (fclose(f) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -30,7 +30,7 @@ void handle_orr(uint32_t instr) {
     }
 
     cpu.r[Rd] = res;
-    if (S) { cpsr_set_NZ(res); cpsr_set_C_from(sh_carry & 1u); }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // ------------------------------- BIC -------------------------------
@@ -54,7 +54,7 @@ void handle_bic(uint32_t instr) {
     }
 
     cpu.r[Rd] = res;
-    if (S) { cpsr_set_NZ(res); cpsr_set_C_from(sh_carry & 1u); }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // ------------------------------- AND imm/reg fast paths -------------------------------
@@ -78,7 +78,7 @@ void handle_and_imm_dp(uint32_t instr) {
     }
 
     cpu.r[Rd] = res;
-    if (S) { cpsr_set_NZ(res); cpsr_set_C_from(sh_carry & 1u); }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 void handle_and_reg_simple(uint32_t instr) {
@@ -97,8 +97,7 @@ void handle_tst_imm(uint32_t instr) {
     uint32_t op2 = dp_operand2(instr, &sh_carry);
     uint32_t res = arm_read_src_reg(Rn) & op2;
 
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(sh_carry & 1u);
+    cpsr_flags_logic(res, sh_carry);
 }
 
 void handle_tst_reg(uint32_t instr) {
@@ -118,10 +117,7 @@ void handle_cmp_reg(uint32_t instr) {
     uint32_t a   = arm_read_src_reg(Rn);
 
     uint32_t res = a - op2;
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(a >= op2); // NOT borrow
-    int overflow = ((a ^ op2) & (a ^ res) & 0x80000000u) != 0;
-    cpsr_set_V(overflow);
+    cpsr_flags_sub(a, op2, res, a >= op2);   // C = NOT borrow
 }
 
 void handle_cmp_imm(uint32_t instr) {
@@ -147,7 +143,7 @@ void handle_mov(uint32_t instr) {
     }
 
     cpu.r[Rd] = res;
-    if (S) { cpsr_set_NZ(res); cpsr_set_C_from(sh_carry & 1u); }
+    if (S) cpsr_flags_logic(res, sh_carry);
 }
 
 // ------------------------------- RSB (imm fast path) -------------------------------
@@ -173,12 +169,7 @@ void handle_rsb_imm(uint32_t instr) {
     }
 
     cpu.r[Rd] = res;
-    if (S) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(op2 >= a); // NOT borrow
-        int overflow = ((op2 ^ a) & (op2 ^ res) & 0x80000000u) != 0;
-        cpsr_set_V(overflow);
-    }
+    if (S) cpsr_flags_sub(op2, a, res, op2 >= a);   // C = NOT borrow
 }
 
 // ------------------------------- CMN (imm fast path) -------------------------------
@@ -194,10 +185,7 @@ void handle_cmn_imm(uint32_t instr) {
     uint32_t a   = arm_read_src_reg(Rn);
 
     uint32_t res = a + op2;
-    cpsr_set_NZ(res);
-    cpsr_set_C_from(res < a); // carry out
-    int overflow = (~(a ^ op2) & (a ^ res) & 0x80000000u) != 0;
-    cpsr_set_V(overflow);
+    cpsr_flags_add(a, op2, res, res < a);   // C = carry out
 }
 
 // ------------------------------- MOVW / MOVT / MOV(imm fast path) -------------------------------
@@ -306,15 +294,149 @@ void handle_sxth(uint32_t instr) {
     cpu.r[Rd] = (uint32_t)(int32_t)(int16_t)(cpu.r[Rm] & 0xFFFFu);
 }
 
+void handle_rbit(uint32_t instr) {
+    uint32_t Rd = (instr >> 12) & 0xFu;
+    uint32_t Rm =  instr        & 0xFu;
+    IGNORE_IF_PC(Rd);
+    uint32_t x = cpu.r[Rm];
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    cpu.r[Rd] = (x >> 16) | (x << 16);
+}
+
+// ---------------- Extend with rotate / accumulate ----------------
+// {S,U}XT{A}{B,H,B16} Rd, {Rn,} Rm, ROR #rot  — bits 22:20 pick the form,
+// Rn==PC is the non-accumulating one.
+void handle_extend(uint32_t instr) {
+    uint32_t Rn  = (instr >> 16) & 0xFu;
+    uint32_t Rd  = (instr >> 12) & 0xFu;
+    uint32_t Rm  =  instr        & 0xFu;
+    uint32_t rot = ((instr >> 10) & 3u) * 8u;
+    IGNORE_IF_PC(Rd);
+
+    uint32_t x   = cpu.r[Rm];
+    uint32_t v   = rot ? (x >> rot) | (x << (32u - rot)) : x;
+    uint32_t acc = (Rn == 15u) ? 0u : cpu.r[Rn];
+    uint32_t lo, hi;
+    switch ((instr >> 20) & 7u) {
+        case 0u:    // SXTB16 / SXTAB16
+            lo = (uint32_t)(int32_t)(int8_t)v;
+            hi = (uint32_t)(int32_t)(int8_t)(v >> 16);
+            break;
+        case 4u:    // UXTB16 / UXTAB16
+            lo = v & 0xFFu;
+            hi = (v >> 16) & 0xFFu;
+            break;
+        case 2u: cpu.r[Rd] = acc + (uint32_t)(int32_t)(int8_t)v;  return;   // SXTB / SXTAB
+        case 3u: cpu.r[Rd] = acc + (uint32_t)(int32_t)(int16_t)v; return;   // SXTH / SXTAH
+        case 6u: cpu.r[Rd] = acc + (v & 0xFFu);                   return;   // UXTB / UXTAB
+        case 7u: cpu.r[Rd] = acc + (v & 0xFFFFu);                 return;   // UXTH / UXTAH
+        default: return;
+    }
+    lo = (acc + lo) & 0xFFFFu;
+    hi = ((acc >> 16) + hi) & 0xFFFFu;
+    cpu.r[Rd] = lo | (hi << 16);
+}
+
+// ---------------- Packing ----------------
+// PKHBT Rd,Rn,Rm,LSL #imm / PKHTB Rd,Rn,Rm,ASR #imm (imm 0 means 32)
+void handle_pkh(uint32_t instr) {
+    uint32_t Rn  = (instr >> 16) & 0xFu;
+    uint32_t Rd  = (instr >> 12) & 0xFu;
+    uint32_t Rm  =  instr        & 0xFu;
+    uint32_t imm = (instr >> 7)  & 0x1Fu;
+    IGNORE_IF_PC(Rd);
+
+    uint32_t n = cpu.r[Rn], m = cpu.r[Rm];
+    if (instr & (1u << 6)) {             // TB
+        uint32_t sh = (uint32_t)((int32_t)m >> (imm ? imm : 31u));
+        cpu.r[Rd] = (n & 0xFFFF0000u) | (sh & 0xFFFFu);
+    } else {                             // BT
+        cpu.r[Rd] = (n & 0xFFFFu) | ((m << imm) & 0xFFFF0000u);
+    }
+}
+
+// ---------------- Saturation ----------------
+// Clamp v to a signed/unsigned bits-wide range; sets *sat when it clamps.
+static inline int64_t sat_signed(int64_t v, uint32_t bits, bool *sat) {
+    int64_t max = ((int64_t)1 << (bits - 1u)) - 1, min = -max - 1;
+    if (v > max) { *sat = true; return max; }
+    if (v < min) { *sat = true; return min; }
+    return v;
+}
+
+static inline int64_t sat_unsigned(int64_t v, uint32_t bits, bool *sat) {
+    int64_t max = ((int64_t)1 << bits) - 1;
+    if (v > max) { *sat = true; return max; }
+    if (v < 0)   { *sat = true; return 0; }
+    return v;
+}
+
+// Q is sticky and outside the lazily-tracked NZCV bits.
+static inline void set_q_if(bool sat) {
+    if (sat) cpu.cpsr |= CPSR_Q;
+}
+
+// SSAT/USAT Rd, #sat, Rn{, LSL/ASR #imm}
+void handle_ssat(uint32_t instr) {
+    uint32_t Rd  = (instr >> 12) & 0xFu;
+    uint32_t Rn  =  instr        & 0xFu;
+    uint32_t imm = (instr >> 7)  & 0x1Fu;
+    uint32_t sat_imm = (instr >> 16) & 0x1Fu;
+    bool unsig = (instr >> 22) & 1u;
+    IGNORE_IF_PC(Rd);
+
+    int32_t x = (int32_t)cpu.r[Rn];
+    int32_t v = (instr & (1u << 6)) ? x >> (imm ? imm : 31u)
+                                    : (int32_t)((uint32_t)x << imm);
+    bool sat = false;
+    int64_t r = unsig ? sat_unsigned(v, sat_imm, &sat)
+                      : sat_signed(v, sat_imm + 1u, &sat);
+    cpu.r[Rd] = (uint32_t)r;
+    set_q_if(sat);
+}
+
+// SSAT16/USAT16 Rd, #sat, Rn — each halfword on its own
+void handle_ssat16(uint32_t instr) {
+    uint32_t Rd  = (instr >> 12) & 0xFu;
+    uint32_t Rn  =  instr        & 0xFu;
+    uint32_t sat_imm = (instr >> 16) & 0xFu;
+    bool unsig = (instr >> 22) & 1u;
+    IGNORE_IF_PC(Rd);
+
+    uint32_t x = cpu.r[Rn];
+    bool sat = false;
+    int64_t lo = (int16_t)x, hi = (int16_t)(x >> 16);
+    lo = unsig ? sat_unsigned(lo, sat_imm, &sat) : sat_signed(lo, sat_imm + 1u, &sat);
+    hi = unsig ? sat_unsigned(hi, sat_imm, &sat) : sat_signed(hi, sat_imm + 1u, &sat);
+    cpu.r[Rd] = ((uint32_t)lo & 0xFFFFu) | ((uint32_t)hi << 16);
+    set_q_if(sat);
+}
+
+// QADD/QSUB/QDADD/QDSUB Rd, Rm, Rn — bits 22:21 pick doubling and subtract
+void handle_qarith(uint32_t instr) {
+    uint32_t Rn = (instr >> 16) & 0xFu;
+    uint32_t Rd = (instr >> 12) & 0xFu;
+    uint32_t Rm =  instr        & 0xFu;
+    IGNORE_IF_PC(Rd);
+
+    bool sat = false;
+    int64_t n = (int32_t)cpu.r[Rn];
+    if (instr & (1u << 22)) n = sat_signed(2 * n, 32u, &sat);
+    int64_t m = (int32_t)cpu.r[Rm];
+    int64_t r = (instr & (1u << 21)) ? m - n : m + n;
+    cpu.r[Rd] = (uint32_t)sat_signed(r, 32u, &sat);
+    set_q_if(sat);
+}
+
 // helper (not exported, not in table)
 static inline void exec_mov_common(uint32_t instr, uint32_t Rd, int Sbit) {
     uint32_t sh_c = cpsr_get_C();
     uint32_t op2  = dp_operand2(instr, &sh_c);
     cpu.r[Rd] = op2;
-    if (Sbit) {
-        cpsr_set_NZ(op2);
-        cpsr_set_C_from(sh_c & 1u);
-    }
+    if (Sbit) cpsr_flags_logic(op2, sh_c);
 }
 
 // One helper for both MOV/MVN; not exported, not referenced in the table directly.
@@ -342,10 +464,7 @@ static inline void exec_mov_or_mvn_common(uint32_t instr, uint32_t Rd, int Sbit,
     cpu.r[Rd] = res;
 
     // Flag updates for S variants: N/Z from result; C from shifter carry-out
-    if (Sbit) {
-        cpsr_set_NZ(res);
-        cpsr_set_C_from(sh_c & 1u);  // keep consistent with the rest of this file
-    }
+    if (Sbit) cpsr_flags_logic(res, sh_c);
 }
 
 // MOV (data-processing form: reg/imm via dp_operand2)
@@ -12,6 +12,7 @@
 #include "memops.h"   // prototypes
 #include "debug.h"
 #include "cond.h"     // for evaluate_condition()
+#include "cpu_flags.h" // cpsr_get_C()
 #include "operand.h"
 
 // ---------- forward declaration ----------
@@ -25,6 +26,21 @@ static inline void write_pc_via_npc(uint32_t new_pc) {
     cpu.npc = new_pc & ~3u;     // keep ARM aligned
 }
 
+// LDM/STM: number of registers, and the lowest address of the transfer.
+// Registers are walked r0..r15 stepping away from base, so for DA/DB the
+// lowest register sits at the highest address; reglist_slot() gives the
+// block word for the i-th listed register.
+static inline uint32_t reglist_count(uint32_t list) {
+    return (uint32_t)__builtin_popcount(list);
+}
+static inline uint32_t reglist_lowest(uint32_t base, uint32_t P, uint32_t U, uint32_t n) {
+    if (U) return P ? base + 4u : base;                     // IB / IA
+    return P ? base - 4u * n : base - 4u * n + 4u;          // DB / DA
+}
+static inline uint32_t reglist_slot(uint32_t U, uint32_t n, uint32_t i) {
+    return U ? i : n - 1u - i;
+}
+
 // Compute effective address for extra load/store (halfword/signed family).
 static inline uint32_t extra_addr(uint32_t instr,
                                   uint32_t base,
@@ -154,16 +170,23 @@ void handle_stm(uint32_t instr) {
     uint32_t W   = (instr >> 21) & 1u;
 
     uint32_t base = addr_read_reg(Rn);                 // PC as source => PC+8
-    uint32_t addr = base;
-
-    for (uint32_t r = 0; r <= 15; ++r) {
-        if ((list >> r) & 1u) {
-            if (P) addr += U ? 4u : (uint32_t)-4;      // pre-index
-            mem_write32(addr, cpu.r[r]);
-            if (!P) addr += U ? 4u : (uint32_t)-4;     // post-index
+    uint32_t n    = reglist_count(list);
+
+    // Whole block in one RAM page: one check, straight word copies.
+    uint32_t words[16];
+    for (uint32_t r = 0, i = 0; i < n; ++r)
+        if ((list >> r) & 1u) words[reglist_slot(U, n, i++)] = cpu.r[r];
+    if (!mem_write_block32(reglist_lowest(base, P, U, n), words, n)) {
+        uint32_t addr = base;                          // MMIO / page-crossing
+        for (uint32_t r = 0; r <= 15; ++r) {
+            if ((list >> r) & 1u) {
+                if (P) addr += U ? 4u : (uint32_t)-4;  // pre-index
+                mem_write32(addr, cpu.r[r]);
+                if (!P) addr += U ? 4u : (uint32_t)-4; // post-index
+            }
         }
     }
-    if (W) cpu.r[Rn] = addr;                            // writeback
+    if (W) cpu.r[Rn] = U ? base + 4u * n : base - 4u * n;  // writeback
 }
 
 void handle_strb_postimm(uint32_t instr) {
@@ -517,7 +540,7 @@ static inline uint32_t am2_shift(uint32_t instr, uint32_t rmval) {
                          : (rmval & 0x80000000u ? 0xFFFFFFFFu : 0);
         default: { // ROR (shimm==0 => RRX with CPSR C)
             if (shimm == 0) {
-                uint32_t c = (cpu.cpsr >> 29) & 1u;
+                uint32_t c = cpsr_get_C();
                 return (rmval >> 1) | (c << 31);
             }
             shimm &= 31u;
@@ -580,7 +603,7 @@ static inline uint32_t am2_shift_imm(uint32_t val, uint32_t stype, uint32_t sh_i
             return (sh_imm ? ((uint32_t)((int32_t)val >> sh_imm)) : (val & 0x80000000u ? 0xFFFFFFFFu : 0));
         case 3: // ROR (sh_imm==0 -> RRX)
             if (sh_imm == 0) {
-                uint32_t c = (cpu.cpsr >> 29) & 1u;
+                uint32_t c = cpsr_get_C();
                 return (val >> 1) | (c << 31);
             }
             return (val >> sh_imm) | (val << (32 - sh_imm));
@@ -683,13 +706,6 @@ void handle_ldrsh(uint32_t instr) {
     if (wb) cpu.r[Rn] = new_base;
 }
 
-static inline uint32_t reglist_count(uint32_t list) {
-    // builtin popcount if you prefer; this is portable
-    uint32_t c = 0;
-    while (list) { list &= (list - 1); ++c; }
-    return c;
-}
-
 // Generic LDM/STM covering IA/IB/DA/DB, with P/U/W respected.
 // S bit (user-mode banked or PSR restore) is TODO for now.
 // LDM
@@ -702,21 +718,31 @@ void handle_ldm(uint32_t instr) {
     // uint32_t S = (instr >> 22) & 1u; // TODO
 
     uint32_t base = addr_read_reg(Rn);         // PC as source => PC+8
-    uint32_t addr = base;
-
-    for (uint32_t r = 0; r <= 15; ++r) {
-        if ((list >> r) & 1u) {
-            if (P) addr += U ? 4u : (uint32_t)-4;      // pre-index
-            uint32_t val = mem_read32(addr);
-            if (r == 15) {
-                write_pc_via_npc(val);                 // npc for PC
-            } else {
-                cpu.r[r] = val;
+    uint32_t n    = reglist_count(list);
+
+    // Whole block in one RAM page: one check, straight word copies.
+    uint32_t words[16];
+    if (mem_read_block32(reglist_lowest(base, P, U, n), words, n)) {
+        for (uint32_t r = 0, i = 0; r <= 14; ++r)
+            if ((list >> r) & 1u) cpu.r[r] = words[reglist_slot(U, n, i++)];
+        if (list & 0x8000u)                                    // npc for PC
+            write_pc_via_npc(words[reglist_slot(U, n, n - 1u)]);
+    } else {
+        uint32_t addr = base;                  // MMIO / page-crossing
+        for (uint32_t r = 0; r <= 15; ++r) {
+            if ((list >> r) & 1u) {
+                if (P) addr += U ? 4u : (uint32_t)-4;  // pre-index
+                uint32_t val = mem_read32(addr);
+                if (r == 15) {
+                    write_pc_via_npc(val);             // npc for PC
+                } else {
+                    cpu.r[r] = val;
+                }
+                if (!P) addr += U ? 4u : (uint32_t)-4; // post-index
             }
-            if (!P) addr += U ? 4u : (uint32_t)-4;     // post-index
         }
     }
-    if (W) cpu.r[Rn] = addr;                            // writeback
+    if (W) cpu.r[Rn] = U ? base + 4u * n : base - 4u * n;  // writeback
 }
 
 // ---- STR (word) — register offset addressing (AM2, bit25=1, B=0, L=0) ----
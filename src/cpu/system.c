@@ -6,6 +6,7 @@
 #include "cpu.h"         // CPU struct, extern CPU cpu
 #include "cpu_flags.h"   // psr_write(), CPSR_* bits, is_user_mode()
 #include "system.h"      // prototypes
+#include "hw.h"          // hw_sched_idle() for WFI
 
 // --- Barriers: treat as NOPs in this VM ---
 void handle_dsb(uint32_t instr) { (void)instr; }
@@ -18,17 +19,19 @@ void handle_isb(uint32_t instr) { (void)instr; }
 void handle_svc(uint32_t instr) {
     (void)instr; // imm not used
 
-    // Save old CPSR into SPSR_<svc> and LR_<svc> := return address
-    cpu.spsr  = cpu.cpsr;
-    cpu.r[14] = cpu.npc;                 // preferred return address
-
     // Enter SVC: mode=0b10011, T=0 (ARM), I=1, clear IT bits
-    uint32_t p = cpu.cpsr;
+    cpu_flags_sync();
+    uint32_t old = cpu.cpsr;
+    uint32_t p = old;
     p = (p & ~0x1Fu) | 0x13u;            // SVC mode
     p &= ~(1u << 5);                      // T=0 (ARM)
     p |=  (1u << 7);                      // I=1 (mask IRQ)
     p &= ~((0x3Fu << 10) | (0x3u << 25)); // clear IT bits
-    cpu.cpsr = p;
+    cpu_write_cpsr(p);                    // leaves the IRQ bank if in it
+
+    // Save old CPSR into SPSR_<svc> and LR_<svc> := return address
+    cpu.spsr  = old;
+    cpu.r[14] = cpu.npc;                 // preferred return address
 
     // Vector to SVC handler @ 0x00000008 (A profile, low vectors)
     cpu.npc = 0x00000008u;
@@ -39,6 +42,7 @@ void handle_svc(uint32_t instr) {
 void handle_mrs(uint32_t instr) {
     uint32_t Rd  = (instr >> 12) & 0xFu;
     uint32_t sps = (instr >> 22) & 1u;   // 0=CPSR, 1=SPSR
+    cpu_flags_sync();
     uint32_t val = sps ? cpu.spsr : cpu.cpsr;
 
     if (Rd == 15u) return;               // ignore (keeps core robust)
@@ -67,7 +71,10 @@ static void handle_msr_common(uint32_t instr) {
     } else {
         // psr_write knows how to mask fields per privilege and handle
         // control bits (E, AIF, T, mode) correctly.
-        psr_write(&cpu.cpsr, op, fields, 1);
+        cpu_flags_sync();
+        uint32_t p = cpu.cpsr;
+        psr_write(&p, op, fields, 1);
+        cpu_write_cpsr(p);
         // If T bit changed here (interworking), fetch/commit glue will
         // observe it on the next instruction via cpu.cpsr.
     }
@@ -93,20 +100,29 @@ void handle_cps(uint32_t instr) {
     if (instr & (1u << 7)) mask |= CPSR_I;
     if (instr & (1u << 6)) mask |= CPSR_F;
 
-    if (disable) cpu.cpsr |= mask; else cpu.cpsr &= ~mask;
+    uint32_t p = cpu.cpsr;
+    if (disable) p |= mask; else p &= ~mask;
 
     if (Mbit) {
         uint32_t mode = instr & 0x1Fu;
-        cpu.cpsr = (cpu.cpsr & ~0x1Fu) | (mode & 0x1Fu);
-        // (If you later bank SP/LR/SPSR per-mode, do it here.)
+        p = (p & ~0x1Fu) | (mode & 0x1Fu);
     }
+    cpu_write_cpsr(p);                   // banks SP/LR/SPSR for IRQ mode
 }
 
 // -----------------------------------------------------------------------------
 // Misc simple handlers referenced by execute()
 // -----------------------------------------------------------------------------
 void handle_nop(uint32_t instr) { (void)instr; }
-void handle_wfi(uint32_t instr) { (void)instr; }   // NOP in this VM
+
+// WFI: until an interrupt or device event nothing can change, so instead of
+// spinning let guest time jump to the next deadline (WFI ends its block, so
+// the run loop fires it right after). Without an armed event it is a NOP.
+void handle_wfi(uint32_t instr) {
+    (void)instr;
+    cpu_sync_clock();
+    hw_sched_idle();
+}
 
 void handle_deadbeef(uint32_t instr) {
     (void)instr;
@@ -185,4 +201,29 @@ void handle_clz(uint32_t instr) {
 #endif
     cpu.r[Rd] = n;
     // Flags unaffected.
-}
\ No newline at end of file
+}
+
+// UBFX/SBFX Rd, Rn, #lsb, #width  (A32)
+// lsb+width past bit 31 or Rd==PC is UNPREDICTABLE: ignore the write.
+static inline bool bfx_field(uint32_t instr, uint32_t *Rd, uint32_t *lsb, uint32_t *width) {
+    *Rd    = (instr >> 12) & 0xFu;
+    *lsb   = (instr >> 7)  & 0x1Fu;
+    *width = ((instr >> 16) & 0x1Fu) + 1u;
+    return *Rd != 15u && *lsb + *width <= 32u;
+}
+
+void handle_ubfx(uint32_t instr) {
+    uint32_t Rd, lsb, width;
+    if (!bfx_field(instr, &Rd, &lsb, &width)) return;
+    uint32_t x = cpu.r[instr & 0xFu] >> lsb;
+    cpu.r[Rd] = (width == 32u) ? x : x & ((1u << width) - 1u);
+    // Flags unaffected.
+}
+
+void handle_sbfx(uint32_t instr) {
+    uint32_t Rd, lsb, width;
+    if (!bfx_field(instr, &Rd, &lsb, &width)) return;
+    uint32_t x = cpu.r[instr & 0xFu] << (32u - lsb - width);
+    cpu.r[Rd] = (uint32_t)((int32_t)x >> (32u - width));
+    // Flags unaffected.
+}
@@ -0,0 +1,220 @@
+// src/cpu/tcache.c — predecoded basic-block cache
+// PC -> direct-mapped slot -> block of k12_ops (rule already resolved).
+// Blocks end at branch/trap class instructions, at TC_MAX_OPS, or where the
+// next word is not plain RAM / does not decode. Writes into a code granule
+// drop every block touching that granule.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "tcache.h"
+#include "mem.h"
+#include "jit.h"
+#include "snapshot.h"   // snap_io for tcache_save/load
+
+// Threads that never bind a cache share this one (single-VM tools).
+static tc_state g_tc_default;
+VM_TLS tc_state *g_tc = &g_tc_default;
+
+tc_state *tcache_create(void) {
+    return (tc_state*)calloc(1, sizeof(tc_state));
+}
+
+void tcache_destroy(tc_state *tc) {
+    if (!tc || tc == &g_tc_default) return;
+    if (g_tc == tc) g_tc = &g_tc_default;
+    jit_state_free(tc->jit);
+    free(tc);
+}
+
+void tcache_bind(tc_state *tc) {
+    g_tc = tc ? tc : &g_tc_default;
+}
+
+static inline uint32_t tc_slot(uint32_t pc) {
+    return ((pc >> 2) ^ (pc >> 14)) & (TC_BLOCK_SLOTS - 1u);
+}
+
+static inline void tc_mark_code(uint32_t start, uint32_t end) {
+    for (uint32_t g = start >> TC_GRANULE_SHIFT; g <= (end - 1u) >> TC_GRANULE_SHIFT; ++g)
+        g_tc->code_map[g >> 3] |= (uint8_t)(1u << (g & 7u));
+}
+
+void tcache_flush(void) {
+    memset(g_tc->tag, 0, sizeof g_tc->tag);
+    memset(g_tc->code_map, 0, sizeof g_tc->code_map);
+    g_tc->cur = NULL;
+    g_tc->gen++;
+}
+
+void tcache_invalidate_range(uint32_t addr, size_t len) {
+    if (!len) return;
+    uint64_t end = (uint64_t)addr + len;
+    if (end > 0x100000000ull) end = 0x100000000ull;
+
+    // Find the hot granules covered by the write and cool them down.
+    uint32_t g0 = addr >> TC_GRANULE_SHIFT;
+    uint32_t g1 = (uint32_t)((end - 1u) >> TC_GRANULE_SHIFT);
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (uint32_t g = g0; g <= g1; ++g) {
+        uint8_t bit = (uint8_t)(1u << (g & 7u));
+        if (g_tc->code_map[g >> 3] & bit) {
+            g_tc->code_map[g >> 3] &= (uint8_t)~bit;
+            if (g < lo) lo = g;
+            hi = g;
+        }
+        if (g == UINT32_MAX >> TC_GRANULE_SHIFT) break;
+    }
+    if (lo > hi) return;
+
+    // Drop whole granules (not just the written bytes): their map bits are
+    // gone now, so nothing left in them would see a later write.
+    uint64_t drop_lo = (uint64_t)lo << TC_GRANULE_SHIFT;
+    uint64_t drop_hi = ((uint64_t)hi + 1u) << TC_GRANULE_SHIFT;
+    for (uint32_t i = 0; i < TC_BLOCK_SLOTS; ++i) {
+        if (!g_tc->tag[i]) continue;
+        const tc_block *b = &g_tc->blocks[i];
+        uint64_t b0 = b->start, b1 = b0 + 4u * (uint64_t)b->n_ops;
+        if (b0 < drop_hi && drop_lo < b1) g_tc->tag[i] = 0;
+    }
+    g_tc->gen++;
+}
+
+static bool tc_fetch(uint32_t addr, uint32_t *out) {
+    const uint8_t *b = mem_host_ptr(addr, 4);      // NULL for MMIO / out of RAM
+    if (!b) return false;
+    *out = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return true;
+}
+
+// Blocks grow one op at a time as execution walks into them, so code that
+// runs once (straight-line init, zero-filled RAM) is decoded exactly once.
+static bool tc_append(tc_block *b, uint32_t pc) {
+    uint32_t w;
+    if (!tc_fetch(pc, &w)) return false;
+    if (!execute_decode(w, &b->ops[b->n_ops])) return false;
+    if (b->n_ops) execute_fuse(&b->ops[b->n_ops - 1], &b->ops[b->n_ops]);
+    b->n_ops++;
+    if (!tcache_granule_hot(pc) || !tcache_granule_hot(pc + 3u))
+        tc_mark_code(pc, pc + 4u);
+    return true;
+}
+
+static tc_block *tc_start(uint32_t slot, uint32_t pc) {
+    tc_block *b = &g_tc->blocks[slot];
+    g_tc->tag[slot] = 0;
+    b->start = pc;
+    b->n_ops = 0;
+    b->hits  = 0;
+    b->jit   = NULL;
+    if (!tc_append(b, pc)) return NULL;
+    g_tc->tag[slot] = pc + 1u;
+    return b;
+}
+
+const k12_op *tcache_lookup_run(uint32_t pc, uint32_t *left) {
+    tc_block *b = g_tc->cur;
+    if (b && g_tc->cur_gen == g_tc->gen) {
+        uint32_t off = pc - b->start;
+        if (off < 4u * b->n_ops && (off & 3u) == 0) {
+            *left = b->n_ops - (off >> 2);
+            return &b->ops[off >> 2];
+        }
+        // Fell through the last op: extend the block in place.
+        if (off == 4u * b->n_ops && b->n_ops < TC_MAX_OPS &&
+            !b->ops[b->n_ops - 1].ends_block && pc >= b->start &&
+            tc_append(b, pc)) {
+            *left = 1;
+            return &b->ops[b->n_ops - 1];
+        }
+    }
+
+    uint32_t slot = tc_slot(pc);
+    if (g_tc->tag[slot] != pc + 1u) {
+        // Only predecode a pc the second time it misses: code that runs once
+        // stays on the plain fetch/execute path and costs one store here.
+        if (g_tc->seen[slot] != pc + 1u) {
+            g_tc->seen[slot] = pc + 1u;
+            g_tc->cur = NULL;
+            return NULL;
+        }
+        b = tc_start(slot, pc);
+        if (!b) return NULL;
+    } else {
+        b = &g_tc->blocks[slot];
+    }
+    g_tc->cur     = b;
+    g_tc->cur_gen = g_tc->gen;
+    *left = b->n_ops;
+    return &b->ops[0];
+}
+
+tc_block *tcache_block_at(uint32_t pc) {
+    uint32_t slot = tc_slot(pc);
+    return g_tc->tag[slot] == pc + 1u ? &g_tc->blocks[slot] : NULL;
+}
+
+const k12_op *tcache_lookup(uint32_t pc) {
+    uint32_t left;
+    return tcache_lookup_run(pc, &left);
+}
+
+// ---- Persisted blocks ----
+uint32_t tcache_save(snap_io *s, uint32_t lo, uint32_t hi) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < TC_BLOCK_SLOTS; ++i) {
+        const tc_block *b = &g_tc->blocks[i];
+        if (g_tc->tag[i] && b->start >= lo && (uint64_t)b->start + 4u * b->n_ops <= hi) count++;
+    }
+    snap_put_u32(s, count);
+    for (uint32_t i = 0; i < TC_BLOCK_SLOTS; ++i) {
+        const tc_block *b = &g_tc->blocks[i];
+        if (!g_tc->tag[i] || b->start < lo || (uint64_t)b->start + 4u * b->n_ops > hi) continue;
+        snap_put_u32(s, b->start);
+        snap_put_u32(s, b->n_ops);
+        for (uint32_t k = 0; k < b->n_ops; ++k) {
+            snap_put_u32(s, b->ops[k].instr);
+            snap_put_u32(s, b->ops[k].rule);
+        }
+    }
+    return count;
+}
+
+int tcache_load(snap_io *s) {
+    uint32_t count = snap_get_u32(s);
+    int installed = 0;
+    for (uint32_t n = 0; n < count && s->ok; ++n) {
+        uint32_t start = snap_get_u32(s);
+        uint32_t ops   = snap_get_u32(s);
+        if (!s->ok || (start & 3u) || ops == 0 || ops > TC_MAX_OPS) return -1;
+
+        // Decode into a scratch block: a slot already in use, a word that
+        // changed, or a rule that no longer matches its word drops the block.
+        tc_block tmp;
+        bool ok = true;
+        for (uint32_t k = 0; k < ops; ++k) {
+            uint32_t instr = snap_get_u32(s);
+            uint32_t rule  = snap_get_u32(s);
+            uint32_t w;
+            if (ok) ok = rule <= UINT16_MAX && tc_fetch(start + 4u * k, &w) && w == instr &&
+                         execute_decode_rule(instr, (uint16_t)rule, &tmp.ops[k]);
+            if (ok && k) execute_fuse(&tmp.ops[k - 1], &tmp.ops[k]);
+        }
+        uint32_t slot = tc_slot(start);
+        if (!s->ok) return -1;
+        if (!ok || g_tc->tag[slot]) continue;
+
+        tc_block *b = &g_tc->blocks[slot];
+        b->start = start;
+        b->n_ops = (uint16_t)ops;
+        b->hits  = 0;
+        b->jit   = NULL;
+        memcpy(b->ops, tmp.ops, ops * sizeof b->ops[0]);
+        tc_mark_code(start, start + 4u * ops);
+        g_tc->tag[slot] = start + 1u;
+        installed++;
+    }
+    return s->ok ? installed : -1;
+}
@@ -1,5 +1,5 @@
 #include <stdbool.h>
 #include <debug.h>
 
-debug_flags_t debug_flags = DBG_NONE;  // default: no per-instruction spam
+VM_TLS debug_flags_t debug_flags = DBG_NONE;  // default: no per-instruction spam
 bool          trace_all   = false;     // default: off
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include "dev_disk.h"      // must define DISK0_BASE and VM/vm_map_mmio types
 #include "disk_manager.h"  // disk_init, disk_attach, disk_present, disk_read_sectors, disk_size_bytes
+#include "mem.h"           // mem_copy_in/out for DMA
+#include "hw.h"            // hw_event scheduler
+#include "dev_intc.h"      // IRQ_DISK0 on DMA completion
 #include "log.h"
 
 #define SECTOR_SIZE 512u
@@ -14,6 +17,7 @@ enum {
     REG_COUNT  = 0x08,
     REG_CMD    = 0x0C,
     REG_STATUS = 0x10,
+    REG_DMA    = 0x14,            // guest-physical buffer for DMA commands
     REG_DATA   = 0x200,           // 512-byte window at +0x200
 };
 
@@ -26,10 +30,19 @@ enum {
 
 // Command bits
 enum {
-    CMD_READ = 0x01,
-    CMD_GO   = 0x80,
+    CMD_READ  = 0x01,
+    CMD_WRITE = 0x02,             // DMA only
+    CMD_DMA   = 0x04,             // COUNT sectors <-> guest RAM at REG_DMA
+    CMD_GO    = 0x80,
 };
 
+// DMA timing: the transfer lands (and BUSY clears) this many guest cycles
+// per sector after the command is issued.
+#ifndef DISK_DMA_CYCLES_PER_SECTOR
+#define DISK_DMA_CYCLES_PER_SECTOR 8u
+#endif
+#define DMA_CHUNK_SECTORS 64u
+
 typedef struct {
     VM       *vm;
     uint32_t base;
@@ -38,6 +51,12 @@ typedef struct {
     uint32_t lba;
     uint32_t count;                // sectors requested (we service at least 1)
     uint32_t status;
+    uint32_t dma_addr;
+
+    // DMA in flight (parameters latched at CMD time)
+    hw_event dma_ev;
+    bool     dma_write;
+    uint32_t dma_lba, dma_count, dma_dst;
 
     // data buffer exposed at REG_DATA..+511
     uint8_t  data[SECTOR_SIZE];
@@ -45,9 +64,15 @@ typedef struct {
     // backing image
     int      slot;                 // disk_manager slot
     bool     mapped;
+    bool     dm_inited;
+
+    uint8_t  dma_buf[DMA_CHUNK_SECTORS * SECTOR_SIZE];
 } DiskCtl;
 
-static DiskCtl g_disk0 = {0};
+// One controller per VM, in the bound hw context.
+static DiskCtl *disk0_state(void) {
+    return (DiskCtl*)hw_state(HW_STATE_DISK0, sizeof(DiskCtl));
+}
 
 static uint32_t disk_mmio_read(void *ctx, uint32_t addr) {
     DiskCtl *d = (DiskCtl*)ctx;
@@ -58,6 +83,7 @@ static uint32_t disk_mmio_read(void *ctx, uint32_t addr) {
         case REG_LBA:    return d->lba;
         case REG_COUNT:  return d->count;
         case REG_STATUS: return d->status;
+        case REG_DMA:    return d->dma_addr;
 
         default:
             // Present the 512-byte data window as 32-bit little-endian words.
@@ -74,6 +100,49 @@ static uint32_t disk_mmio_read(void *ctx, uint32_t addr) {
     }
 }
 
+// Scheduler callback: move every sector in one go, then drop BUSY and
+// raise IRQ_DISK0.
+static void disk_dma_complete(void *ctx) {
+    DiskCtl *d = (DiskCtl*)ctx;
+    uint8_t *buf = d->dma_buf;
+
+    uint32_t lba = d->dma_lba, left = d->dma_count, gpa = d->dma_dst;
+    bool ok = disk_present(d->slot);
+    while (ok && left) {
+        uint32_t n   = left < DMA_CHUNK_SECTORS ? left : DMA_CHUNK_SECTORS;
+        size_t   len = (size_t)n * SECTOR_SIZE;
+        if (d->dma_write)
+            ok = mem_copy_out(buf, gpa, len) && disk_write_sectors(d->slot, lba, buf, n);
+        else
+            ok = disk_read_sectors(d->slot, lba, buf, n) && mem_copy_in(gpa, buf, len);
+        lba += n; left -= n; gpa += (uint32_t)len;
+    }
+
+    d->status = ok ? 0 : ST_ERR;
+    log_printf("[DISK] DMA %s LBA=%u COUNT=%u %s 0x%08X %s\n",
+               d->dma_write ? "WRITE" : "READ", d->dma_lba, d->dma_count,
+               d->dma_write ? "from" : "to", d->dma_dst, ok ? "done" : "FAILED");
+    dev_intc_raise(IRQ_DISK0);
+}
+
+static void disk_dma_start(DiskCtl *d, uint32_t cmd) {
+    if (d->status & ST_BUSY) {
+        log_printf("[DISK] DMA rejected: controller busy\n");
+        return;
+    }
+    if (!disk_present(d->slot)) {
+        d->status = ST_ERR;
+        log_printf("[DISK] DMA aborted: no image present\n");
+        return;
+    }
+    d->dma_write = (cmd & CMD_WRITE) != 0;
+    d->dma_lba   = d->lba;
+    d->dma_count = d->count;
+    d->dma_dst   = d->dma_addr;
+    d->status    = ST_BUSY;
+    hw_event_schedule(&d->dma_ev, (uint64_t)d->dma_count * DISK_DMA_CYCLES_PER_SECTOR);
+}
+
 static void disk_mmio_write(void *ctx, uint32_t addr, uint32_t val) {
     DiskCtl *d = (DiskCtl*)ctx;
     const uint32_t off = addr - d->base;
@@ -87,13 +156,22 @@ static void disk_mmio_write(void *ctx, uint32_t addr, uint32_t val) {
             d->count = val ? val : 1;   // never 0
             break;
 
+        case REG_DMA:
+            d->dma_addr = val;
+            break;
+
         case REG_CMD: {
             // Log the kick
             log_printf("[DISK] CMD write val=0x%X LBA=%u COUNT=%u STATUS(before)=0x%X\n",
                        val, d->lba, d->count, d->status);
 
-            // Only operation we handle: READ | GO
-            if ((val & (CMD_READ | CMD_GO)) == (CMD_READ | CMD_GO)) {
+            const uint32_t dir = val & (CMD_READ | CMD_WRITE);
+            if ((val & (CMD_DMA | CMD_GO)) == (CMD_DMA | CMD_GO) &&
+                (dir == CMD_READ || dir == CMD_WRITE)) {
+                // DMA: COUNT sectors straight to/from guest RAM, BUSY until done
+                disk_dma_start(d, val);
+            } else if ((val & (CMD_READ | CMD_GO)) == (CMD_READ | CMD_GO)) {
+                // PIO: one sector into the REG_DATA window
                 if (!disk_present(d->slot)) {
                     d->status = ST_ERR;
                     log_printf("[DISK] READ aborted: no image present\n");
@@ -144,42 +222,116 @@ bool dev_disk0_present(void) {
     return disk_present(0);
 }
 
-bool dev_disk0_attach(VM *vm, const char *image_path) {
-    if (!g_disk0.mapped) {
-        g_disk0.vm     = vm;
-        g_disk0.base   = DISK0_BASE;
-        g_disk0.slot   = 0;
-        g_disk0.lba    = 0;
-        g_disk0.count  = 1;
-        g_disk0.status = 0;
-        memset(g_disk0.data, 0, sizeof(g_disk0.data));
+// Maps the MMIO window once and then binds slot 0 to image_path, either
+// directly or as the base of a copy-on-write overlay (delta_path != NULL).
+static bool disk0_attach_common(VM *vm, const char *image_path, const char *delta_path) {
+    DiskCtl *d = disk0_state();
+    if (!d) return false;
+    if (!d->mapped) {
+        d->vm     = vm;
+        d->base   = DISK0_BASE;
+        d->slot   = 0;
+        d->lba    = 0;
+        d->count  = 1;
+        d->status = 0;
+        d->dma_addr = 0;
+        memset(d->data, 0, sizeof(d->data));
+        hw_event_init(&d->dma_ev, disk_dma_complete, d);
 
         // Map at least up to DATA+512; 0x1000 is a simple page.
-        if (!vm_map_mmio(vm, g_disk0.base, 0x1000, disk_mmio_read, disk_mmio_write, &g_disk0)) {
+        if (!vm_map_mmio(vm, d->base, 0x1000, disk_mmio_read, disk_mmio_write, d)) {
             log_printf("[ERROR] dev_disk0: vm_map_mmio failed\n");
             return false;
         }
-        g_disk0.mapped = true;
+        d->mapped = true;
     }
 
-    static bool dm_inited = false;
-    if (!dm_inited) { disk_init(); dm_inited = true; }
+    if (!d->dm_inited) { disk_init(); d->dm_inited = true; }
 
-    if (!disk_attach(0, image_path, false)) {
+    bool ok = delta_path ? disk_attach_overlay(0, image_path, delta_path)
+                         : disk_attach(0, image_path, false);
+    if (!ok) {
         log_printf("[ERROR] attach disk0 failed: %s\n", image_path);
         return false;
     }
 
     const size_t bytes = disk_size_bytes(0);
-    log_printf("[DISK] disk0 attached at 0x%08X (%zu bytes)\n", g_disk0.base, bytes);
+    log_printf("[DISK] disk0 attached at 0x%08X (%zu bytes)\n", d->base, bytes);
     return true;
 }
 
+bool dev_disk0_attach(VM *vm, const char *image_path) {
+    return disk0_attach_common(vm, image_path, NULL);
+}
+
+bool dev_disk0_attach_overlay(VM *vm, const char *base_path, const char *delta_path) {
+    return disk0_attach_common(vm, base_path, delta_path);
+}
+
+// ---- Snapshot ----
+// Controller registers, PIO window and any DMA still in flight (as cycles
+// left). The image itself is not saved; it should be the same file/overlay.
+void dev_disk0_snapshot_save(snap_io *s) {
+    const DiskCtl *d = disk0_state();
+    const DiskSlot *slot = disk_get_slot(0);
+    const char *path = (slot && slot->present) ? slot->path : "";
+    uint32_t plen = (uint32_t)strlen(path);
+
+    snap_put_u32(s, plen);
+    snap_put(s, path, plen);
+    snap_put_u32(s, d->lba);
+    snap_put_u32(s, d->count);
+    snap_put_u32(s, d->status);
+    snap_put_u32(s, d->dma_addr);
+    snap_put(s, d->data, sizeof d->data);
+
+    bool pending = d->mapped && hw_event_pending(&d->dma_ev);
+    snap_put_u32(s, pending);
+    snap_put_u64(s, pending ? d->dma_ev.when - hw_bus_now() : 0);
+    snap_put_u32(s, d->dma_write);
+    snap_put_u32(s, d->dma_lba);
+    snap_put_u32(s, d->dma_count);
+    snap_put_u32(s, d->dma_dst);
+}
+
+bool dev_disk0_snapshot_load(snap_io *s) {
+    DiskCtl *d = disk0_state();
+    char path[sizeof ((DiskSlot*)0)->path] = {0};
+    uint32_t plen = snap_get_u32(s);
+    if (plen >= sizeof path) return false;
+    snap_get(s, path, plen);
+
+    if (!d->mapped) {
+        log_printf("[SNAPSHOT] disk0 state skipped: no disk attached\n");
+        return true;
+    }
+    const DiskSlot *slot = disk_get_slot(0);
+    if (slot && slot->present && strcmp(slot->path, path) != 0)
+        log_printf("[SNAPSHOT] warning: disk0 was %s when saved, now %s\n", path, slot->path);
+
+    d->lba      = snap_get_u32(s);
+    d->count    = snap_get_u32(s);
+    d->status   = snap_get_u32(s);
+    d->dma_addr = snap_get_u32(s);
+    snap_get(s, d->data, sizeof d->data);
+
+    bool     pending = snap_get_u32(s) != 0;
+    uint64_t left    = snap_get_u64(s);
+    d->dma_write = snap_get_u32(s) != 0;
+    d->dma_lba   = snap_get_u32(s);
+    d->dma_count = snap_get_u32(s);
+    d->dma_dst   = snap_get_u32(s);
+
+    hw_event_cancel(&d->dma_ev);
+    if (pending) hw_event_schedule(&d->dma_ev, left);
+    return s->ok;
+}
+
 // Optional debug helpers mirroring earlier versions (ok to keep)
 uint32_t dev_disk0_read_reg(uint32_t addr) {
-    return disk_mmio_read(&g_disk0, addr);
+    return disk_mmio_read(disk0_state(), addr);
 }
 
 void dev_disk0_write_reg(uint32_t addr, uint32_t val) {
-    disk_mmio_write(&g_disk0, addr, val);
+    disk_mmio_write(disk0_state(), addr, val);
 }
@@ -5,19 +5,37 @@
 #include <stddef.h>
 #include <inttypes.h>
 #include "disk_manager.h"
+#include "hw.h"          // per-VM slot table
+#include "log.h"
+
+// Images are mmap()ed where the host has it (Linux, macOS, Cygwin); native
+// Windows builds fall back to reading the whole file into memory.
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#define DM_HAVE_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define DM_HAVE_MMAP 0
+#endif
 
-static DiskSlot g_disks[MAX_DISKS];
+// Each VM has its own slot table, kept in the bound hw context.
+static DiskSlot *dm_slots(void) {
+    return (DiskSlot*)hw_state(HW_STATE_DISKS, MAX_DISKS * sizeof(DiskSlot));
+}
 
 // -----------------------------------------------------------------------------
-// Logging shim (swap to your log_printf if you prefer)
+// Logging shim: log_printf, so the log file and log_set_quiet() apply
 // -----------------------------------------------------------------------------
 #ifndef DM_LOGF
-#define DM_LOGF(...) do { printf(__VA_ARGS__); } while (0)
+#define DM_LOGF(...) do { log_printf(__VA_ARGS__); } while (0)
 #endif
 
 // -----------------------------------------------------------------------------
-// File helper: read entire file into memory
+// Image backing: mmap (lazy, pages in on first touch) or a malloc'd copy
 // -----------------------------------------------------------------------------
+#if !DM_HAVE_MMAP
 static uint8_t* dm_read_entire_file(const char *path, size_t *out_size) {
     FILE *f = fopen(path, "rb");
     if (!f) return NULL;
@@ -35,12 +53,170 @@ static uint8_t* dm_read_entire_file(const char *path, size_t *out_size) {
     if (out_size) *out_size = (size_t)sz;
     return buf;
 }
+#endif
+
+// Read-only images are mapped PROT_READ/MAP_PRIVATE; writable ones
+// MAP_SHARED, so sector writes land in the file. A writable slot whose file
+// cannot be opened for writing still attaches, mapped copy-on-write
+// (MAP_PRIVATE): the guest may write, but nothing reaches the file.
+static uint8_t* dm_open_image(const char *path, bool readonly, size_t *out_size,
+                              bool *out_mapped, bool *out_private) {
+    *out_mapped  = false;
+    *out_private = readonly;
+#if DM_HAVE_MMAP
+    int fd = open(path, readonly ? O_RDONLY : O_RDWR);
+    if (fd < 0 && !readonly) {
+        fd = open(path, O_RDONLY);
+        *out_private = true;
+    }
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+    size_t sz = (size_t)st.st_size;
+    void *p = mmap(NULL, sz, readonly ? PROT_READ : (PROT_READ | PROT_WRITE),
+                   *out_private ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);                     // the mapping keeps the file referenced
+    if (p == MAP_FAILED) return NULL;
+    *out_size   = sz;
+    *out_mapped = true;
+    return (uint8_t*)p;
+#else
+    *out_private = true;           // an in-memory copy, never written back
+    return dm_read_entire_file(path, out_size);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Copy-on-write overlay (delta file)
+// -----------------------------------------------------------------------------
+// Layout, all offsets page aligned so the file can be mapped as a whole:
+//   [0, 4K)            header (host byte order)
+//   [4K, data_off)     bitmap, one bit per base sector (1 = sector is in delta)
+//   [data_off, end)    sector N at data_off + N*512, holes where never written
+// The file is sized with ftruncate(), so untouched sectors cost no disk space.
+// The header pins the base it was made from: its exact size and a hash of
+// all of its bytes, checked again on every reopen (one read of the base per
+// attach), so a base edited anywhere no longer matches its deltas.
+#define COW_MAGIC      "ARMVMCOW"
+#define COW_VERSION    3u
+#define COW_ALIGN      4096u
+#define COW_BITMAP_OFF COW_ALIGN
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t sector_size;
+    uint64_t nsec;
+    uint64_t data_off;
+    uint64_t base_size;
+    uint64_t base_hash;
+    char     base_path[260];
+} cow_header_t;
+
+static inline uint64_t cow_align(uint64_t v) {
+    return (v + COW_ALIGN - 1u) & ~(uint64_t)(COW_ALIGN - 1u);
+}
+
+static inline bool cow_has(const DiskSlot *d, uint64_t lba) {
+    return (d->cow_bitmap[lba >> 3] >> (lba & 7u)) & 1u;
+}
+
+#if DM_HAVE_MMAP
+// FNV-1a over the whole base, a 64-bit word at a time.
+static uint64_t cow_base_hash(const DiskSlot *d) {
+    uint64_t h = 0xCBF29CE484222325ull, w;
+    size_t i = 0;
+    for (; i + 8u <= d->size_bytes; i += 8u) {
+        memcpy(&w, d->img + i, 8u);
+        h ^= w; h *= 0x100000001B3ull;
+    }
+    for (; i < d->size_bytes; ++i) { h ^= d->img[i]; h *= 0x100000001B3ull; }
+    return h;
+}
+
+// Opens (or creates) the delta for a base of nsec sectors and maps it.
+static bool dm_open_delta(DiskSlot *d, const char *delta_path, uint64_t nsec) {
+    uint64_t data_off = cow_align(COW_BITMAP_OFF + (nsec + 7u) / 8u);
+    uint64_t total    = data_off + nsec * SECTOR_SIZE;
+    if (total > (uint64_t)SIZE_MAX) return false;
+
+    int fd = open(delta_path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+
+    uint64_t base_hash = cow_base_hash(d);
+    cow_header_t h;
+    if (st.st_size == 0) {
+        memset(&h, 0, sizeof h);
+        memcpy(h.magic, COW_MAGIC, sizeof h.magic);
+        h.version     = COW_VERSION;
+        h.sector_size = SECTOR_SIZE;
+        h.nsec        = nsec;
+        h.data_off    = data_off;
+        h.base_size   = d->size_bytes;
+        h.base_hash   = base_hash;
+        snprintf(h.base_path, sizeof h.base_path, "%s", d->path);
+        if (ftruncate(fd, (off_t)total) != 0 ||
+            pwrite(fd, &h, sizeof h, 0) != (ssize_t)sizeof h) {
+            close(fd);
+            return false;
+        }
+    } else {
+        // Reuse an existing delta only if it was made for this very base.
+        if (pread(fd, &h, sizeof h, 0) != (ssize_t)sizeof h ||
+            memcmp(h.magic, COW_MAGIC, sizeof h.magic) != 0 ||
+            h.version != COW_VERSION || h.sector_size != SECTOR_SIZE ||
+            h.nsec != nsec || h.data_off != data_off || (uint64_t)st.st_size < total) {
+            DM_LOGF("[DISK] %s is not an overlay for this base image\n", delta_path);
+            close(fd);
+            return false;
+        }
+        if (h.base_size != d->size_bytes || h.base_hash != base_hash) {
+            DM_LOGF("[DISK] %s was made from a different base (%.*s)\n", delta_path,
+                    (int)sizeof h.base_path, h.base_path);
+            close(fd);
+            return false;
+        }
+    }
+
+    void *p = mmap(NULL, (size_t)total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    d->cow        = (uint8_t*)p;
+    d->cow_size   = (size_t)total;
+    d->cow_bitmap = d->cow + COW_BITMAP_OFF;
+    d->cow_data   = d->cow + data_off;
+    strncpy(d->cow_path, delta_path, sizeof d->cow_path - 1);
+    return true;
+}
+#endif
+
+static void dm_release_image(DiskSlot *d) {
+#if DM_HAVE_MMAP
+    if (d->cow) { munmap(d->cow, d->cow_size); d->cow = NULL; }
+#endif
+    if (!d->img) return;
+#if DM_HAVE_MMAP
+    if (d->mapped) { munmap(d->img, d->size_bytes); d->img = NULL; return; }
+#endif
+    free(d->img);
+    d->img = NULL;
+}
 
 // -----------------------------------------------------------------------------
 // Public API
 // -----------------------------------------------------------------------------
 void disk_init(void) {
-    memset(g_disks, 0, sizeof(g_disks));
+    memset(dm_slots(), 0, MAX_DISKS * sizeof(DiskSlot));
+}
+
+void disk_shutdown(void) {
+    for (int i = 0; i < MAX_DISKS; i++) disk_detach(i);
 }
 
 static bool slot_ok(int slot) {
@@ -51,45 +227,78 @@ bool disk_attach(int slot, const char *path, bool readonly) {
     if (!slot_ok(slot) || !path) return false;
 
     size_t sz = 0;
-    uint8_t *img = dm_read_entire_file(path, &sz);
+    bool mapped = false, priv = false;
+    uint8_t *img = dm_open_image(path, readonly, &sz, &mapped, &priv);
     if (!img || sz < SECTOR_SIZE) {
-        if (img) free(img);
+        DiskSlot tmp = { .img = img, .size_bytes = sz, .mapped = mapped };
+        dm_release_image(&tmp);
         DM_LOGF("[DISK] attach disk%d failed: cannot read %s\n", slot, path);
         return false;
     }
 
-    if (g_disks[slot].present && g_disks[slot].img) {
-        free(g_disks[slot].img);
+    DiskSlot *d = &dm_slots()[slot];
+    if (d->present) {
+        dm_release_image(d);
     }
 
-    memset(&g_disks[slot], 0, sizeof(g_disks[slot]));
-    g_disks[slot].present    = true;
-    g_disks[slot].readonly   = readonly;
-    g_disks[slot].img        = img;
-    g_disks[slot].size_bytes = sz;
-    strncpy(g_disks[slot].path, path, sizeof(g_disks[slot].path)-1);
+    memset(d, 0, sizeof(*d));
+    d->present    = true;
+    d->readonly   = readonly;
+    d->mapped     = mapped;
+    d->img        = img;
+    d->size_bytes = sz;
+    strncpy(d->path, path, sizeof(d->path)-1);
+
+    DM_LOGF("[DISK] disk%d attached: %s (%zu bytes)%s%s%s\n",
+            slot, path, sz, readonly ? " [RO]" : "", mapped ? " [mmap]" : "",
+            !readonly && priv ? " [writes not saved]" : "");
+    return true;
+}
+
+bool disk_attach_overlay(int slot, const char *base_path, const char *delta_path) {
+    if (!slot_ok(slot) || !base_path || !delta_path) return false;
+#if DM_HAVE_MMAP
+    if (!disk_attach(slot, base_path, true)) return false;
+
+    DiskSlot *d = &dm_slots()[slot];
+    if (!dm_open_delta(d, delta_path, d->size_bytes / SECTOR_SIZE)) {
+        DM_LOGF("[DISK] attach disk%d failed: cannot open overlay %s\n", slot, delta_path);
+        disk_detach(slot);
+        return false;
+    }
+    d->readonly = false;           // writes go to the delta; the base stays untouched
 
-    DM_LOGF("[DISK] disk%d attached: %s (%zu bytes)%s\n",
-            slot, path, sz, readonly ? " [RO]" : "");
+    uint64_t dirty = 0;
+    for (size_t i = 0; i < (d->size_bytes / SECTOR_SIZE + 7u) / 8u; i++)
+        dirty += (uint64_t)__builtin_popcount(d->cow_bitmap[i]);
+    DM_LOGF("[DISK] disk%d overlay: %s (%" PRIu64 " sectors written)\n",
+            slot, delta_path, dirty);
     return true;
+#else
+    (void)delta_path;
+    DM_LOGF("[DISK] attach disk%d failed: overlays need mmap support\n", slot);
+    return false;
+#endif
 }
 
 bool disk_detach(int slot) {
     if (!slot_ok(slot)) return false;
-    if (!g_disks[slot].present) return true;
-    if (g_disks[slot].img) free(g_disks[slot].img);
-    memset(&g_disks[slot], 0, sizeof(g_disks[slot]));
+    DiskSlot *d = &dm_slots()[slot];
+    if (!d->present) return true;
+    dm_release_image(d);
+    memset(d, 0, sizeof(*d));
     DM_LOGF("[DISK] disk%d detached\n", slot);
     return true;
 }
 
 bool disk_present(int slot) {
-    return slot_ok(slot) && g_disks[slot].present;
+    return slot_ok(slot) && dm_slots()[slot].present;
 }
 
 size_t disk_size_bytes(int slot) {
-    if (!slot_ok(slot) || !g_disks[slot].present) return 0;
-    return g_disks[slot].size_bytes;
+    if (!slot_ok(slot)) return 0;
+    const DiskSlot *d = &dm_slots()[slot];
+    return d->present ? d->size_bytes : 0;
 }
 
 size_t disk_num_sectors(int slot) {
@@ -97,27 +306,50 @@ size_t disk_num_sectors(int slot) {
 }
 
 bool disk_read_sectors(int slot, uint64_t lba, void *dst, uint32_t nsec) {
-    if (!slot_ok(slot) || !g_disks[slot].present || !dst) return false;
-    size_t off = (size_t)(lba * SECTOR_SIZE);
-    size_t len = (size_t)nsec * SECTOR_SIZE;
-    if (off + len > g_disks[slot].size_bytes) return false;
-    memcpy(dst, g_disks[slot].img + off, len);
+    if (!slot_ok(slot) || !dst) return false;
+    const DiskSlot *d = &dm_slots()[slot];
+    if (!d->present) return false;
+    uint64_t off = lba * SECTOR_SIZE;
+    uint64_t len = (uint64_t)nsec * SECTOR_SIZE;
+    uint64_t size = d->size_bytes;
+    if (lba > UINT64_MAX / SECTOR_SIZE || off > size || len > size - off) return false;
+    if (!d->cow) {
+        memcpy(dst, d->img + off, (size_t)len);
+        return true;
+    }
+    // Overlay: each sector comes from the delta if it was ever written.
+    uint8_t *out = (uint8_t*)dst;
+    for (uint32_t i = 0; i < nsec; i++, off += SECTOR_SIZE, out += SECTOR_SIZE) {
+        const uint8_t *src = cow_has(d, lba + i) ? d->cow_data : d->img;
+        memcpy(out, src + off, SECTOR_SIZE);
+    }
     return true;
 }
 
 bool disk_write_sectors(int slot, uint64_t lba, const void *src, uint32_t nsec) {
-    if (!slot_ok(slot) || !g_disks[slot].present || !src) return false;
-    if (g_disks[slot].readonly) return false;
-    size_t off = (size_t)(lba * SECTOR_SIZE);
-    size_t len = (size_t)nsec * SECTOR_SIZE;
-    if (off + len > g_disks[slot].size_bytes) return false;
-    memcpy(g_disks[slot].img + off, src, len);
+    if (!slot_ok(slot) || !src) return false;
+    DiskSlot *d = &dm_slots()[slot];
+    if (!d->present || d->readonly) return false;
+    uint64_t off = lba * SECTOR_SIZE;
+    uint64_t len = (uint64_t)nsec * SECTOR_SIZE;
+    uint64_t size = d->size_bytes;
+    if (lba > UINT64_MAX / SECTOR_SIZE || off > size || len > size - off) return false;
+    if (!d->cow) {
+        memcpy(d->img + off, src, (size_t)len);
+        return true;
+    }
+    // Overlay: the sectors move to the delta for good.
+    memcpy(d->cow_data + off, src, (size_t)len);
+    for (uint32_t i = 0; i < nsec; i++) {
+        uint64_t s = lba + i;
+        d->cow_bitmap[s >> 3] |= (uint8_t)(1u << (s & 7u));
+    }
     return true;
 }
 
 const DiskSlot *disk_get_slot(int slot) {
     if (!slot_ok(slot)) return NULL;
-    return &g_disks[slot];
+    return &dm_slots()[slot];
 }
 
 // -----------------------------------------------------------------------------
@@ -209,20 +441,28 @@ static void u16le_to_ascii_packed(const void *src_bytes, int max_u16, char *dst,
     dst[j] = '\0';
 }
 
-static bool probe_mbr(const uint8_t *img, size_t sz) {
+// Byte off of the disk as the guest sees it: from the delta if its sector
+// was written there. Valid up to the end of that sector, which is as far as
+// any probe below reads from one pointer.
+static const uint8_t *dm_at(const DiskSlot *d, uint64_t off) {
+    const uint8_t *src = (d->cow && cow_has(d, off / SECTOR_SIZE)) ? d->cow_data : d->img;
+    return src + off;
+}
+
+static bool probe_mbr(const DiskSlot *d, size_t sz) {
     if (sz < SECTOR_SIZE) return false;
-    const mbr_t *m = (const mbr_t*)img;
+    const mbr_t *m = (const mbr_t*)dm_at(d, 0);
     return (m->sig == 0xAA55);
 }
 
-static bool probe_gpt_header(const uint8_t *img, size_t sz, gpt_header_t *out) {
+static bool probe_gpt_header(const DiskSlot *d, size_t sz, gpt_header_t *out) {
     if (sz < SECTOR_SIZE * 2) return false;
-    memcpy(out, img + SECTOR_SIZE, sizeof(gpt_header_t));
+    memcpy(out, dm_at(d, SECTOR_SIZE), sizeof(gpt_header_t));
     return (out->signature == GPT_SIG && out->num_part_entries > 0 && out->size_part_entry >= sizeof(gpt_entry_t));
 }
 
-static void print_mbr(const uint8_t *img) {
-    const mbr_t *m = (const mbr_t*)img;
+static void print_mbr(const DiskSlot *d) {
+    const mbr_t *m = (const mbr_t*)dm_at(d, 0);
     DM_LOGF("partitioning: MBR (sig=0x%04x)\n", m->sig);
     for (int i=0;i<4;i++) {
         const mbr_entry_t *e = &m->part[i];
@@ -257,10 +497,10 @@ static void guid_to_string(const uint8_t g[16], char out[37]) {
 }
 
 // Print a concise GPT partition table summary from a whole-disk image.
-static void print_gpt(const uint8_t *img, size_t sz)
+static void print_gpt(const DiskSlot *d, size_t sz)
 {
     gpt_header_t hdr;
-    if (!probe_gpt_header(img, sz, &hdr)) {
+    if (!probe_gpt_header(d, sz, &hdr)) {
         DM_LOGF("partitioning: GPT (invalid/unsupported)\n");
         return;
     }
@@ -291,7 +531,7 @@ static void print_gpt(const uint8_t *img, size_t sz)
         const uint64_t sec_off = lba * (uint64_t)SECTOR_SIZE;
         if (sec_off + SECTOR_SIZE > sz) break;
 
-        const uint8_t *sec  = img + (size_t)sec_off;
+        const uint8_t *sec  = dm_at(d, sec_off);
         const uint32_t take = (remaining > per_sec) ? per_sec : remaining;
 
         for (uint32_t i = 0; i < take; i++, index++) {
@@ -327,14 +567,14 @@ static void print_gpt(const uint8_t *img, size_t sz)
     }
 }
 
-static void print_ext_probe_from_linux_parts_mbr(const uint8_t *img, size_t sz) {
-    const mbr_t *m = (const mbr_t*)img;
+static void print_ext_probe_from_linux_parts_mbr(const DiskSlot *d, size_t sz) {
+    const mbr_t *m = (const mbr_t*)dm_at(d, 0);
     for (int i=0;i<4;i++) {
         const mbr_entry_t *e = &m->part[i];
         if (e->type != 0x83 || e->lba_first == 0 || e->sectors == 0) continue;
         uint64_t fs_byte = (uint64_t)e->lba_first * SECTOR_SIZE;
         if (fs_byte + 2048 > sz) continue;
-        const uint8_t *sb = img + fs_byte + 1024; // superblock
+        const uint8_t *sb = dm_at(d, fs_byte + 1024); // superblock
         uint16_t magic = (uint16_t)sb[56] | ((uint16_t)sb[57] << 8);
         if (magic != 0xEF53) continue;
         uint32_t lsz = (uint32_t)sb[24] | ((uint32_t)sb[25]<<8) | ((uint32_t)sb[26]<<16) | ((uint32_t)sb[27]<<24);
@@ -347,9 +587,9 @@ static void print_ext_probe_from_linux_parts_mbr(const uint8_t *img, size_t sz)
     }
 }
 
-static void print_ext_probe_from_linux_parts_gpt(const uint8_t *img, size_t sz) {
+static void print_ext_probe_from_linux_parts_gpt(const DiskSlot *d, size_t sz) {
     gpt_header_t h = {0};
-    if (!probe_gpt_header(img, sz, &h)) return;
+    if (!probe_gpt_header(d, sz, &h)) return;
     const uint64_t ents_lba = h.part_entries_lba;
     const uint32_t ents_per_sector = SECTOR_SIZE / h.size_part_entry;
     uint32_t remaining = h.num_part_entries;
@@ -357,7 +597,7 @@ static void print_ext_probe_from_linux_parts_gpt(const uint8_t *img, size_t sz)
 
     while (remaining && (lba * SECTOR_SIZE) < sz) {
         if ((lba * SECTOR_SIZE) + SECTOR_SIZE > sz) break;
-        const uint8_t *sec = img + (size_t)(lba * SECTOR_SIZE);
+        const uint8_t *sec = dm_at(d, lba * SECTOR_SIZE);
         uint32_t count = (remaining > ents_per_sector) ? ents_per_sector : remaining;
         for (uint32_t i=0;i<count; i++) {
             const gpt_entry_t *e = (const gpt_entry_t*)(sec + i * h.size_part_entry);
@@ -365,7 +605,7 @@ static void print_ext_probe_from_linux_parts_gpt(const uint8_t *img, size_t sz)
             if (!guid_eq(e->type_guid, LINUX_FS_GUID)) continue;
             uint64_t fs_byte = e->first_lba * SECTOR_SIZE;
             if (fs_byte + 2048 > sz) continue;
-            const uint8_t *sb = img + (size_t)fs_byte + 1024;
+            const uint8_t *sb = dm_at(d, fs_byte + 1024);
             uint16_t magic = (uint16_t)sb[56] | ((uint16_t)sb[57] << 8);
             if (magic != 0xEF53) continue;
             uint32_t lsz = (uint32_t)sb[24] | ((uint32_t)sb[25]<<8) | ((uint32_t)sb[26]<<16) | ((uint32_t)sb[27]<<24);
@@ -386,17 +626,18 @@ static void print_ext_probe_from_linux_parts_gpt(const uint8_t *img, size_t sz)
 // -----------------------------------------------------------------------------
 void disk_print_list(void) {
     for (int i=0;i<MAX_DISKS;i++) {
-        const DiskSlot *d = &g_disks[i];
+        const DiskSlot *d = &dm_slots()[i];
         if (!d->present) {
             DM_LOGF("disk%d: empty\n", i);
             continue;
         }
         size_t nsec = d->size_bytes / SECTOR_SIZE;
-        DM_LOGF("disk%d: %s, %s, size=%zu bytes (%zu sec) path=%s\n",
+        DM_LOGF("disk%d: %s, %s, size=%zu bytes (%zu sec) path=%s%s%s\n",
                 i, d->present?"present":"empty",
-                d->readonly?"ro":"rw",
+                d->cow ? "cow" : d->readonly?"ro":"rw",
                 d->size_bytes, nsec,
-                d->path[0]? d->path : "(unnamed)");
+                d->path[0]? d->path : "(unnamed)",
+                d->cow ? " overlay=" : "", d->cow ? d->cow_path : "");
     }
 }
 
@@ -405,7 +646,7 @@ void disk_print_info(int slot) {
         DM_LOGF("disk%d: invalid slot\n", slot);
         return;
     }
-    const DiskSlot *d = &g_disks[slot];
+    const DiskSlot *d = &dm_slots()[slot];
     if (!d->present) {
         DM_LOGF("disk%d: empty\n", slot);
         return;
@@ -413,21 +654,22 @@ void disk_print_info(int slot) {
     size_t nsec = d->size_bytes / SECTOR_SIZE;
     DM_LOGF("disk%d: present, %s\n", slot, d->readonly ? "ro" : "rw");
     DM_LOGF("  path     : %s\n", d->path[0]? d->path : "(unnamed)");
+    if (d->cow) DM_LOGF("  overlay  : %s\n", d->cow_path);
     DM_LOGF("  size     : %zu bytes (%zu sectors)\n", d->size_bytes, nsec);
     DM_LOGF("  capacity : %zu LBA (512-byte sectors)\n", nsec);
     DM_LOGF("  flags    : present%s\n", d->readonly? ", readonly" : "");
 
     // Partitioning summary
-    bool is_mbr = probe_mbr(d->img, d->size_bytes);
+    bool is_mbr = probe_mbr(d, d->size_bytes);
     gpt_header_t gh;
-    bool is_gpt = probe_gpt_header(d->img, d->size_bytes, &gh);
+    bool is_gpt = probe_gpt_header(d, d->size_bytes, &gh);
 
     if (is_gpt) {
-        print_gpt(d->img, d->size_bytes);
-        print_ext_probe_from_linux_parts_gpt(d->img, d->size_bytes);
+        print_gpt(d, d->size_bytes);
+        print_ext_probe_from_linux_parts_gpt(d, d->size_bytes);
     } else if (is_mbr) {
-        print_mbr(d->img);
-        print_ext_probe_from_linux_parts_mbr(d->img, d->size_bytes);
+        print_mbr(d);
+        print_ext_probe_from_linux_parts_mbr(d, d->size_bytes);
     } else {
         DM_LOGF("partitioning: none/unknown\n");
     }
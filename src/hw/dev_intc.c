@@ -0,0 +1,136 @@
+// src/hw/dev_intc.c — GIC-lite interrupt controller
+// The output is g_hw->irq, which the CPU samples between instructions.
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dev_intc.h"
+#include "hw_bus.h"
+#include "hw.h"
+
+enum {
+    INTC_CTRL       = 0x00,
+    INTC_TYPE       = 0x04,
+    INTC_PENDING    = 0x08,
+    INTC_ACTIVE     = 0x0C,
+    INTC_ENABLE_SET = 0x10,
+    INTC_ENABLE_CLR = 0x14,
+    INTC_PEND_SET   = 0x18,
+    INTC_PEND_CLR   = 0x1C,
+    INTC_IAR        = 0x20,
+    INTC_EOIR       = 0x24,
+};
+
+typedef struct {
+    uint32_t base;
+    uint32_t ctrl;      // bit0 ENABLE
+    uint32_t enable;
+    uint32_t level;     // lines held high by their device
+    uint32_t latched;   // raised / PEND_SET, cleared by IAR or PEND_CLR
+    uint32_t active;
+} intc_dev_t;
+
+// One per VM, in the bound hw context.
+static intc_dev_t* intc_state(void) {
+    return (intc_dev_t*)hw_state(HW_STATE_INTC, sizeof(intc_dev_t));
+}
+
+static inline uint32_t intc_ready(const intc_dev_t* c) {
+    return (c->level | c->latched) & c->enable & ~c->active;
+}
+
+// Recompute the CPU line; a rising edge makes the CPU look at it promptly.
+static void intc_update(intc_dev_t* c) {
+    bool out = (c->ctrl & 1u) && !c->active && intc_ready(c);
+    bool rise = out && !g_hw->irq;
+    g_hw->irq = out;
+    if (rise) hw_irq_kick();
+}
+
+void dev_intc_init(uint32_t base_addr) {
+    intc_dev_t* c = intc_state();
+    memset(c, 0, sizeof *c);
+    c->base = base_addr;
+    g_hw->irq = false;
+    hw_bus_map_region("intc", base_addr, INTC_MMIO_SIZE,
+                      /*read32=*/dev_intc_read32,
+                      /*write32=*/dev_intc_write32);
+}
+
+void dev_intc_set_level(unsigned line, bool high) {
+    if (line >= INTC_LINES) return;
+    intc_dev_t* c = intc_state();
+    if (high) c->level |=  (1u << line);
+    else      c->level &= ~(1u << line);
+    intc_update(c);
+}
+
+void dev_intc_raise(unsigned line) {
+    if (line >= INTC_LINES) return;
+    intc_dev_t* c = intc_state();
+    c->latched |= 1u << line;
+    intc_update(c);
+}
+
+uint32_t dev_intc_read32(uint32_t addr) {
+    intc_dev_t* c = intc_state();
+    switch (addr - c->base) {
+        case INTC_CTRL:       return c->ctrl;
+        case INTC_TYPE:       return INTC_LINES;
+        case INTC_PENDING:    return c->level | c->latched;
+        case INTC_ACTIVE:     return c->active;
+        case INTC_ENABLE_SET:
+        case INTC_ENABLE_CLR: return c->enable;
+        case INTC_IAR: {
+            hw_read_volatile();             // acknowledges
+            uint32_t ready = intc_ready(c);
+            if (!ready) return INTC_SPURIOUS;
+            uint32_t line = (uint32_t)__builtin_ctz(ready);
+            c->active  |=  (1u << line);
+            c->latched &= ~(1u << line);
+            intc_update(c);
+            return line;
+        }
+        default:              return 0u;
+    }
+}
+
+void dev_intc_write32(uint32_t addr, uint32_t value) {
+    intc_dev_t* c = intc_state();
+    switch (addr - c->base) {
+        case INTC_CTRL:       c->ctrl     = value & 1u; break;
+        case INTC_ENABLE_SET: c->enable  |=  value;     break;
+        case INTC_ENABLE_CLR: c->enable  &= ~value;     break;
+        case INTC_PEND_SET:   c->latched |=  value;     break;
+        case INTC_PEND_CLR:   c->latched &= ~value;     break;
+        case INTC_EOIR:
+            if (value < INTC_LINES) c->active &= ~(1u << value);
+            break;
+        default:              return;       // RO / unmapped: ignore
+    }
+    intc_update(c);
+}
+
+// ---- Snapshot ----
+void dev_intc_snapshot_save(snap_io* s) {
+    const intc_dev_t* c = intc_state();
+    snap_put_u32(s, c->base);
+    snap_put_u32(s, c->ctrl);
+    snap_put_u32(s, c->enable);
+    snap_put_u32(s, c->level);
+    snap_put_u32(s, c->latched);
+    snap_put_u32(s, c->active);
+}
+
+bool dev_intc_snapshot_load(snap_io* s) {
+    intc_dev_t* c = intc_state();
+    c->base    = snap_get_u32(s);
+    c->ctrl    = snap_get_u32(s);
+    c->enable  = snap_get_u32(s);
+    c->level   = snap_get_u32(s);
+    c->latched = snap_get_u32(s);
+    c->active  = snap_get_u32(s);
+    g_hw->irq  = false;
+    intc_update(c);
+    return s->ok;
+}
@@ -3,56 +3,83 @@
 #include <string.h>
 #include "dev_nvram.h"
 #include "log.h"
+#include "hw.h"
 
-static uint8_t nvram[NVRAM_CAPACITY];
-static uint8_t index_reg = 0;
-static char    nvram_path[260];
+typedef struct {
+    uint8_t data[NVRAM_CAPACITY];
+    uint8_t index_reg;
+    char    path[260];      // backing file, "" = memory only
+} nvram_dev_t;
+
+// One per VM, in the bound hw context.
+static nvram_dev_t* nvram_state(void) {
+    return (nvram_dev_t*)hw_state(HW_STATE_NVRAM, sizeof(nvram_dev_t));
+}
 
 static void nvram_load(void) {
-    FILE *f = fopen(nvram_path, "rb");
+    nvram_dev_t* nv = nvram_state();
+    FILE *f = nv->path[0] ? fopen(nv->path, "rb") : NULL;
     if (f) {
-        fread(nvram, 1, NVRAM_CAPACITY, f);
+        fread(nv->data, 1, NVRAM_CAPACITY, f);
         fclose(f);
     } else {
-        memset(nvram, 0, sizeof nvram);
+        memset(nv->data, 0, sizeof nv->data);
         // default boot order: DISK
-        nvram[NVRAM_OFF_BOOT_ORDER] = 0; // 0:DISK, 1:NET, 2:CD
+        nv->data[NVRAM_OFF_BOOT_ORDER] = 0; // 0:DISK, 1:NET, 2:CD
     }
 }
 static void nvram_save(void) {
-    FILE *f = fopen(nvram_path, "wb");
+    nvram_dev_t* nv = nvram_state();
+    if (!nv->path[0]) return;
+    FILE *f = fopen(nv->path, "wb");
     if (f) {
-        fwrite(nvram, 1, NVRAM_CAPACITY, f);
+        fwrite(nv->data, 1, NVRAM_CAPACITY, f);
         fclose(f);
     }
 }
 
 void dev_nvram_init(const char *backing_path) {
-    strncpy(nvram_path, backing_path ? backing_path : "nvram.bin", sizeof nvram_path);
-    nvram_path[sizeof nvram_path - 1] = '\0';
+    nvram_dev_t* nv = nvram_state();
+    snprintf(nv->path, sizeof nv->path, "%s", backing_path ? backing_path : "");
     nvram_load();
 }
 
 uint32_t dev_nvram_read32(uint32_t addr) {
+    nvram_dev_t* nv = nvram_state();
     uint32_t off = addr - NVRAM_BASE_ADDR;
     switch (off) {
-    case NVRAM_REG_INDEX: return index_reg; // low byte used
-    case NVRAM_REG_DATA:  return nvram[index_reg];
+    case NVRAM_REG_INDEX: return nv->index_reg; // low byte used
+    case NVRAM_REG_DATA:  return nv->data[nv->index_reg];
     default:              return 0;
     }
 }
 
 void dev_nvram_write32(uint32_t addr, uint32_t value) {
+    nvram_dev_t* nv = nvram_state();
     uint32_t off = addr - NVRAM_BASE_ADDR;
     switch (off) {
     case NVRAM_REG_INDEX:
-        index_reg = (uint8_t)(value & 0xFF);
+        nv->index_reg = (uint8_t)(value & 0xFF);
         break;
     case NVRAM_REG_DATA:
-        nvram[index_reg] = (uint8_t)(value & 0xFF);
+        nv->data[nv->index_reg] = (uint8_t)(value & 0xFF);
         nvram_save();
         break;
     default:
         break;
     }
-}
\ No newline at end of file
+}
+// ---- Snapshot ----
+// In-memory contents only; the backing file is left as it is.
+void dev_nvram_snapshot_save(snap_io *s) {
+    nvram_dev_t* nv = nvram_state();
+    snap_put_u32(s, nv->index_reg);
+    snap_put(s, nv->data, sizeof nv->data);
+}
+
+bool dev_nvram_snapshot_load(snap_io *s) {
+    nvram_dev_t* nv = nvram_state();
+    nv->index_reg = (uint8_t)snap_get_u32(s);
+    snap_get(s, nv->data, sizeof nv->data);
+    return s->ok;
+}
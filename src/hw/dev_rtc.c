@@ -2,6 +2,7 @@
 #include "dev_rtc.h"
 #include <time.h>
 #include <string.h>
+#include "hw.h"
 
 typedef struct {
     uint32_t base;
@@ -13,7 +14,10 @@ typedef struct {
     uint32_t  ctrl;   // bit0 FREEZE, bit1 WENA
 } rtc_dev_t;
 
-static rtc_dev_t g_rtc = {0};
+// One per VM, in the bound hw context.
+static rtc_dev_t* rtc_state(void) {
+    return (rtc_dev_t*)hw_state(HW_STATE_RTC, sizeof(rtc_dev_t));
+}
 
 static void rtc_get_now(time_t* out_secs, struct tm* out_tm, int* out_ms) {
     // Epoch seconds
@@ -39,31 +43,34 @@ static void rtc_get_now(time_t* out_secs, struct tm* out_tm, int* out_ms) {
 }
 
 void dev_rtc_init(uint32_t base_addr) {
-    memset(&g_rtc, 0, sizeof(g_rtc));
-    g_rtc.base = base_addr;
+    rtc_dev_t* r = rtc_state();
+    memset(r, 0, sizeof(*r));
+    r->base = base_addr;
     // Prime a snapshot so reads work even if frozen immediately
-    rtc_get_now(&g_rtc.latched_secs, &g_rtc.latched_tm, &g_rtc.latched_ms);
+    rtc_get_now(&r->latched_secs, &r->latched_tm, &r->latched_ms);
 }
 
 static inline uint32_t ro(uint32_t v){ return v; }
 
 uint32_t dev_rtc_read32(uint32_t addr) {
-    uint32_t off = addr - g_rtc.base;
+    rtc_dev_t* r = rtc_state();
+    uint32_t off = addr - r->base;
 
     time_t secs; struct tm t; int ms;
-    if (g_rtc.ctrl & 0x1u) {            // FREEZE
-        secs = g_rtc.latched_secs;
-        t    = g_rtc.latched_tm;
-        ms   = g_rtc.latched_ms;
+    if (r->ctrl & 0x1u) {            // FREEZE
+        secs = r->latched_secs;
+        t    = r->latched_tm;
+        ms   = r->latched_ms;
     } else {
         rtc_get_now(&secs, &t, &ms);
+        hw_read_volatile();          // host time
     }
 
     switch (off) {
         case 0x00: return ro((uint32_t)secs);                      // SECONDS
         case 0x04: return ro((uint32_t)ms);                        // MILLIS
-        case 0x08: return ro(g_rtc.ctrl);                          // CTRL
-        case 0x0C: return ro((g_rtc.ctrl & 0x1u) ? 1u : 0u);       // STATUS
+        case 0x08: return ro(r->ctrl);                          // CTRL
+        case 0x0C: return ro((r->ctrl & 0x1u) ? 1u : 0u);       // STATUS
         case 0x10: return ro((uint32_t)(t.tm_year + 1900));        // YEAR
         case 0x14: return ro((uint32_t)(t.tm_mon + 1));            // MONTH
         case 0x18: return ro((uint32_t)(t.tm_mday));               // DAY
@@ -75,40 +82,41 @@ uint32_t dev_rtc_read32(uint32_t addr) {
 }
 
 void dev_rtc_write32(uint32_t addr, uint32_t value) {
-    uint32_t off = addr - g_rtc.base;
+    rtc_dev_t* r = rtc_state();
+    uint32_t off = addr - r->base;
 
     switch (off) {
         case 0x08: { // CTRL: bit0 FREEZE, bit1 WENA
-            uint32_t prev = g_rtc.ctrl;
-            g_rtc.ctrl = (value & 0x3u);
+            uint32_t prev = r->ctrl;
+            r->ctrl = (value & 0x3u);
             // If FREEZE rising edge, latch a snapshot
-            if (((g_rtc.ctrl ^ prev) & 0x1u) && (g_rtc.ctrl & 0x1u)) {
-                rtc_get_now(&g_rtc.latched_secs, &g_rtc.latched_tm, &g_rtc.latched_ms);
+            if (((r->ctrl ^ prev) & 0x1u) && (r->ctrl & 0x1u)) {
+                rtc_get_now(&r->latched_secs, &r->latched_tm, &r->latched_ms);
             }
             break;
         }
 
         case 0x28: { // SET_SECS (WO): valid only when CTRL.WENA=1
-            if (g_rtc.ctrl & 0x2u) {
+            if (r->ctrl & 0x2u) {
                 time_t s = (time_t)value;
 #if defined(_WIN32)
                 struct tm t; localtime_s(&t, &s);
 #else
                 struct tm t; localtime_r(&s, &t);
 #endif
-                g_rtc.latched_secs = s;
-                g_rtc.latched_tm   = t;
-                g_rtc.latched_ms   = 0;
+                r->latched_secs = s;
+                r->latched_tm   = t;
+                r->latched_ms   = 0;
                 // Freeze so subsequent reads are consistent
-                g_rtc.ctrl |= 0x1u; // FREEZE
+                r->ctrl |= 0x1u; // FREEZE
             }
             break;
         }
 
         case 0x2C: { // CLEAR (WO): write 1 => unfreeze & clear WENA
             if (value & 1u) {
-                g_rtc.ctrl &= ~(0x1u); // FREEZE=0
-                g_rtc.ctrl &= ~(0x2u); // WENA=0
+                r->ctrl &= ~(0x1u); // FREEZE=0
+                r->ctrl &= ~(0x2u); // WENA=0
             }
             break;
         }
@@ -117,4 +125,27 @@ void dev_rtc_write32(uint32_t addr, uint32_t value) {
             // Ignore writes to RO space
             break;
     }
-}
\ No newline at end of file
+}
+// ---- Snapshot ----
+// Control bits and the latched time; tm is rebuilt from the seconds.
+void dev_rtc_snapshot_save(snap_io* s) {
+    rtc_dev_t* r = rtc_state();
+    snap_put_u32(s, r->base);
+    snap_put_u32(s, r->ctrl);
+    snap_put_u64(s, (uint64_t)(int64_t)r->latched_secs);
+    snap_put_u32(s, (uint32_t)r->latched_ms);
+}
+
+bool dev_rtc_snapshot_load(snap_io* s) {
+    rtc_dev_t* r = rtc_state();
+    r->base         = snap_get_u32(s);
+    r->ctrl         = snap_get_u32(s);
+    r->latched_secs = (time_t)(int64_t)snap_get_u64(s);
+    r->latched_ms   = (int)snap_get_u32(s);
+#if defined(_WIN32)
+    localtime_s(&r->latched_tm, &r->latched_secs);
+#else
+    localtime_r(&r->latched_secs, &r->latched_tm);
+#endif
+    return s->ok;
+}
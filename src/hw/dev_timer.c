@@ -0,0 +1,130 @@
+// src/hw/dev_timer.c — periodic / one-shot timer on the guest clock
+// Expiry is an hw_event, so a WFI-ing guest sleeps straight up to it.
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dev_timer.h"
+#include "dev_intc.h"
+#include "hw_bus.h"
+#include "hw.h"
+
+enum {
+    TIMER_LOAD   = 0x00,
+    TIMER_VALUE  = 0x04,
+    TIMER_CTRL   = 0x08,
+    TIMER_STATUS = 0x0C,
+    TIMER_NOW_LO = 0x10,
+    TIMER_NOW_HI = 0x14,
+};
+
+typedef struct {
+    uint32_t base;
+    uint32_t load;
+    uint32_t ctrl;
+    uint32_t status;
+    hw_event ev;        // expiry
+} timer_dev_t;
+
+// One per VM, in the bound hw context.
+static timer_dev_t* timer_state(void) {
+    return (timer_dev_t*)hw_state(HW_STATE_TIMER, sizeof(timer_dev_t));
+}
+
+static void timer_update_irq(const timer_dev_t* t) {
+    dev_intc_set_level(IRQ_TIMER0, (t->status & TIMER_STATUS_EXPIRED) &&
+                                   (t->ctrl & TIMER_CTRL_IRQ_EN));
+}
+
+// (Re)start the count from now, or stop it; LOAD 0 never expires.
+static void timer_arm(timer_dev_t* t) {
+    if ((t->ctrl & TIMER_CTRL_ENABLE) && t->load) hw_event_schedule(&t->ev, t->load);
+    else                                          hw_event_cancel(&t->ev);
+}
+
+static void timer_expire(void* ctx) {
+    timer_dev_t* t = (timer_dev_t*)ctx;
+    t->status |= TIMER_STATUS_EXPIRED;
+    if (!(t->ctrl & TIMER_CTRL_PERIODIC)) t->ctrl &= ~TIMER_CTRL_ENABLE;
+    timer_arm(t);
+    timer_update_irq(t);
+}
+
+void dev_timer_init(uint32_t base_addr) {
+    timer_dev_t* t = timer_state();
+    memset(t, 0, sizeof *t);
+    t->base = base_addr;
+    hw_event_init(&t->ev, timer_expire, t);
+    hw_bus_map_region("timer", base_addr, TIMER_MMIO_SIZE,
+                      /*read32=*/dev_timer_read32,
+                      /*write32=*/dev_timer_write32);
+}
+
+uint32_t dev_timer_read32(uint32_t addr) {
+    timer_dev_t* t = timer_state();
+    uint32_t off = addr - t->base;
+    if (off == TIMER_VALUE || off == TIMER_NOW_LO || off == TIMER_NOW_HI)
+        hw_read_volatile();                 // follows the clock
+    switch (off) {
+        case TIMER_LOAD:   return t->load;
+        case TIMER_VALUE:
+            return hw_event_pending(&t->ev) ? (uint32_t)(t->ev.when - hw_bus_now()) : 0u;
+        case TIMER_CTRL:   return t->ctrl;
+        case TIMER_STATUS: return t->status;
+        case TIMER_NOW_LO: return (uint32_t)hw_bus_now();
+        case TIMER_NOW_HI: return (uint32_t)(hw_bus_now() >> 32);
+        default:           return 0u;
+    }
+}
+
+void dev_timer_write32(uint32_t addr, uint32_t value) {
+    timer_dev_t* t = timer_state();
+    switch (addr - t->base) {
+        case TIMER_LOAD:
+            t->load = value;
+            timer_arm(t);
+            break;
+        case TIMER_CTRL: {
+            uint32_t was = t->ctrl;
+            t->ctrl = value & (TIMER_CTRL_ENABLE | TIMER_CTRL_PERIODIC | TIMER_CTRL_IRQ_EN);
+            // Enabling starts a fresh count; other bits leave it running.
+            if ((was ^ t->ctrl) & TIMER_CTRL_ENABLE) timer_arm(t);
+            timer_update_irq(t);
+            break;
+        }
+        case TIMER_STATUS:
+            t->status &= ~(value & TIMER_STATUS_EXPIRED);
+            timer_update_irq(t);
+            break;
+        default:
+            // Ignore writes to RO space
+            break;
+    }
+}
+
+// ---- Snapshot ----
+// Registers plus the running count as cycles left.
+void dev_timer_snapshot_save(snap_io* s) {
+    const timer_dev_t* t = timer_state();
+    bool pending = hw_event_pending(&t->ev);
+    snap_put_u32(s, t->base);
+    snap_put_u32(s, t->load);
+    snap_put_u32(s, t->ctrl);
+    snap_put_u32(s, t->status);
+    snap_put_u32(s, pending);
+    snap_put_u64(s, pending ? t->ev.when - hw_bus_now() : 0);
+}
+
+bool dev_timer_snapshot_load(snap_io* s) {
+    timer_dev_t* t = timer_state();
+    t->base   = snap_get_u32(s);
+    t->load   = snap_get_u32(s);
+    t->ctrl   = snap_get_u32(s);
+    t->status = snap_get_u32(s);
+    bool     pending = snap_get_u32(s) != 0;
+    uint64_t left    = snap_get_u64(s);
+
+    hw_event_cancel(&t->ev);
+    if (pending) hw_event_schedule(&t->ev, left);
+    return s->ok;
+}
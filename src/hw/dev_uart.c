@@ -4,22 +4,48 @@
 #include <stdbool.h>
 
 #include "dev_uart.h"
+#include "hw_bus.h"
+#include "hw.h"
 
-static uint32_t g_uart_base = 0;
-static bool     g_uart_ok   = false;
+typedef struct {
+    uint32_t base;
+    bool     ok;
+    char    *cap;          // TX capture buffer (NULL = stdout)
+    size_t   cap_size, cap_len;
+} uart_dev_t;
+
+// One per VM, in the bound hw context.
+static uart_dev_t* uart_state(void) {
+    return (uart_dev_t*)hw_state(HW_STATE_UART, sizeof(uart_dev_t));
+}
 
 void dev_uart_init(uint32_t base) {
-    g_uart_base = base;
-    g_uart_ok   = true;
+    uart_dev_t* u = uart_state();
+    u->base = base;
+    u->ok   = hw_bus_map_region("uart0", base, UART_MMIO_SIZE,
+                            dev_uart_read_reg, dev_uart_write_reg);
+}
+
+void dev_uart_set_capture(char *buf, size_t size) {
+    uart_dev_t* u = uart_state();
+    u->cap      = (buf && size) ? buf : NULL;
+    u->cap_size = u->cap ? size : 0;
+    u->cap_len  = 0;
+    if (u->cap) u->cap[0] = '\0';
+}
+
+size_t dev_uart_captured(void) {
+    return uart_state()->cap_len;
 }
 
 bool dev_uart_present(void) {
-    return g_uart_ok;
+    return uart_state()->ok;
 }
 
 uint32_t dev_uart_read_reg(uint32_t addr) {
-    if (!g_uart_ok) return 0;
-    uint32_t off = addr - g_uart_base;
+    uart_dev_t* u = uart_state();
+    if (!u->ok) return 0;
+    uint32_t off = addr - u->base;
 
     switch (off) {
         case UART_FR:
@@ -32,12 +58,20 @@ uint32_t dev_uart_read_reg(uint32_t addr) {
 }
 
 void dev_uart_write_reg(uint32_t addr, uint32_t val) {
-    if (!g_uart_ok) return;
-    uint32_t off = addr - g_uart_base;
+    uart_dev_t* u = uart_state();
+    if (!u->ok) return;
+    uint32_t off = addr - u->base;
 
     switch (off) {
         case UART_DR: {
             uint8_t ch = (uint8_t)val;
+            if (u->cap) {
+                if (u->cap_len + 1 < u->cap_size) {
+                    u->cap[u->cap_len++] = (char)ch;
+                    u->cap[u->cap_len] = '\0';
+                }
+                break;
+            }
             putchar(ch);
             fflush(stdout);
             break;
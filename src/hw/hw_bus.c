@@ -1,92 +1,260 @@
 #include "hw.h"
+#include "hw_bus.h"
+#include "mem.h"       // mem_mmio_changed()
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define MAX_DEVS 32
+#define MAX_REGIONS 32
 
-static HWDevice* g_devs[MAX_DEVS];
-static int       g_ndevs = 0;
+typedef enum {
+    REGION_HWDEV,     // HWDevice: handlers take the offset from base
+    REGION_CTX,       // vm_map_mmio(): handlers take (ctx, absolute address)
+    REGION_PLAIN,     // hw_bus_map_region(): handlers take the absolute address
+} region_kind_t;
 
-// simple per-class scaling (expand as you add devices)
-static int g_disk_bpc = 64;   // disk bytes per *CPU cycle* (default)
-static int g_uart_bpc = 1;    // uart bytes per cycle
-static int g_crt_bpc  = 0;    // no default work
+typedef struct {
+    uint32_t      base, size;
+    region_kind_t kind;
+    const char   *name;
+    HWDevice     *dev;
+    vm_mmio_read_fn  ctx_read;
+    vm_mmio_write_fn ctx_write;
+    void            *ctx;
+    uint32_t (*plain_read)(uint32_t addr);
+    void     (*plain_write)(uint32_t addr, uint32_t value);
+} Region;
 
-void hw_bus_set_scale(int disk_bpc, int uart_bpc, int crt_bpc) {
-    if (disk_bpc >= 0) g_disk_bpc = disk_bpc;
-    if (uart_bpc >= 0) g_uart_bpc = uart_bpc;
-    if (crt_bpc  >= 0) g_crt_bpc  = crt_bpc;
+struct hw_bus_map {
+    HWDevice* devs[MAX_DEVS];
+    int       ndevs;
+    // Default work units per guest cycle, by device kind; a device's own
+    // clock_ratio overrides it.
+    uint32_t  kind_ratio[HW_DEV_KINDS];
+    Region    regions[MAX_REGIONS];
+    int       nregions;
+    uint8_t   page_region[HW_BUS_PAGE_COUNT];
+};
+
+#define KIND_RATIO_DEFAULTS {                                  \
+    [HW_DEV_OTHER] = 0,                                         \
+    [HW_DEV_DISK]  = 64,      /* disk bytes per cycle */        \
+    [HW_DEV_UART]  = 1,       /* uart bytes per cycle */        \
+    [HW_DEV_CRT]   = 0,       /* no default work */             \
 }
+static const uint32_t k_kind_ratio[HW_DEV_KINDS] = KIND_RATIO_DEFAULTS;
 
-void hw_bus_init(void) {
-    g_ndevs = 0;
+// -----------------------------------------------------------------------------
+// Per-VM contexts
+// -----------------------------------------------------------------------------
+// Threads that never bind a context share this one (single-VM tools).
+static hw_bus_map g_bus_default = { .kind_ratio = KIND_RATIO_DEFAULTS };
+static hw_ctx g_hw_default = { .next = UINT64_MAX, .bus = &g_bus_default,
+                                .irq_kick = { .slot = -1 } };
+VM_TLS hw_ctx* g_hw = &g_hw_default;
+
+hw_ctx* hw_ctx_create(void) {
+    hw_ctx* hw = (hw_ctx*)calloc(1, sizeof *hw);
+    if (!hw) return NULL;
+    hw->bus = (hw_bus_map*)calloc(1, sizeof *hw->bus);
+    if (!hw->bus) { free(hw); return NULL; }
+    hw->next = UINT64_MAX;
+    hw_event_init(&hw->irq_kick, NULL, NULL);
+    memcpy(hw->bus->kind_ratio, k_kind_ratio, sizeof k_kind_ratio);
+    return hw;
+}
+
+void hw_ctx_destroy(hw_ctx* hw) {
+    if (!hw || hw == &g_hw_default) return;
+    if (g_hw == hw) g_hw = &g_hw_default;
+    for (int i = 0; i < HW_STATE_COUNT; i++) free(hw->state[i]);
+    free(hw->bus);
+    free(hw);
+}
+
+void hw_ctx_bind(hw_ctx* hw) {
+    g_hw = hw ? hw : &g_hw_default;
+}
+
+void* hw_state(hw_state_id id, size_t size) {
+    if ((unsigned)id >= HW_STATE_COUNT) return NULL;
+    if (!g_hw->state[id]) g_hw->state[id] = calloc(1, size);
+    return g_hw->state[id];
+}
+
+void hw_bus_set_clock_ratio(hw_dev_kind_t kind, uint32_t units_per_cycle) {
+    if ((unsigned)kind < HW_DEV_KINDS) g_hw->bus->kind_ratio[kind] = units_per_cycle;
 }
 
-static bool overlaps(uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1) {
-    return !(b1 <= a0 || a1 <= b0);
+// ---- Device ticks (scheduler driven) ----
+static void dev_tick_event(void* ctx) {
+    HWDevice* d = (HWDevice*)ctx;
+    uint64_t elapsed = g_hw->now - d->last_tick;
+    uint32_t ratio   = d->clock_ratio ? d->clock_ratio
+                     : ((unsigned)d->kind < HW_DEV_KINDS ? g_hw->bus->kind_ratio[d->kind] : 0);
+    uint64_t budget  = elapsed * ratio;
+    d->last_tick = g_hw->now;
+
+    if (budget > 0 && d->tick) d->tick(d, budget > INT32_MAX ? INT32_MAX : (int)budget);
+
+    // The device may have asked for its next deadline from inside tick().
+    if (!hw_event_pending(&d->ev) && d->period)
+        hw_event_schedule(&d->ev, d->period);
+}
+
+void hw_bus_schedule(HWDevice* d, uint64_t delay) {
+    hw_event_schedule(&d->ev, delay);
+}
+
+// -----------------------------------------------------------------------------
+// Unified MMIO map
+// -----------------------------------------------------------------------------
+// Every window -- HWDevice, vm_map_mmio() handler, hw_bus_map_region() -- is
+// one region. A byte per 4 KiB guest page holds the owning region (index+1,
+// 0 = none), so a lookup is one table load plus a bounds compare no matter how
+// many devices are mapped. Regions own whole pages: two windows may not share
+// a page even if their byte ranges don't touch.
+static inline uint32_t page_first(uint32_t base) { return base >> HW_BUS_PAGE_SHIFT; }
+static inline uint32_t page_last(uint32_t base, uint32_t size) {
+    return (uint32_t)(((uint64_t)base + size - 1u) >> HW_BUS_PAGE_SHIFT);
+}
+
+static inline const Region* region_at(uint32_t addr) {
+    const hw_bus_map* b = g_hw->bus;
+    uint8_t r = b->page_region[addr >> HW_BUS_PAGE_SHIFT];
+    if (!r) return NULL;
+    const Region* g = &b->regions[r - 1];
+    return (addr - g->base < g->size) ? g : NULL;
+}
+
+// Claims the pages of [base, base+size); false on overlap or a full table.
+static bool region_add(const Region* proto) {
+    hw_bus_map* b = g_hw->bus;
+    if (proto->size == 0 || (uint64_t)proto->base + proto->size > 0x100000000ull) return false;
+    if (b->nregions >= MAX_REGIONS) return false;
+
+    uint32_t p0 = page_first(proto->base), p1 = page_last(proto->base, proto->size);
+    for (uint32_t p = p0; p <= p1; p++)
+        if (b->page_region[p]) return false;
+
+    b->regions[b->nregions++] = *proto;
+    for (uint32_t p = p0; p <= p1; p++)
+        b->page_region[p] = (uint8_t)b->nregions;
+
+    // RAM pages under the new window must stop taking mem.c's fast path.
+    mem_mmio_changed();
+    return true;
+}
+
+void hw_bus_init(void) {
+    hw_bus_map* b = g_hw->bus;
+    for (int i = 0; i < b->ndevs; i++) hw_event_cancel(&b->devs[i]->ev);
+    b->ndevs = 0;
+    b->nregions = 0;
+    memset(b->page_region, 0, sizeof b->page_region);
+    mem_mmio_changed();
 }
 
 bool hw_bus_attach(HWDevice* d) {
-    if (g_ndevs >= MAX_DEVS) return false;
-    for (int i = 0; i < g_ndevs; i++) {
-        uint32_t a0 = g_devs[i]->base, a1 = a0 + g_devs[i]->size;
-        uint32_t b0 = d->base,         b1 = b0 + d->size;
-        if (overlaps(a0, a1, b0, b1)) return false;
+    hw_bus_map* b = g_hw->bus;
+    if (b->ndevs >= MAX_DEVS) return false;
+    Region r = { .base = d->base, .size = d->size, .kind = REGION_HWDEV,
+                 .name = d->name ? d->name(d) : NULL, .dev = d };
+    if (!region_add(&r)) return false;
+    b->devs[b->ndevs++] = d;
+
+    hw_event_init(&d->ev, dev_tick_event, d);
+    d->last_tick = g_hw->now;
+    if (d->tick && d->period) hw_event_schedule(&d->ev, d->period);
+    return true;
+}
+
+void hw_bus_reset(void) {
+    hw_bus_map* b = g_hw->bus;
+    for (int i = 0; i < b->ndevs; i++)
+        if (b->devs[i]->reset) b->devs[i]->reset(b->devs[i]);
+}
+
+bool hw_bus_map_mmio(const char* name, uint32_t base, uint32_t size,
+                     vm_mmio_read_fn rfn, vm_mmio_write_fn wfn, void* ctx) {
+    Region r = { .base = base, .size = size, .kind = REGION_CTX, .name = name,
+                 .ctx_read = rfn, .ctx_write = wfn, .ctx = ctx };
+    return region_add(&r);
+}
+
+bool hw_bus_map_region(const char* name, uint32_t base, uint32_t size,
+                       uint32_t (*read32)(uint32_t addr),
+                       void (*write32)(uint32_t addr, uint32_t value)) {
+    Region r = { .base = base, .size = size, .kind = REGION_PLAIN, .name = name,
+                 .plain_read = read32, .plain_write = write32 };
+    if (!region_add(&r)) {
+        fprintf(stderr, "[HW] %s: cannot map 0x%08X+0x%X\n", name ? name : "?", base, size);
+        return false;
     }
-    g_devs[g_ndevs++] = d;
     return true;
 }
 
-static HWDevice* find(uint32_t addr, uint32_t* off_out) {
-    for (int i = 0; i < g_ndevs; i++) {
-        HWDevice* d = g_devs[i];
-        if (addr - d->base < d->size) {
-            *off_out = addr - d->base;
-            return d;
-        }
+bool hw_bus_is_mmio(uint32_t addr) {
+    return region_at(addr) != NULL;
+}
+
+bool hw_bus_range_mapped(uint32_t addr, size_t len) {
+    if (!len) return false;
+    const hw_bus_map* b = g_hw->bus;
+    uint64_t end = (uint64_t)addr + len - 1u;
+    if (end > 0xFFFFFFFFull) end = 0xFFFFFFFFull;
+    uint32_t p1 = (uint32_t)(end >> HW_BUS_PAGE_SHIFT);
+    for (uint32_t p = addr >> HW_BUS_PAGE_SHIFT; p <= p1; p++) {
+        uint8_t r = b->page_region[p];
+        if (!r) continue;
+        const Region* g = &b->regions[r - 1];
+        uint64_t g_end = (uint64_t)g->base + g->size;
+        if (g->base <= end && addr < g_end) return true;
     }
-    return NULL;
+    return false;
 }
 
 bool hw_bus_read32(uint32_t addr, uint32_t* out) {
-    uint32_t off; HWDevice* d = find(addr, &off);
-    if (!d || !d->read32) return false;
-    *out = d->read32(d, off & ~3u);
-    return true;
+    const Region* g = region_at(addr);
+    if (!g) return false;
+    addr &= ~3u;
+    g_hw->reads++;
+    switch (g->kind) {
+        case REGION_HWDEV:
+            if (!g->dev->read32) return false;
+            hw_read_volatile();     // state may lag until its next tick()
+            *out = g->dev->read32(g->dev, addr - g->base);
+            return true;
+        case REGION_CTX:
+            if (!g->ctx_read) return false;
+            *out = g->ctx_read(g->ctx, addr);
+            return true;
+        case REGION_PLAIN:
+            if (!g->plain_read) return false;
+            *out = g->plain_read(addr);
+            return true;
+    }
+    return false;
 }
 
 bool hw_bus_write32(uint32_t addr, uint32_t val) {
-    uint32_t off; HWDevice* d = find(addr, &off);
-    if (!d || !d->write32) return false;
-    d->write32(d, off & ~3u, val);
-    return true;
-}
-
-/**
- * Drive all devices once per CPU instruction.
- * We translate CPU cycles to device “byte budgets”.
- * You can refine this: per-device type tags, hz ratios, etc.
- */
-void hw_bus_tick(int cycles) {
-    if (cycles <= 0) cycles = 1;
-
-    for (int i = 0; i < g_ndevs; i++) {
-        HWDevice* d = g_devs[i];
-        if (!d->tick) continue;
-
-        // crude classification based on name() prefix; you can instead
-        // add a 'kind' enum into HWDevice if you prefer.
-        int budget = 0;
-        const char* nm = d->name ? d->name(d) : "";
-
-        if (nm && nm[0]) {
-            if      (nm[0]=='d' && nm[1]=='i' && nm[2]=='s' && nm[3]=='k') budget = g_disk_bpc * cycles;
-            else if (nm[0]=='u' && nm[1]=='a' && nm[2]=='r' && nm[3]=='t') budget = g_uart_bpc * cycles;
-            else if (nm[0]=='c' && nm[1]=='r' && nm[2]=='t')               budget = g_crt_bpc  * cycles;
-            else                                                            budget = 0; // unknown device kind
-        } else {
-            budget = 0;
-        }
-
-        if (budget > 0) d->tick(d, budget);
+    const Region* g = region_at(addr);
+    if (!g) return false;
+    addr &= ~3u;
+    switch (g->kind) {
+        case REGION_HWDEV:
+            if (!g->dev->write32) return false;
+            g->dev->write32(g->dev, addr - g->base, val);
+            return true;
+        case REGION_CTX:
+            if (!g->ctx_write) return false;
+            g->ctx_write(g->ctx, addr, val);
+            return true;
+        case REGION_PLAIN:
+            if (!g->plain_write) return false;
+            g->plain_write(addr, val);
+            return true;
     }
+    return false;
 }
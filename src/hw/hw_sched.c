@@ -0,0 +1,120 @@
+// src/hw/hw_sched.c — guest-cycle event scheduler
+// Binary min-heap of armed events keyed by (deadline, arming order), one per
+// VM (hw_ctx). The CPU side only ever looks at g_hw->next; the heap is touched
+// when an event is armed, cancelled or due.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "hw.h"
+
+
+static inline bool ev_before(const hw_event* a, const hw_event* b) {
+    return a->when != b->when ? a->when < b->when : a->seq < b->seq;
+}
+
+static inline void heap_put(int i, hw_event* ev) {
+    g_hw->heap[i] = ev;
+    ev->slot = i;
+}
+
+static void sift_up(int i) {
+    hw_event* ev = g_hw->heap[i];
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (!ev_before(ev, g_hw->heap[p])) break;
+        heap_put(i, g_hw->heap[p]);
+        i = p;
+    }
+    heap_put(i, ev);
+}
+
+static void sift_down(int i) {
+    hw_event* ev = g_hw->heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= g_hw->n_events) break;
+        if (c + 1 < g_hw->n_events && ev_before(g_hw->heap[c + 1], g_hw->heap[c])) c++;
+        if (!ev_before(g_hw->heap[c], ev)) break;
+        heap_put(i, g_hw->heap[c]);
+        i = c;
+    }
+    heap_put(i, ev);
+}
+
+static inline void update_next(void) {
+    g_hw->next = g_hw->n_events ? g_hw->heap[0]->when : UINT64_MAX;
+}
+
+static void heap_remove(hw_event* ev) {
+    int i = ev->slot;
+    hw_event* last = g_hw->heap[--g_hw->n_events];
+    ev->slot = -1;
+    if (last != ev) {
+        heap_put(i, last);
+        sift_up(i);
+        sift_down(last->slot);
+    }
+}
+
+void hw_event_init(hw_event* ev, hw_event_fn fn, void* ctx) {
+    ev->when = 0;
+    ev->seq  = 0;
+    ev->fn   = fn;
+    ev->ctx  = ctx;
+    ev->slot = -1;
+}
+
+void hw_event_schedule(hw_event* ev, uint64_t delay) {
+    if (ev->slot >= 0) heap_remove(ev);
+    if (g_hw->n_events >= HW_SCHED_MAX) {
+        fprintf(stderr, "[HW] event queue full, event dropped\n");
+        update_next();
+        return;
+    }
+    ev->when = (delay > UINT64_MAX - g_hw->now) ? UINT64_MAX : g_hw->now + delay;
+    ev->seq  = g_hw->seq++;
+    heap_put(g_hw->n_events++, ev);
+    sift_up(ev->slot);
+    update_next();
+}
+
+void hw_event_cancel(hw_event* ev) {
+    if (ev->slot < 0) return;
+    heap_remove(ev);
+    update_next();
+}
+
+void hw_sched_run(void) {
+    // Handlers may arm or cancel events (including themselves); anything they
+    // arm with delay 0 fires in this same pass.
+    while (g_hw->n_events && g_hw->heap[0]->when <= g_hw->now) {
+        hw_event* ev = g_hw->heap[0];
+        heap_remove(ev);
+        update_next();
+        if (ev->fn) ev->fn(ev->ctx);
+    }
+    update_next();
+}
+
+void hw_sched_set_now(uint64_t now) {
+    // A uniform shift keeps the heap ordered.
+    for (int i = 0; i < g_hw->n_events; i++) {
+        hw_event* ev = g_hw->heap[i];
+        uint64_t left = ev->when > g_hw->now ? ev->when - g_hw->now : 0;
+        ev->when = (left > UINT64_MAX - now) ? UINT64_MAX : now + left;
+    }
+    g_hw->now = now;
+    update_next();
+}
+
+void hw_sched_idle(void) {
+    if (g_hw->irq || g_hw->next == UINT64_MAX) return;
+    if (g_hw->next > g_hw->now + 1u) g_hw->now = g_hw->next - 1u;
+}
+
+void hw_irq_kick(void) {
+    // Due now: the threaded loop sees g_hw->next move and ends the block.
+    hw_event_schedule(&g_hw->irq_kick, 0);
+}
@@ -7,4 +7,6 @@ void handle_umlal(uint32_t instr);
 void handle_smull(uint32_t instr);
 void handle_smlal(uint32_t instr);
 void handle_mul(uint32_t instr);
-void handle_mla(uint32_t instr);
\ No newline at end of file
+void handle_mla(uint32_t instr);
+void handle_udiv(uint32_t instr);
+void handle_sdiv(uint32_t instr);
@@ -0,0 +1,13 @@
+// src/include/batch.h — parallel batch runner
+#pragma once
+#include <stdbool.h>
+
+// Runs every job in the manifest on a pool of worker threads (one fresh VM
+// per job) and writes one JSON object per job, in manifest order, to
+// out_path (NULL = summary only). threads <= 0 uses one per host CPU.
+// Returns the number of jobs that failed, or -1 if the manifest is unusable.
+int batch_run(const char *manifest, const char *out_path, int threads);
+
+// "batch <manifest> [out <file>] [threads <n>] [tcache <dir>]" for the CLI
+// and main(); tcache sets vm_tcache_default_dir() for the jobs' VMs.
+int batch_main(int argc, char **argv);
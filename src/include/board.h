@@ -5,4 +5,7 @@
 #define RAM_BASE   0x00000000u
 
 // Place DTB at a safe, aligned spot in RAM (8-byte aligned)
-#define DTB_ADDR   0x00040000u  // 256 KiB into RAM
\ No newline at end of file
+#define DTB_ADDR   0x00040000u  // 256 KiB into RAM
+
+// PL011-ish console UART (the tests print through it)
+#define UART0_BASE 0x09000000u
@@ -2,4 +2,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-bool evaluate_condition(uint8_t cond);
\ No newline at end of file
+bool evaluate_condition(uint8_t cond);
+
+// Row per cond, bit per NZCV nibble (CPSR[31:28]): the same answers as
+// evaluate_condition() for a caller that already has the flags in hand
+// (cpsr_nzcv() in cpu_flags.h).
+extern const uint16_t g_cond_pass[16];
+
+static inline bool cond_passed(uint8_t cond, uint32_t nzcv) {
+    return (g_cond_pass[cond & 0xFu] >> (nzcv & 0xFu)) & 1u;
+}
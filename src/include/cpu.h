@@ -27,17 +27,29 @@ typedef struct {
     uint32_t r[16];      // R0..R15 (R15=PC)
     uint32_t cpsr;       // Current PSR
     uint32_t spsr;       // Saved PSR (if you use it for mode changes)
-    bool          halted;       // VM is stopped at a trap/breakpoint/etc
+    bool          halted;       // run/stop latch (cpu_halt/cpu_is_halted)
     halt_reason_t halt_reason;  // why it stopped
     uint32_t npc;     // next PC (fall-through or branch target)
+    // Lazy NZCV (see cpu_flags.h): last flag-setting ALU op, folded into
+    // cpsr[31:28] when something reads the flags. lf_op == 0: cpsr is current.
+    uint8_t  lf_op;
+    uint32_t lf_a, lf_b, lf_res, lf_c;
     // banked SVC (if you use them)
     uint32_t spsr_svc;
     uint32_t lr_svc;
     uint32_t sp_svc;
+    // IRQ mode's r13/r14/SPSR (other modes share r[13]/r[14]/spsr). Swapped
+    // with those on entering or leaving IRQ mode, so while in IRQ mode they
+    // hold the shared set.
+    uint32_t sp_irq;
+    uint32_t lr_irq;
+    uint32_t spsr_irq;
 } CPU;
 
-extern CPU cpu;          // single global CPU instance (for now)
-extern uint64_t cycle;
+// CPU of the VM currently running on this thread: vm_step/vm_run copy the
+// VM's CPU in and back out around execution.
+extern VM_TLS CPU cpu;
+extern VM_TLS uint64_t cycle;
 
 uint32_t arm_read_src_reg(int r);
 
@@ -71,12 +83,11 @@ uint32_t arm_read_src_reg(int r);
 #define CPSR_F   BIT(6)
 #define CPSR_T   BIT(5)
 #define CPSR_MODE_MASK 0x1Fu
+#define CPSR_MODE_IRQ  0x12u
+#define CPSR_MODE_SVC  0x13u
 
-// ---------------- Global run-state (temporary; will move into VM) ----------------
-extern uint64_t    cycle;       // global cycle counter
-extern bool        cpu_halted;  // run/stop latch
-
-extern debug_flags_t debug_flags;  // <-- fixed type
+// ---------------- Run-state ----------------
+extern VM_TLS debug_flags_t debug_flags;
 extern bool          trace_all;
 
 // ---------------- CPU API ----------------
@@ -104,8 +115,48 @@ void cpu_clear_halt(void);   // clear halt flag (on reset)
 bool cpu_is_halted(void);    // query halt state
 void cpu_step(void);          // <-- add this prototype
 
+// Run loop selection (`set cpu engine=`), per VM: vm_set_engine() stores
+// it and vm_activate() binds it to the thread. Build with
+// -DCPU_ENGINE_THREADED to make the threaded loop the default for new VMs.
+typedef enum {
+    CPU_ENGINE_STEP = 0,         // cpu_step() per instruction
+    CPU_ENGINE_THREADED_LOOP     // cpu_run_threaded() over predecoded blocks
+} cpu_engine_t;
+
+#if defined(CPU_ENGINE_THREADED)
+#define CPU_ENGINE_DEFAULT CPU_ENGINE_THREADED_LOOP
+#else
+#define CPU_ENGINE_DEFAULT CPU_ENGINE_STEP
+#endif
+
+void         cpu_set_engine(cpu_engine_t e);   // this thread's active VM
+cpu_engine_t cpu_get_engine(void);
+
+// Run up to max_instrs instructions (0 = until halt); returns the count run.
+// Caller must make sure no per-instruction debug output is wanted.
+uint64_t cpu_run_threaded(uint64_t max_instrs);
+
+// Longest block the threaded loop watches as a possible idle polling loop.
+#define CPU_IDLE_MAX_OPS 8u
+
 void cpu_exception_return(uint32_t new_pc);
 
+// Install a new CPSR (mode/mask changes included): swaps the IRQ bank when
+// entering or leaving IRQ mode, and if it unmasks a pending IRQ has the run
+// loop take it after the current instruction. Pending lazy NZCV must have
+// been folded by the caller if value replaces the flags.
+void cpu_write_cpsr(uint32_t value);
+
+// IRQ exception entry at the boundary before cpu.r[15]: IRQ mode, I set,
+// LR_irq = cpu.r[15] + 4, vector 0x18. The run loops call it when the
+// interrupt controller's line is up and CPSR.I is clear.
+void cpu_take_irq(void);
+
+// Bring the device clock up to the instruction executing now; the threaded
+// loop otherwise only accounts cycles at block ends. mem.c calls it before
+// MMIO accesses so devices see the same time on every engine.
+void cpu_sync_clock(void);
+
 // (Optional compatibility: if other files still call dump_registers())
 void dump_registers(void);  // provide wrapper in cpu.c
 #ifdef __cplusplus
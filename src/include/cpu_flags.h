@@ -4,17 +4,93 @@
 #include "arm-vm.h"
 #include "log.h"
 
-extern CPU cpu;
+extern VM_TLS CPU cpu;
 
-static inline uint32_t cpsr_get_C(void) { return (cpu.cpsr >> 29) & 1u; }
-static inline uint32_t cpsr_get_V(void) { return (cpu.cpsr >> 28) & 1u; }
+// --- Lazy condition flags ----------------------------------------------------
+// With CPU_LAZY_FLAGS the ALU handlers only record their operands, result and
+// carry (cpsr_flags_add/sub/logic); N, Z and V are worked out when something
+// reads them: conditions, MRS/MSR, exception entry/return, and the VM copying
+// the CPU state back out. Bits other than NZCV in cpu.cpsr are always current.
+// Build with -DCPU_LAZY_FLAGS=0 to pack flags on every S instruction instead.
+#ifndef CPU_LAZY_FLAGS
+#define CPU_LAZY_FLAGS 1
+#endif
+
+enum {
+    LF_NONE = 0,    // cpu.cpsr holds the flags
+    LF_LOGIC,       // N,Z from res; C = lf_c; V unchanged
+    LF_ADD,         // ... V = add overflow of lf_a + lf_b
+    LF_SUB          // ... V = sub overflow of lf_a - lf_b
+};
+
+static inline uint32_t lf_overflow(uint8_t op, uint32_t a, uint32_t b, uint32_t res, uint32_t v_old) {
+    switch (op) {
+    case LF_ADD: return (~(a ^ b) & (a ^ res)) >> 31;
+    case LF_SUB: return ( (a ^ b) & (a ^ res)) >> 31;
+    default:     return v_old;
+    }
+}
+
+static inline uint32_t lf_pack(uint8_t op, uint32_t a, uint32_t b, uint32_t res, uint32_t c, uint32_t v_old) {
+    return ((res >> 31) << 3) | ((uint32_t)(res == 0) << 2) | ((c & 1u) << 1)
+         | lf_overflow(op, a, b, res, v_old);
+}
+
+// NZCV as a nibble (N = bit 3), without committing it to cpu.cpsr.
+static inline uint32_t cpsr_nzcv(void) {
+#if CPU_LAZY_FLAGS
+    if (cpu.lf_op != LF_NONE)
+        return lf_pack(cpu.lf_op, cpu.lf_a, cpu.lf_b, cpu.lf_res, cpu.lf_c, (cpu.cpsr >> 28) & 1u);
+#endif
+    return cpu.cpsr >> 28;
+}
+
+// Fold any pending flags into cpu.cpsr. Call before reading or writing NZCV
+// through cpu.cpsr directly.
+static inline void cpu_flags_sync(void) {
+#if CPU_LAZY_FLAGS
+    if (cpu.lf_op != LF_NONE) {
+        cpu.cpsr = (cpu.cpsr & 0x0FFFFFFFu) | (cpsr_nzcv() << 28);
+        cpu.lf_op = LF_NONE;
+    }
+#endif
+}
+
+static inline void lf_record(uint8_t op, uint32_t a, uint32_t b, uint32_t res, uint32_t c) {
+#if CPU_LAZY_FLAGS
+    cpu.lf_op = op; cpu.lf_a = a; cpu.lf_b = b; cpu.lf_res = res; cpu.lf_c = c & 1u;
+#else
+    cpu.cpsr = (cpu.cpsr & 0x0FFFFFFFu) | (lf_pack(op, a, b, res, c, (cpu.cpsr >> 28) & 1u) << 28);
+#endif
+}
+
+// res = a + b (+carry folded into b); c = carry out
+static inline void cpsr_flags_add(uint32_t a, uint32_t b, uint32_t res, uint32_t c) { lf_record(LF_ADD, a, b, res, c); }
+// res = a - b (+borrow folded into b); c = NOT borrow
+static inline void cpsr_flags_sub(uint32_t a, uint32_t b, uint32_t res, uint32_t c) { lf_record(LF_SUB, a, b, res, c); }
+// N,Z from res; c = shifter carry out; V kept
+static inline void cpsr_flags_logic(uint32_t res, uint32_t c) {
+#if CPU_LAZY_FLAGS
+    if (cpu.lf_op > LF_LOGIC) cpu_flags_sync();   // keep the pending op's V
+#endif
+    lf_record(LF_LOGIC, 0, 0, res, c);
+}
+
+static inline uint32_t cpsr_get_C(void) {
+#if CPU_LAZY_FLAGS
+    if (cpu.lf_op != LF_NONE) return cpu.lf_c;
+#endif
+    return (cpu.cpsr >> 29) & 1u;
+}
+static inline uint32_t cpsr_get_V(void) { return cpsr_nzcv() & 1u; }
 
 static inline void cpsr_set_NZ(uint32_t result) {
+    cpu_flags_sync();
     if (result & 0x80000000u) cpu.cpsr |=  BIT(31); else cpu.cpsr &= ~BIT(31);
     if (result == 0)           cpu.cpsr |=  BIT(30); else cpu.cpsr &= ~BIT(30);
 }
-static inline void cpsr_set_C_from(uint32_t c) { if (c) cpu.cpsr |= BIT(29); else cpu.cpsr &= ~BIT(29); }
-static inline void cpsr_set_V(uint32_t v)      { if (v) cpu.cpsr |= BIT(28); else cpu.cpsr &= ~BIT(28); }
+static inline void cpsr_set_C_from(uint32_t c) { cpu_flags_sync(); if (c) cpu.cpsr |= BIT(29); else cpu.cpsr &= ~BIT(29); }
+static inline void cpsr_set_V(uint32_t v)      { cpu_flags_sync(); if (v) cpu.cpsr |= BIT(28); else cpu.cpsr &= ~BIT(28); }
 static inline uint32_t cpsr_mode(void){ return cpu.cpsr & CPSR_MODE_MASK; }
 static inline int is_user_mode(void){ return (cpsr_mode() == 0x10u); }
 
@@ -22,15 +98,19 @@ static inline int is_user_mode(void){ return (cpsr_mode() == 0x10u); }
 #include "cpu.h"   // needs CPU cpu and CPSR_* masks
 
 static inline void cpu_set_flag_N(bool v) {
+    cpu_flags_sync();
     if (v) cpu.cpsr |=  CPSR_N; else cpu.cpsr &= ~CPSR_N;
 }
 static inline void cpu_set_flag_Z(bool v) {
+    cpu_flags_sync();
     if (v) cpu.cpsr |=  CPSR_Z; else cpu.cpsr &= ~CPSR_Z;
 }
 static inline void cpu_set_flag_C(bool v) {
+    cpu_flags_sync();
     if (v) cpu.cpsr |=  CPSR_C; else cpu.cpsr &= ~CPSR_C;
 }
 static inline void cpu_set_flag_V(bool v) {
+    cpu_flags_sync();
     if (v) cpu.cpsr |=  CPSR_V; else cpu.cpsr &= ~CPSR_V;
 }
 void psr_write(uint32_t *psr, uint32_t value, uint32_t fields, int is_cpsr);
\ No newline at end of file
@@ -2,6 +2,7 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
+#include "vm_tls.h"
 
 // Bitmask type for debug flags
 typedef uint32_t debug_flags_t;
@@ -19,10 +20,12 @@ enum {
 	DBG_K12       = 1u << 7,   // NEW: K12 decode trace (aka KEY12)
 	DBG_TRACE     = 1u << 8,
 	DBG_CLI       = 1u << 9,
+	DBG_K12STATS  = 1u << 10,  // count K12 decoder work (not logging: not in ALL)
 };
 
 #define DBG_ALL (DBG_INSTR|DBG_MEM_READ|DBG_MEM_WRITE|DBG_MMIO|DBG_DISK|DBG_IRQ|DBG_DISASM|DBG_K12|DBG_TRACE|DBG_CLI)
 
-// These are defined in some .c (e.g., cpu.c for debug_flags, or elsewhere)
-extern debug_flags_t debug_flags;
+// These are defined in debug_globals.c. debug_flags follows the VM running
+// on this thread (vm_activate); trace_all is process-wide.
+extern VM_TLS debug_flags_t debug_flags;
 extern bool          trace_all;
@@ -4,21 +4,30 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "vm.h"
+#include "snapshot.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define DISK0_BASE 0x0B000000u
-// regs: +0x00 CMD (1=read one sector), +0x04 LBA, +0x08 DST, +0x0C STATUS (1=busy/0=ready)
+// regs: +0x04 LBA, +0x08 COUNT, +0x0C CMD, +0x10 STATUS (1=busy 2=drq 4=err),
+//       +0x14 DMA buffer address, +0x200 512-byte PIO data window
+// CMD:  0x81 = PIO read one sector into the window
+//       0x85 / 0x86 = DMA read / write COUNT sectors at the DMA address;
+//       STATUS stays BUSY until the transfer completes, then reads 0 (or ERR)
 
 bool dev_disk0_attach(VM *vm, const char *image_path); // maps MMIO (if not already) and attaches image
+bool dev_disk0_attach_overlay(VM *vm, const char *base_path, const char *delta_path); // read-only base + COW delta
 bool dev_disk0_present(void);
 
 bool     dev_disk0_present(void);
 uint32_t dev_disk0_read_reg(uint32_t addr);
 void     dev_disk0_write_reg(uint32_t addr, uint32_t val);
 
+void     dev_disk0_snapshot_save(snap_io *s);
+bool     dev_disk0_snapshot_load(snap_io *s);
+
 #ifdef __cplusplus
 }
 #endif
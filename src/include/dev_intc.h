@@ -0,0 +1,46 @@
+// src/include/dev_intc.h — GIC-lite interrupt controller
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "snapshot.h"
+
+// 32 interrupt lines into one CPU IRQ. A line is pending while its device
+// holds it high (level) or after a raise/PEND_SET until acknowledged (edge).
+// Reading IAR takes the lowest-numbered pending, enabled line and marks it
+// active; writing its number to EOIR ends it. While any line is active no
+// further IRQ is signalled (no preemption).
+//
+// Register map (byte offsets from INTC_BASE_ADDR)
+//  0x00: CTRL       (RW) bit0=ENABLE (forward to the CPU)
+//  0x04: TYPE       (RO) number of lines
+//  0x08: PENDING    (RO) pending lines (level | latched)
+//  0x0C: ACTIVE     (RO) acknowledged, not yet ended
+//  0x10: ENABLE_SET (RW) write 1s to enable lines; reads the enable mask
+//  0x14: ENABLE_CLR (RW) write 1s to disable lines; reads the enable mask
+//  0x18: PEND_SET   (WO) write 1s to latch lines pending (software IRQ)
+//  0x1C: PEND_CLR   (WO) write 1s to drop latched lines
+//  0x20: IAR        (RO) acknowledge: line number, INTC_SPURIOUS if none
+//  0x24: EOIR       (WO) end of interrupt: line number
+#define INTC_BASE_ADDR  0xF0004000u
+#define INTC_MMIO_SIZE  0x100u
+
+#define INTC_LINES      32u
+#define INTC_SPURIOUS   0x3FFu
+
+// Line assignments
+#define IRQ_TIMER0      0u       // dev_timer.c (level)
+#define IRQ_DISK0       1u       // dev_disk.c DMA done (edge)
+
+void     dev_intc_init(uint32_t base_addr);   // maps the window on the bus
+
+// Device side
+void     dev_intc_set_level(unsigned line, bool high);
+void     dev_intc_raise(unsigned line);       // edge: pending until IAR
+
+// MMIO handlers
+uint32_t dev_intc_read32(uint32_t addr);
+void     dev_intc_write32(uint32_t addr, uint32_t value);
+
+// Snapshot state (vm_snapshot_save/load)
+void     dev_intc_snapshot_save(snap_io* s);
+bool     dev_intc_snapshot_load(snap_io* s);
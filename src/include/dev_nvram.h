@@ -1,5 +1,7 @@
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
+#include "snapshot.h"
 
 #define NVRAM_BASE_ADDR  0xF0003000u
 #define NVRAM_MMIO_SIZE  0x100u
@@ -12,6 +14,11 @@
 #define NVRAM_OFF_BOOT_ORDER  0x00u  // 0:DISK, 1:NET, 2:CD (tweak as you like)
 #define NVRAM_CAPACITY        256u
 
+// backing_path NULL or "": contents live in memory only, starting blank.
 void     dev_nvram_init(const char *backing_path);
 uint32_t dev_nvram_read32(uint32_t addr);
-void     dev_nvram_write32(uint32_t addr, uint32_t value);
\ No newline at end of file
+void     dev_nvram_write32(uint32_t addr, uint32_t value);
+
+// Snapshot state (vm_snapshot_save/load)
+void     dev_nvram_snapshot_save(snap_io *s);
+bool     dev_nvram_snapshot_load(snap_io *s);
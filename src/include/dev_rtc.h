@@ -1,6 +1,8 @@
 // src/include/dev_rtc.h
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
+#include "snapshot.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +34,10 @@ uint32_t dev_rtc_read32(uint32_t addr);
 void     dev_rtc_write32(uint32_t addr, uint32_t value);
 void     dev_rtc_init(uint32_t base_addr);
 
+// Snapshot state (vm_snapshot_save/load)
+void     dev_rtc_snapshot_save(snap_io* s);
+bool     dev_rtc_snapshot_load(snap_io* s);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+// src/include/dev_timer.h — periodic / one-shot timer on the guest clock
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "snapshot.h"
+
+// Counts guest cycles (hw_bus_now()). When enabled it expires LOAD cycles
+// after being started, sets STATUS.EXPIRED and, with CTRL.IRQ_EN, holds
+// IRQ_TIMER0 high until the guest clears STATUS. Periodic mode restarts the
+// count at every expiry; one-shot mode clears CTRL.ENABLE.
+//
+// Register map (byte offsets from TIMER_BASE_ADDR)
+//  0x00: LOAD       (RW) interval in guest cycles; writing restarts a running timer
+//  0x04: VALUE      (RO) cycles left until expiry, 0 when stopped
+//  0x08: CTRL       (RW) bit0=ENABLE, bit1=PERIODIC, bit2=IRQ_EN
+//  0x0C: STATUS     (RW) bit0=EXPIRED; write 1 to clear
+//  0x10: NOW_LO     (RO) guest cycle counter, low word
+//  0x14: NOW_HI     (RO) guest cycle counter, high word
+#define TIMER_BASE_ADDR  0xF0005000u
+#define TIMER_MMIO_SIZE  0x100u
+
+#define TIMER_CTRL_ENABLE    (1u << 0)
+#define TIMER_CTRL_PERIODIC  (1u << 1)
+#define TIMER_CTRL_IRQ_EN    (1u << 2)
+#define TIMER_STATUS_EXPIRED (1u << 0)
+
+void     dev_timer_init(uint32_t base_addr);  // maps the window on the bus
+
+// MMIO handlers
+uint32_t dev_timer_read32(uint32_t addr);
+void     dev_timer_write32(uint32_t addr, uint32_t value);
+
+// Snapshot state (vm_snapshot_save/load)
+void     dev_timer_snapshot_save(snap_io* s);
+bool     dev_timer_snapshot_load(snap_io* s);
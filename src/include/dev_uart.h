@@ -2,6 +2,7 @@
 #pragma once
 #include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 
 // PL011-ish offsets used by the tests
 #define UART_DR        0x00u
@@ -9,12 +10,20 @@
 #define UART_FR_TXFF   (1u << 5)  // TX FIFO full
 #define UART_FR_RXFE   (1u << 4)  // RX FIFO empty
 
-// Init once at startup with the MMIO base (tests use 0x0900_0000)
+#define UART_MMIO_SIZE 0x1000u
+
+// Init once at startup with the MMIO base (tests use 0x0900_0000); maps the
+// window on the bus
 void     dev_uart_init(uint32_t base);
 
-// Present flag for mem.c dispatch
+// True once the window is mapped
 bool     dev_uart_present(void);
 
-// 32-bit register access used by mem.c (it may RMW for byte writes)
+// Send TX bytes to buf (NUL-terminated, excess dropped) instead of stdout;
+// NULL restores stdout. dev_uart_captured() is the byte count so far.
+void     dev_uart_set_capture(char *buf, size_t size);
+size_t   dev_uart_captured(void);
+
+// 32-bit register access (mem.c may RMW for byte writes)
 uint32_t dev_uart_read_reg(uint32_t addr);
 void     dev_uart_write_reg(uint32_t addr, uint32_t val);
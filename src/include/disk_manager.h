@@ -20,12 +20,26 @@ typedef struct {
     bool     present;
     bool     readonly;
     char     path[260];
-    uint8_t *img;          // entire image in host RAM
+    bool     mapped;       // img is an mmap() of the file (else malloc'd copy)
+    uint8_t *img;          // whole image; mapped images page in on demand
     size_t   size_bytes;
+
+    // Copy-on-write overlay: img is the read-only base, writes go to the
+    // delta file and reads prefer it for sectors set in cow_bitmap.
+    uint8_t *cow;          // whole delta mapping, NULL if not an overlay
+    size_t   cow_size;
+    uint8_t *cow_bitmap;
+    uint8_t *cow_data;
+    char     cow_path[260];
 } DiskSlot;
 
 void   disk_init(void);
+void   disk_shutdown(void);          // detach every slot (VM teardown)
+// A writable slot writes guest sectors straight back into the image file
+// (where mmap is available); if the file cannot be opened for writing, or
+// on hosts without mmap, writes only change the in-memory copy.
 bool   disk_attach(int slot, const char *path, bool readonly);
+bool   disk_attach_overlay(int slot, const char *base_path, const char *delta_path); // creates delta if missing
 bool   disk_detach(int slot);
 
 bool   disk_present(int slot);
@@ -0,0 +1,21 @@
+// src/include/dp_variants.h — specialized data-processing handlers
+#pragma once
+#include <stdint.h>
+#include "execute.h"   // insn_handler_t
+
+// Per-shape variants of the 16 DP opcodes, chosen once at predecode so the
+// handler does no Operand2 decoding at run time. Shapes:
+//   imm       #imm8, no rotation        (C unchanged)
+//   imm_rot   #imm8, rotated            (C = bit 31)
+//   reg       Rm (LSL #0)               (C unchanged)
+//   reg_shift Rm, <shift> #n            (C from the shifter)
+//   reg_reg   Rm, <shift> Rs            (C from the shifter unless Rs[7:0] == 0)
+// S=0 variants leave the flags alone, except TST/TEQ/CMP/CMN, which set
+// them either way (as dp_exec() does); flag-setting variants only compute
+// the shifter carry for the logical ops that consume it.
+//
+// Returns NULL for words the generic handler must keep: Rd == PC (branch /
+// exception-return semantics), or PC as Rn, Rm or Rs (PC+8 reads).
+// Results match the generic alu.c/logic.c handlers (which use dp_operand2())
+// for every word this accepts.
+insn_handler_t dp_variant(uint32_t instr);
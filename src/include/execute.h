@@ -1,4 +1,61 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
-bool execute(uint32_t instr);
\ No newline at end of file
+
+typedef void (*insn_handler_t)(uint32_t instr);
+
+// How a predecoded op is dispatched by the run loops.
+enum {
+    K12_OP_PLAIN = 0,           // always runs (AL/0xF cond, or rule ignores cond)
+    K12_OP_COND,                // evaluate_condition(cond) first
+    K12_OP_B,                   // B<cond>: npc = pc + imm, no handler call
+    // Fused with the op after it (execute_fuse()); threaded loop only
+    K12_OP_MOVWT,               // MOVW+MOVT Rd: Rd = imm
+    K12_OP_CMPB,                // CMP Rn,#imm + B<cond>
+    K12_OP_LDRADD,              // LDR Rd,[Rn,#x] + ADD Rn,Rn,#imm
+    K12_OP_KINDS
+};
+
+// Predecoded instruction: the K12 rule resolved once (xmask32 included),
+// so replaying it costs a cond check plus the handler call.
+typedef struct {
+    insn_handler_t fn;          // resolved handler
+    uint32_t       instr;       // raw word (handlers still take it)
+    uint16_t       rule;        // index into K12_TABLE (for logs)
+    uint8_t        cond;        // bits 31:28
+    uint8_t        rn, rd, rm;  // bits 19:16, 15:12, 3:0
+    uint8_t        kind;        // K12_OP_*
+    int32_t        imm;         // K12_OP_B: branch offset from the insn (+8 folded in);
+                                // fused kinds: the pair's constant (see above)
+    bool           ends_block;  // branch/trap class: stop predecoding here
+    bool           reads_only;  // loads/ALU/B: writes nothing but registers and NZCV
+} k12_op;
+
+bool execute(uint32_t instr);
+
+// Resolve instr to its K12 rule without executing it (no cond, no logs).
+// Returns false if no rule matches; execute() would halt on such a word.
+bool execute_decode(uint32_t instr, k12_op *out);
+
+// Mark first as a superinstruction when it and second (the op right after
+// it) form a fused pair. Both ops keep their fn/instr, so anything that
+// runs them one at a time -- or enters at second -- is unaffected.
+void execute_fuse(k12_op *first, const k12_op *second);
+
+// Same for a word already known to resolve to rule (a K12_TABLE index, as
+// saved in out->rule). Returns false if that rule does not match instr.
+bool execute_decode_rule(uint32_t instr, uint16_t rule, k12_op *out);
+
+// Fingerprint of the rule table: saved rule indices are only meaningful to
+// a build whose hash matches.
+uint64_t execute_rules_hash(void);
+
+// Rule name for logs ("?" if out of range).
+const char *execute_rule_name(uint16_t rule);
+
+// Decoder statistics gathered while DBG_K12STATS is set: hits and
+// cond-fails per rule, lookups and candidates walked per key12 bucket, and
+// buckets whose candidate list was cut at MAX_PER_KEY. Process-wide.
+void execute_stats_reset(void);
+void execute_stats_report(unsigned top);        // top-n via log_printf()
+bool execute_stats_csv(const char *path);       // every rule + used bucket
@@ -2,6 +2,8 @@
 #pragma once
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include "vm_tls.h"
 
 typedef struct HWDevice HWDevice;
 
@@ -11,6 +13,107 @@ typedef void     (*hw_tick_fn)(HWDevice*, int budget);
 typedef void     (*hw_reset_fn)(HWDevice*);
 typedef const char* (*hw_name_fn)(HWDevice*);
 
+// ---- Event scheduler (guest-cycle clock) ----
+// Guest time advances by one cycle per retired instruction. Anything that
+// needs to act later arms an hw_event; the CPU runs uninterrupted until the
+// earliest deadline and the bus fires due events in deadline order (ties in
+// arming order), so device timing is the same on every run and engine.
+typedef void (*hw_event_fn)(void* ctx);
+
+typedef struct hw_event {
+    uint64_t    when;       // absolute guest cycle
+    uint64_t    seq;        // arming order, breaks ties
+    hw_event_fn fn;
+    void*       ctx;
+    int         slot;       // heap index, -1 when idle
+} hw_event;
+
+void hw_event_init(hw_event* ev, hw_event_fn fn, void* ctx);
+void hw_event_schedule(hw_event* ev, uint64_t delay);   // (re)arm at now+delay
+void hw_event_cancel(hw_event* ev);
+static inline bool hw_event_pending(const hw_event* ev) { return ev->slot >= 0; }
+
+// ---- Per-VM device context ----
+// Guest clock, event queue, bus map and device state of one VM. All hw_* and
+// dev_* calls act on the context bound to the calling thread.
+#define HW_SCHED_MAX 64
+
+typedef enum {
+    HW_STATE_UART = 0,
+    HW_STATE_RTC,
+    HW_STATE_NVRAM,
+    HW_STATE_DISK0,       // dev_disk.c controller
+    HW_STATE_DISKS,       // disk_manager.c slots
+    HW_STATE_INTC,        // dev_intc.c interrupt controller
+    HW_STATE_TIMER,       // dev_timer.c
+    HW_STATE_COUNT
+} hw_state_id;
+
+typedef struct hw_bus_map hw_bus_map;   // hw_bus.c
+
+typedef struct hw_ctx {
+    uint64_t    now;      // guest cycles elapsed
+    uint64_t    next;     // earliest pending deadline, UINT64_MAX if none
+    hw_event*   heap[HW_SCHED_MAX];
+    int         n_events;
+    uint64_t    seq;
+    hw_bus_map* bus;
+    void*       state[HW_STATE_COUNT];
+    bool        irq;      // interrupt controller output to the CPU
+    hw_event    irq_kick; // no-op, armed to cut the CPU loop (hw_irq_kick)
+    uint64_t    reads;    // bus reads so far (idle-loop detection)
+    uint64_t    reads_volatile;   // ... of which hw_read_volatile() flagged
+} hw_ctx;
+
+extern VM_TLS hw_ctx* g_hw;
+
+hw_ctx* hw_ctx_create(void);
+void    hw_ctx_destroy(hw_ctx* hw);
+void    hw_ctx_bind(hw_ctx* hw);      // NULL = the shared default context
+
+// Zeroed per-VM state block for a device module, allocated on first use.
+void*   hw_state(hw_state_id id, size_t size);
+
+void hw_sched_run(void);     // fire everything due now
+void hw_sched_set_now(uint64_t now);   // snapshot restore: pending events keep their delay
+
+// WFI: move the clock to one cycle before the next deadline (the retiring
+// WFI's own cycle then fires it). No-op while the IRQ line is up or nothing
+// is armed, since then no event could end the wait.
+void hw_sched_idle(void);
+
+// The IRQ line may now be takeable: make the CPU sample it after the
+// current instruction rather than at the end of its block.
+void hw_irq_kick(void);
+
+// Called by a read handler whose value can change without a bus write or an
+// hw_event firing (clock counters, host time) or that has a side effect
+// (acknowledge registers). The CPU never fast-forwards a loop polling it.
+static inline void hw_read_volatile(void) { g_hw->reads_volatile++; }
+
+static inline uint64_t hw_bus_now(void) { return g_hw->now; }
+
+// Cycles the CPU may run before the next event is due (0 = due now).
+static inline uint64_t hw_bus_until_next(void) {
+    return g_hw->next > g_hw->now ? g_hw->next - g_hw->now : 0;
+}
+
+// Account retired cycles; only reaches the scheduler when a deadline passes.
+static inline void hw_bus_advance(uint64_t cycles) {
+    hw_ctx* hw = g_hw;
+    hw->now += cycles;
+    if (hw->now >= hw->next) hw_sched_run();
+}
+
+// ---- Devices ----
+typedef enum {
+    HW_DEV_OTHER = 0,
+    HW_DEV_DISK,
+    HW_DEV_UART,
+    HW_DEV_CRT,
+    HW_DEV_KINDS
+} hw_dev_kind_t;
+
 struct HWDevice {
     uint32_t base, size;
     hw_read32_fn  read32;
@@ -19,6 +122,15 @@ struct HWDevice {
     hw_reset_fn   reset;    // optional
     hw_name_fn    name;     // optional
     void*         impl;     // device-private state
+
+    // Timing: tick() gets (guest cycles since its last tick) * clock_ratio
+    // work units. It runs every `period` cycles, or when the device arms
+    // it with hw_bus_schedule(); period 0 means only on request.
+    hw_dev_kind_t kind;
+    uint32_t      clock_ratio;  // 0 = default for kind (hw_bus_set_clock_ratio)
+    uint32_t      period;
+    uint64_t      last_tick;    // bus-owned
+    hw_event      ev;           // bus-owned
 };
 
 // Bus API
@@ -26,5 +138,6 @@ void hw_bus_init(void);
 bool hw_bus_attach(HWDevice* dev);             // returns false on overlap
 bool hw_bus_read32(uint32_t addr, uint32_t* out);
 bool hw_bus_write32(uint32_t addr, uint32_t val);
-void hw_bus_tick(int cycles_budget);           // calls all device ticks
+void hw_bus_schedule(HWDevice* dev, uint64_t delay);  // tick dev after delay cycles
+void hw_bus_set_clock_ratio(hw_dev_kind_t kind, uint32_t units_per_cycle);
 void hw_bus_reset(void);
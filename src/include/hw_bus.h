@@ -1,8 +1,10 @@
 // src/include/hw_bus.h
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include "vm.h"
+#include "hw.h"       // HWDevice, hw_bus_read32/write32
 
 // Use the same handler typedefs you expose from vm.h.
 // If vm.h already defines these, you can omit these lines.
@@ -10,4 +12,21 @@
 typedef uint32_t (*vm_mmio_read_fn)(void *ctx, uint32_t offset);
 typedef void     (*vm_mmio_write_fn)(void *ctx, uint32_t offset, uint32_t value);
 #define VM_MMIO_FNS_DEFINED 1
-#endif
\ No newline at end of file
+#endif
+
+// ---- Unified MMIO map ----
+// One map serves hw_bus_attach() devices, vm_map_mmio() handlers and the
+// named regions below; mem.c consults it for every non-RAM page. Lookup is
+// a per-page table, so windows claim whole 4 KiB pages.
+#define HW_BUS_PAGE_SHIFT 12u
+#define HW_BUS_PAGE_COUNT (1u << (32u - HW_BUS_PAGE_SHIFT))
+
+// Handlers receive the absolute (word-aligned) address. False on overlap.
+bool hw_bus_map_mmio(const char* name, uint32_t base, uint32_t size,
+                     vm_mmio_read_fn rfn, vm_mmio_write_fn wfn, void* ctx);
+bool hw_bus_map_region(const char* name, uint32_t base, uint32_t size,
+                       uint32_t (*read32)(uint32_t addr),
+                       void (*write32)(uint32_t addr, uint32_t value));
+
+bool hw_bus_is_mmio(uint32_t addr);                  // addr inside a window
+bool hw_bus_range_mapped(uint32_t addr, size_t len); // any byte inside one
@@ -0,0 +1,41 @@
+// src/include/jit.h — x86-64 translation of hot predecoded blocks
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Second tier of the threaded engine. A tcache block entered at its start
+// JIT_HOT times is translated to host code: guest registers it uses most
+// live in host registers, data processing, MOVW/MOVT, immediate-offset
+// LDR/STR(B) and B/BL are emitted inline, and every other op calls its K12
+// handler exactly as the threaded loop would. A direct branch out of a block
+// jumps straight into the target's translation once that exists (chaining).
+// Guest-visible behaviour -- registers, flags, memory, device timing, where a
+// run stops -- is the threaded loop's.
+//
+// Only on x86-64 hosts; build with -DCPU_NO_JIT to leave it out. Cygwin
+// builds leave it out too until the MS x64 calling convention path has been
+// run there; -DCPU_JIT_CYGWIN opts in.
+#if defined(__x86_64__) && !defined(CPU_NO_JIT) && \
+    (!defined(__CYGWIN__) || defined(CPU_JIT_CYGWIN))
+#define CPU_JIT 1
+#else
+#define CPU_JIT 0
+#endif
+
+#ifndef JIT_HOT
+#define JIT_HOT 32u             // entries at a block's start before translating
+#endif
+
+struct tc_block;
+typedef struct jit_state jit_state;     // per tcache (so per VM), jit_x64.c
+
+void jit_state_free(jit_state *js);
+
+// Run the block b (cpu.r[15] == b->start) and whatever it chains into,
+// retiring at most budget instructions. unsynced is the threaded loop's
+// clock cursor (see cpu_sync_clock()); *end receives the straight-line pc
+// just past the last op retired in the final block. Returns the number of
+// instructions retired; 0 means nothing ran (not hot or not translated yet,
+// no executable memory, budget shorter than the block) and the caller
+// interprets b instead.
+uint32_t jit_run(struct tc_block *b, uint32_t budget, uint32_t *unsynced, uint32_t *end);
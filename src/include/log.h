@@ -6,6 +6,7 @@ bool log_set_file(const char* filename);
 void start_log(const char* filename);
 void stop_log(void);
 bool log_is_active(void);
+void log_set_quiet(bool quiet);   // drop all output from the calling thread
 
 void log_printf(const char* fmt, ...);
 void log_info  (const char* fmt, ...);
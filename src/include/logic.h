@@ -29,9 +29,17 @@ void handle_mov_imm(uint32_t instr); // DP MOV immediate fast path (same semanti
 void handle_rev(uint32_t instr);
 void handle_rev16(uint32_t instr);
 void handle_revsh(uint32_t instr);
+void handle_rbit(uint32_t instr);
 
 // Extend (no-rotate base forms)
 void handle_uxtb(uint32_t instr);
 void handle_uxth(uint32_t instr);
 void handle_sxtb(uint32_t instr);
 void handle_sxth(uint32_t instr);
+void handle_extend(uint32_t instr);  // any rotation, accumulate and B16 forms
+
+// Packing and saturation
+void handle_pkh(uint32_t instr);     // PKHBT / PKHTB
+void handle_ssat(uint32_t instr);    // SSAT / USAT
+void handle_ssat16(uint32_t instr);  // SSAT16 / USAT16
+void handle_qarith(uint32_t instr);  // QADD / QSUB / QDADD / QDSUB
@@ -5,6 +5,15 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "vm_tls.h"
+
+// Per-VM RAM binding and page table. The mem_* calls below act on the
+// context bound to the calling thread (vm_activate binds the VM's).
+typedef struct mem_ctx mem_ctx;
+mem_ctx *mem_ctx_create(void);
+void     mem_ctx_destroy(mem_ctx *m);
+void     mem_ctx_bind(mem_ctx *m);     // NULL = the shared default context
+
 void   mem_init(void);                 // <-- add this
 void   mem_bind(uint8_t *base, size_t size);
 void   mem_unbind(void);
@@ -13,10 +22,31 @@ size_t mem_size(void);
 
 uint8_t  mem_read8 (uint32_t addr);
 uint32_t mem_read32(uint32_t addr);
+uint32_t mem_fetch32(uint32_t addr);   // instruction fetch: mem_read32 minus the watch
 void     mem_write8 (uint32_t addr, uint8_t  v);
 void     mem_write32(uint32_t addr, uint32_t v);
 
+// n (<= 16) consecutive words at addr in one go, when they all sit in one
+// plain-RAM page; false (nothing transferred) otherwise, including while a
+// watch is set. Writes notify the translation cache.
+bool     mem_read_block32 (uint32_t addr, uint32_t *dst, unsigned n);
+bool     mem_write_block32(uint32_t addr, const uint32_t *src, unsigned n);
+
 bool     mem_copy_in (uint32_t dst_addr, const void *src, size_t len);
 bool     mem_copy_out(void *dst, uint32_t src_addr, size_t len);
 
+// Host pointer for [addr, addr+len) if it is plain RAM (no live MMIO
+// window in the way), else NULL. Callers that write through it must
+// notify the translation cache themselves.
+const uint8_t *mem_host_ptr(uint32_t addr, size_t len);
+
+// Called by the bus when an MMIO window is added or removed.
+void mem_mmio_changed(void);
+
+// Observer for guest data accesses through mem_read*/mem_write* (size 1 or
+// 4). While one is set every page takes the checked path, so the fast path
+// never tests for it. NULL removes it.
+typedef void (*mem_watch_fn)(uint32_t addr, uint32_t value, unsigned size, bool write);
+void mem_set_watch(mem_watch_fn fn);
+
 #endif
@@ -0,0 +1,32 @@
+// src/include/profile.h — guest execution profiler
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "vm_tls.h"
+
+// Counts guest execution per straight-line run of instructions ("block":
+// start PC + length, as the run loops retire them), follows BL/BLX calls
+// and BX LR / MOV PC,LR / POP {..,PC} returns on a shadow stack for call
+// edges and inclusive counts, and reports the hottest blocks, addresses
+// and functions. Symbols come from a GNU ld map file.
+typedef struct profile_ctx profile_ctx;
+
+// Profile collecting on this thread, NULL = off. The run loops call
+// profile_block() only when this is set.
+extern VM_TLS profile_ctx *g_prof;
+
+profile_ctx *profile_create(void);
+void         profile_destroy(profile_ctx *p);
+void         profile_bind(profile_ctx *p);     // NULL = stop collecting
+void         profile_reset(profile_ctx *p);     // drop counts, keep symbols
+
+// n instructions from pc just retired back to back; cpu.r[15] is where the
+// last one went.
+void         profile_block(uint32_t pc, uint32_t n);
+
+// Add the symbols of a GNU ld map file ("0x00008000   main" lines).
+bool         profile_load_map(profile_ctx *p, const char *path);
+
+// Top-n hot blocks, addresses, functions and call edges via log_printf().
+// Disassembly reads guest memory, so the profiled VM must be active.
+void         profile_report(const profile_ctx *p, unsigned top);
@@ -0,0 +1,31 @@
+// src/include/snapshot.h — tagged-section stream used by vm_snapshot_save/load
+#pragma once
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// File: "ARMVMSNP" + u32 version, then sections of (u32 tag, u32 length,
+// payload). Integers are little-endian. Readers skip sections they don't
+// know, so devices can be added without breaking older snapshots.
+#define SNAP_MAGIC   "ARMVMSNP"
+#define SNAP_VERSION 1u
+#define SNAP_TAG(a, b, c, d) \
+    ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+typedef struct {
+    FILE *f;
+    bool  ok;            // sticky: false after any short read/write
+    long  sect_start;    // writer: offset of the open section's length field
+} snap_io;
+
+void     snap_put(snap_io *s, const void *p, size_t n);
+void     snap_get(snap_io *s, void *p, size_t n);
+void     snap_put_u32(snap_io *s, uint32_t v);
+void     snap_put_u64(snap_io *s, uint64_t v);
+uint32_t snap_get_u32(snap_io *s);
+uint64_t snap_get_u64(snap_io *s);
+
+// Writer: open a section, write its payload, then close it (patches length).
+void     snap_section_begin(snap_io *s, uint32_t tag);
+void     snap_section_end(snap_io *s);
@@ -19,4 +19,6 @@ void handle_deadbeef(uint32_t instr);
 void handle_bfc(uint32_t instr);
 void handle_bfi(uint32_t instr);
 void handle_clz(uint32_t instr);
+void handle_ubfx(uint32_t instr);
+void handle_sbfx(uint32_t instr);
 void handle_msr(uint32_t instr);
\ No newline at end of file
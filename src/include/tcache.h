@@ -0,0 +1,96 @@
+// src/include/tcache.h — predecoded basic-block cache keyed by guest PC
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+#include "cond.h"
+#include "execute.h"
+#include "cpu_flags.h"
+#include "vm_tls.h"
+#include "snapshot.h"
+
+#ifndef TC_BLOCK_SLOTS
+#define TC_BLOCK_SLOTS 4096u       // direct-mapped on block start PC (power of 2)
+#endif
+#ifndef TC_MAX_OPS
+#define TC_MAX_OPS     32u         // instructions per block
+#endif
+
+// Guest writes are checked against a bitmap of 1 KiB "code granules";
+// only a write into a granule that holds cached code costs anything.
+#define TC_GRANULE_SHIFT 10u
+#define TC_GRANULES      (1u << (32u - TC_GRANULE_SHIFT))
+
+typedef struct tc_block {
+    uint32_t start;                // guest PC of ops[0]
+    uint16_t n_ops;
+    uint16_t hits;                 // entries at ops[0] towards JIT_HOT (jit.h)
+    uint16_t jit_ops;              // ops the translation covers
+    uint32_t jit_epoch;            // translation valid while this matches
+    void    *jit;                  // host code, NULL = none
+    k12_op   ops[TC_MAX_OPS];
+} tc_block;
+
+// One cache per VM (it describes that VM's RAM). The functions below use the
+// one bound to the calling thread.
+typedef struct tc_state {
+    uint8_t   code_map[TC_GRANULES / 8u];  // granules holding cached code
+    uint32_t  gen;                 // bumped whenever cached ops may be stale
+    tc_block  blocks[TC_BLOCK_SLOTS];
+    uint32_t  tag[TC_BLOCK_SLOTS]; // start+1 of the live block, 0 = empty
+    uint32_t  seen[TC_BLOCK_SLOTS];// pc+1 of the last miss per slot
+    tc_block *cur;                 // block the last lookup landed in
+    uint32_t  cur_gen;             // gen when cur was set
+    struct jit_state *jit;         // host code for hot blocks, created on use
+} tc_state;
+
+extern VM_TLS tc_state *g_tc;
+
+tc_state *tcache_create(void);
+void      tcache_destroy(tc_state *tc);
+void      tcache_bind(tc_state *tc);   // NULL = the shared default cache
+
+void tcache_flush(void);
+void tcache_invalidate_range(uint32_t addr, size_t len);
+
+// Op for pc, predecoding a block on a repeated miss. NULL on a first
+// miss, if pc is not plain RAM, or if the word does not decode (caller
+// falls back to fetch + execute()).
+const k12_op *tcache_lookup(uint32_t pc);
+
+// Same, also reporting how many ops (>= 1) follow in straight line from the
+// returned one, itself included. Valid while g_tc->gen is unchanged.
+const k12_op *tcache_lookup_run(uint32_t pc, uint32_t *left);
+
+// Live block starting exactly at pc, without predecoding; NULL if none.
+tc_block *tcache_block_at(uint32_t pc);
+
+// Blocks lying wholly in [lo, hi) as u32 count, then per block start, n_ops
+// and (word, K12 rule index) per op; returns the count. Rule indices are
+// only valid for the same rule table (execute_rules_hash()).
+uint32_t  tcache_save(snap_io *s, uint32_t lo, uint32_t hi);
+// Reads what tcache_save() wrote and installs each block whose words are
+// still in memory and still resolve to the saved rules, unless its slot is
+// taken. Returns the number installed, -1 if the stream is short or corrupt.
+int       tcache_load(snap_io *s);
+
+static inline bool tcache_granule_hot(uint32_t addr) {
+    uint32_t g = addr >> TC_GRANULE_SHIFT;
+    return (g_tc->code_map[g >> 3] >> (g & 7u)) & 1u;
+}
+
+// Cheap hook for the mem layer's small stores (len 1..64, so at most two
+// granules are touched).
+static inline void tcache_note_write(uint32_t addr, size_t len) {
+    if (tcache_granule_hot(addr) || tcache_granule_hot(addr + (uint32_t)len - 1u))
+        tcache_invalidate_range(addr, len);
+}
+
+// Replay one predecoded op exactly as try_decode_key12_fast() would.
+static inline void tcache_run_op(const k12_op *op) {
+    if ((op->kind == K12_OP_COND || op->kind == K12_OP_B) && !cond_passed(op->cond, cpsr_nzcv()))
+        return;                    // decoded but skipped by condition
+    op->fn(op->instr);
+}
@@ -0,0 +1,43 @@
+// src/include/trace.h — binary instruction trace
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// A trace is a stream of fixed-layout records (one per retired instruction)
+// that the CPU thread drops into a ring buffer; a writer thread drains the
+// ring to a file. trace_decode() turns the file back into DISASM-style text.
+//
+// File: TRACE_MAGIC, u32 version, u32 byte-order mark 0x01020304, then
+// records of 32-bit words:
+//   pc, instr, info, <value per changed register>, <addr, value, kind per access>
+// info bits 0..14: r0..r14 changed, bit 15: CPSR changed, 16..23: number of
+// memory accesses, 24: more accesses happened than were recorded, 25: halted.
+#define TRACE_MAGIC    "ARMTRACE"
+#define TRACE_VERSION  1u
+
+#define TRACE_INFO_CPSR      (1u << 15)
+#define TRACE_INFO_NMEM(i)   (((i) >> 16) & 0xFFu)
+#define TRACE_INFO_MEM_LOST  (1u << 24)
+#define TRACE_INFO_HALTED    (1u << 25)
+
+// access kind word: size in bytes (1 or 4) | TRACE_MEM_WRITE
+#define TRACE_MEM_WRITE      0x100u
+
+typedef struct trace_ctx trace_ctx;
+
+// Open path and start the writer thread; NULL on failure.
+trace_ctx *trace_start(const char *path);
+
+// Drain what is left, stop the writer and close the file. Returns false if
+// any write failed. Safe with NULL.
+bool       trace_stop(trace_ctx *t);
+
+// cpu_step() with the instruction's effects recorded into t. The VM must
+// be active on the calling thread.
+void       trace_step(trace_ctx *t);
+
+uint64_t   trace_records(const trace_ctx *t);
+
+// Offline: write the text form of the trace at in_path to out (stdout if
+// out_path is NULL). Returns false on a bad or unreadable file.
+bool       trace_decode(const char *in_path, const char *out_path);
@@ -9,6 +9,7 @@
 #include <stddef.h>
 
 #include "debug.h"             // defines debug_flags_t
+#include "cpu.h"               // cpu_engine_t
 typedef debug_flags_t vm_debug_t;  // optional alias; keep if you like the name
 
 // Opaque type
@@ -30,8 +31,11 @@ bool          vm_add_ram(VM* vm, size_t ram_size);  // Attach/allocate RAM
 size_t        vm_ram_size(const VM* vm);      // Query RAM size
 void          vm_reset(VM* vm);               // Reset CPU & state
 void          vm_destroy(VM* vm);             // Free VM and RAM
+void          vm_activate(VM* vm);            // Bind vm to the calling thread
 void          vm_set_debug(VM *vm, debug_flags_t flags);
 debug_flags_t vm_get_debug(const VM *vm);
+void          vm_set_engine(VM *vm, cpu_engine_t engine);   // step / threaded loop
+cpu_engine_t  vm_get_engine(const VM *vm);
 
 // ---- Execution ----
 bool    vm_step(VM* vm);                // Execute one instruction
@@ -51,14 +55,59 @@ void     vm_set_reg(VM* vm, int idx, uint32_t value);
 uint32_t vm_get_cpsr(const VM* vm);
 void     vm_set_cpsr(VM* vm, uint32_t value);
 void     vm_dump_regs(VM *vm);
+uint64_t vm_cycles(const VM* vm);              // instructions retired
 
 // ---- MMIO callback registration ----
 typedef uint32_t (*vm_mmio_read_fn)(void* ctx, uint32_t addr);
 typedef void     (*vm_mmio_write_fn)(void* ctx, uint32_t addr, uint32_t value);
 
+// The threaded engine fast-forwards guest loops that only poll a register, so
+// a read must return the same value until the window is written or an
+// hw_event fires; handlers that follow time or have side effects call
+// hw_read_volatile() (hw.h).
+
 bool vm_map_mmio(VM* vm,
                  uint32_t base, uint32_t size,
                  vm_mmio_read_fn rfn, vm_mmio_write_fn wfn,
                  void* ctx);
 
+// ---- Binary trace ----
+// Record every instruction (PC, word, changed registers, memory accesses)
+// to a file in the background; see trace.h. Runs use the stepping loop
+// while a trace is on.
+bool vm_trace_start(VM* vm, const char* path);
+bool vm_trace_stop(VM* vm);
+
+// ---- Profiler ----
+// Per-block execution counts and call edges while on; see profile.h.
+// "off" keeps the counts for report, "start" clears them. Symbols loaded
+// from a map file are kept across starts.
+bool vm_profile_start(VM* vm);
+void vm_profile_stop(VM* vm);
+bool vm_profile_load_map(VM* vm, const char* path);
+void vm_profile_report(VM* vm, unsigned top);
+
+// ---- NVRAM ----
+// A new VM's NVRAM lives in memory only and starts blank. With a backing
+// file it is loaded from there (now, or when RAM is added) and every data
+// register write rewrites the file; give each VM its own file.
+void vm_nvram_file(VM* vm, const char* path);       // NULL = memory only
+
+// ---- Translation cache on disk ----
+// With a directory set, every vm_load_binary() looks for a file of
+// predecoded blocks named after a hash of all binaries loaded so far and,
+// if it matches this build's decoder and the loaded bytes, installs them so
+// the first run is as warm as a later one. vm_tcache_save() writes the
+// blocks decoded inside the loaded images; vm_destroy() calls it, and it
+// only rewrites the file when the run decoded blocks the file lacked.
+void vm_tcache_default_dir(const char* dir);       // for VMs created later; NULL = off
+void vm_tcache_dir(VM* vm, const char* dir);        // NULL = off
+bool vm_tcache_save(VM* vm);
+
+// ---- Snapshots ----
+// Whole-VM state (CPU, non-zero RAM pages, device registers) to/from a file.
+// Load expects a VM with the same RAM size and the same disk attached.
+bool vm_snapshot_save(VM* vm, const char* path);
+bool vm_snapshot_load(VM* vm, const char* path);
+
 #endif // VM_H
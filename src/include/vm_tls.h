@@ -0,0 +1,11 @@
+// src/include/vm_tls.h — storage class for "current VM" state
+// Each module keeps its per-VM state behind a thread-local pointer that
+// vm_activate() points at the VM being driven on that thread, so separate
+// threads can run separate VMs. One VM must not run on two threads at once.
+#pragma once
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VM_TLS __declspec(thread)
+#else
+#define VM_TLS _Thread_local
+#endif
@@ -5,6 +5,11 @@
 #include "debug.h"   // for debug_flags_t / DBG_* (optional but nice)
 
 static FILE* log_file = NULL;
+static VM_TLS bool log_quiet = false;   // per thread: batch workers run silent
+
+void log_set_quiet(bool quiet) {
+    log_quiet = quiet;
+}
 
 void start_log(const char* filename) {
     if (log_file) fclose(log_file);
@@ -27,6 +32,7 @@ bool log_set_file(const char* filename) {
 }
 
 void log_printf(const char* fmt, ...) {
+    if (log_quiet) return;
     va_list args; 
     va_start(args, fmt);
 
@@ -48,6 +54,7 @@ bool log_is_active(void) {
 
 // Internal helper for prefixed logging
 static void log_with_prefix(const char* prefix, const char* fmt, va_list ap) {
+    if (log_quiet) return;
     if (log_file) {
         va_list copy1;
         va_copy(copy1, ap);
@@ -3,157 +3,232 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "mem.h"
-#include "dev_disk.h"   // dev_disk0_present(), dev_disk0_read_reg(), dev_disk0_write_reg()
-#include "dev_uart.h"   // dev_uart_present(), dev_uart_read_reg(), dev_uart_write_reg()
+#include "hw_bus.h"     // hw_bus_read32/write32(), hw_bus_is_mmio(), hw_bus_range_mapped()
+#include "tcache.h"     // tcache_note_write(), tcache_invalidate_range(), tcache_flush()
+#include "cpu.h"        // cpu_sync_clock() before device accesses
 
 // ==========================
-// Internal RAM state
+// Page table (4 KiB granules)
 // ==========================
-static uint8_t *g_ram_base = NULL;
-static size_t   g_ram_size = 0;
-static bool     g_ram_bound = false;
+// Host pointer to the start of each guest page that is plain RAM. NULL pages
+// (pages holding a bus MMIO window, the partial last page, anything unbound)
+// take the checked path below, which is the only place MMIO is consulted.
+#define MEM_PAGE_SHIFT 12u
+#define MEM_PAGE_SIZE  (1u << MEM_PAGE_SHIFT)
+#define MEM_PAGE_MASK  (MEM_PAGE_SIZE - 1u)
+#define MEM_PAGE_COUNT (1u << (32u - MEM_PAGE_SHIFT))
 
 // ==========================
-// MMIO windows (word-based)
+// Per-VM RAM state
 // ==========================
-#define DISK0_BASE 0x0B000000u
-#define DISK0_SIZE 0x00001000u
+struct mem_ctx {
+    uint8_t *ram_base;
+    size_t   ram_size;
+    bool     ram_bound;
+    uint32_t page_filled;              // entries [0, page_filled) may be set
+    mem_watch_fn watch;                // data access observer, NULL = none
+    uint8_t *page[MEM_PAGE_COUNT];
+};
 
-#define UART0_BASE 0x09000000u
-#define UART0_SIZE 0x00001000u
+// Threads that never bind a context share this one (single-VM tools).
+static mem_ctx g_mem_default;
+static VM_TLS mem_ctx *g_mem = &g_mem_default;
 
-static inline bool in_disk0(uint32_t a) {
-    return (uint32_t)(a - DISK0_BASE) < DISK0_SIZE;
+mem_ctx *mem_ctx_create(void) {
+    return (mem_ctx*)calloc(1, sizeof(mem_ctx));   // page table pages in lazily
 }
-static inline bool in_uart0(uint32_t a) {
-    return (uint32_t)(a - UART0_BASE) < UART0_SIZE;
+
+void mem_ctx_destroy(mem_ctx *m) {
+    if (!m || m == &g_mem_default) return;
+    if (g_mem == m) g_mem = &g_mem_default;
+    free(m);
 }
 
-// Disk0 32-bit MMIO accessors (thin wrappers)
-static inline uint32_t disk0_rd32(uint32_t addr) {
-    return dev_disk0_present() ? dev_disk0_read_reg(addr & ~3u) : 0u;
+void mem_ctx_bind(mem_ctx *m) {
+    g_mem = m ? m : &g_mem_default;
 }
-static inline void disk0_wr32(uint32_t addr, uint32_t val) {
-    if (dev_disk0_present()) dev_disk0_write_reg(addr & ~3u, val);
+
+static void pages_rebuild(void) {
+    for (uint32_t p = 0; p < g_mem->page_filled; ++p) g_mem->page[p] = NULL;
+    g_mem->page_filled = 0;
+    if (!g_mem->ram_bound || g_mem->watch) return;
+
+    uint64_t full = (uint64_t)g_mem->ram_size >> MEM_PAGE_SHIFT;   // whole pages only
+    if (full > MEM_PAGE_COUNT) full = MEM_PAGE_COUNT;
+    for (uint32_t p = 0; p < (uint32_t)full; ++p) {
+        uint32_t a = p << MEM_PAGE_SHIFT;
+        if (!hw_bus_range_mapped(a, MEM_PAGE_SIZE))
+            g_mem->page[p] = g_mem->ram_base + a;
+    }
+    g_mem->page_filled = (uint32_t)full;
+}
+
+// Native little-endian access inside one page.
+static inline uint32_t ld_le32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+static inline void st_le32(uint8_t *p, uint32_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(p, &v, 4);
 }
 
 // ==========================
 // RAM helpers (bounds-safe)
 // ==========================
 static inline bool ram_ok(uint32_t addr, size_t len) {
-    if (!g_ram_bound) return false;
-    if ((size_t)addr > g_ram_size) return false;
-    if (len > g_ram_size - (size_t)addr) return false;
+    if (!g_mem->ram_bound) return false;
+    if ((size_t)addr > g_mem->ram_size) return false;
+    if (len > g_mem->ram_size - (size_t)addr) return false;
     return true;
 }
 
 static inline uint8_t ram_read8(uint32_t addr) {
-    return ram_ok(addr, 1) ? g_ram_base[addr] : 0;
+    return ram_ok(addr, 1) ? g_mem->ram_base[addr] : 0;
 }
 
 static inline void ram_write8(uint32_t addr, uint8_t v) {
-    if (ram_ok(addr, 1)) g_ram_base[addr] = v;
+    if (!ram_ok(addr, 1)) return;
+    g_mem->ram_base[addr] = v;
+    tcache_note_write(addr, 1);
 }
 
 static inline uint32_t ram_read32(uint32_t addr) {
     if (!ram_ok(addr, 4)) return 0;
     // Little-endian, allow unaligned safely
-    uint32_t b0 = g_ram_base[addr + 0];
-    uint32_t b1 = g_ram_base[addr + 1];
-    uint32_t b2 = g_ram_base[addr + 2];
-    uint32_t b3 = g_ram_base[addr + 3];
+    uint32_t b0 = g_mem->ram_base[addr + 0];
+    uint32_t b1 = g_mem->ram_base[addr + 1];
+    uint32_t b2 = g_mem->ram_base[addr + 2];
+    uint32_t b3 = g_mem->ram_base[addr + 3];
     return (b0) | (b1 << 8) | (b2 << 16) | (b3 << 24);
 }
 
 static inline void ram_write32(uint32_t addr, uint32_t v) {
     if (!ram_ok(addr, 4)) return;
-    g_ram_base[addr + 0] = (uint8_t)(v & 0xFF);
-    g_ram_base[addr + 1] = (uint8_t)((v >> 8) & 0xFF);
-    g_ram_base[addr + 2] = (uint8_t)((v >> 16) & 0xFF);
-    g_ram_base[addr + 3] = (uint8_t)((v >> 24) & 0xFF);
+    g_mem->ram_base[addr + 0] = (uint8_t)(v & 0xFF);
+    g_mem->ram_base[addr + 1] = (uint8_t)((v >> 8) & 0xFF);
+    g_mem->ram_base[addr + 2] = (uint8_t)((v >> 16) & 0xFF);
+    g_mem->ram_base[addr + 3] = (uint8_t)((v >> 24) & 0xFF);
+    tcache_note_write(addr, 4);
 }
 
 // ==========================
 // Public API (mem.h)
 // ==========================
 void mem_init(void) {
-    g_ram_base  = NULL;
-    g_ram_size  = 0;
-    g_ram_bound = false;
+    g_mem->ram_base  = NULL;
+    g_mem->ram_size  = 0;
+    g_mem->ram_bound = false;
+    pages_rebuild();
 }
 
 void mem_bind(uint8_t *base, size_t size) {
-    g_ram_base  = base;
-    g_ram_size  = size;
-    g_ram_bound = (base != NULL && size > 0);
+    // Cached blocks describe the old buffer; rebinding the same one is free.
+    if (base == g_mem->ram_base && size == g_mem->ram_size) return;
+    tcache_flush();
+    g_mem->ram_base  = base;
+    g_mem->ram_size  = size;
+    g_mem->ram_bound = (base != NULL && size > 0);
+    pages_rebuild();
 }
 
 void mem_unbind(void) {
-    g_ram_base  = NULL;
-    g_ram_size  = 0;
-    g_ram_bound = false;
+    tcache_flush();
+    g_mem->ram_base  = NULL;
+    g_mem->ram_size  = 0;
+    g_mem->ram_bound = false;
+    pages_rebuild();
+}
+
+void mem_mmio_changed(void) {
+    // A window may now cover pages that held cached code.
+    tcache_flush();
+    pages_rebuild();
+}
+
+void mem_set_watch(mem_watch_fn fn) {
+    g_mem->watch = fn;
+    pages_rebuild();
 }
 
 bool mem_is_bound(void) {
-    return g_ram_bound;
+    return g_mem->ram_bound;
 }
 
 size_t mem_size(void) {
-    return g_ram_size;
+    return g_mem->ram_size;
 }
 
 // ---------- Reads ----------
 uint8_t mem_read8(uint32_t addr) {
-    // UART (byte via read-modify of 32-bit reg)
-    if (in_uart0(addr) && dev_uart_present()) {
-        uint32_t base  = addr & ~3u;
-        uint32_t shift = (addr & 3u) * 8u;
-        uint32_t w     = dev_uart_read_reg(base);
-        return (uint8_t)((w >> shift) & 0xFFu);
-    }
-    // DISK (byte via read-modify of 32-bit reg)
-    if (in_disk0(addr) && dev_disk0_present()) {
-        uint32_t base  = addr & ~3u;
+    const uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (pg) return pg[addr & MEM_PAGE_MASK];
+    cpu_sync_clock();
+
+    // MMIO (byte via read of the 32-bit reg)
+    uint32_t w;
+    uint8_t  v;
+    if (hw_bus_read32(addr & ~3u, &w)) {
         uint32_t shift = (addr & 3u) * 8u;
-        uint32_t w     = disk0_rd32(base);
-        return (uint8_t)((w >> shift) & 0xFFu);
+        v = (uint8_t)((w >> shift) & 0xFFu);
+    } else {
+        // RAM
+        v = ram_read8(addr);
     }
-    // RAM
-    return ram_read8(addr);
+    if (g_mem->watch) g_mem->watch(addr, v, 1, false);
+    return v;
+}
+
+static inline uint32_t read32(uint32_t addr) {
+    const uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (pg && (addr & MEM_PAGE_MASK) <= MEM_PAGE_SIZE - 4u)
+        return ld_le32(pg + (addr & MEM_PAGE_MASK));
+    cpu_sync_clock();
+
+    uint32_t w;
+    if (!hw_bus_read32(addr, &w)) w = ram_read32(addr);
+    return w;
 }
 
 uint32_t mem_read32(uint32_t addr) {
-    if (in_uart0(addr) && dev_uart_present()) {
-        return dev_uart_read_reg(addr);
-    }
-    if (in_disk0(addr) && dev_disk0_present()) {
-        return disk0_rd32(addr);
-    }
-    return ram_read32(addr);
+    uint32_t w = read32(addr);
+    if (g_mem->watch) g_mem->watch(addr, w, 4, false);
+    return w;
+}
+
+uint32_t mem_fetch32(uint32_t addr) {
+    return read32(addr);
 }
 
 // ---------- Writes ----------
 void mem_write8(uint32_t addr, uint8_t v) {
-    // UART (byte lane write as RMW of 32-bit reg)
-    if (in_uart0(addr) && dev_uart_present()) {
-        uint32_t base  = addr & ~3u;
-        uint32_t shift = (addr & 3u) * 8u;
-        uint32_t cur   = dev_uart_read_reg(base);
-        uint32_t mask  = 0xFFu << shift;
-        uint32_t merged = (cur & ~mask) | ((uint32_t)v << shift);
-        dev_uart_write_reg(base, merged);
+    uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (pg) {
+        pg[addr & MEM_PAGE_MASK] = v;
+        tcache_note_write(addr, 1);
         return;
     }
-    // DISK (byte lane write as RMW of 32-bit reg)
-    if (in_disk0(addr) && dev_disk0_present()) {
+    if (g_mem->watch) g_mem->watch(addr, v, 1, true);
+
+    // MMIO (byte lane write as RMW of 32-bit reg)
+    if (hw_bus_is_mmio(addr)) {
+        cpu_sync_clock();
         uint32_t base  = addr & ~3u;
         uint32_t shift = (addr & 3u) * 8u;
-        uint32_t cur   = disk0_rd32(base);
+        uint32_t cur   = 0;
+        hw_bus_read32(base, &cur);
         uint32_t mask  = 0xFFu << shift;
         uint32_t merged = (cur & ~mask) | ((uint32_t)v << shift);
-        disk0_wr32(base, merged);
+        hw_bus_write32(base, merged);
         return;
     }
     // RAM
@@ -161,30 +236,67 @@ void mem_write8(uint32_t addr, uint8_t v) {
 }
 
 void mem_write32(uint32_t addr, uint32_t v) {
-    if (in_uart0(addr) && dev_uart_present()) {
-        dev_uart_write_reg(addr, v);
+    uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (pg && (addr & MEM_PAGE_MASK) <= MEM_PAGE_SIZE - 4u) {
+        st_le32(pg + (addr & MEM_PAGE_MASK), v);
+        tcache_note_write(addr, 4);
         return;
     }
-    if (in_disk0(addr) && dev_disk0_present()) {
-        disk0_wr32(addr, v);
+    if (g_mem->watch) g_mem->watch(addr, v, 4, true);
+
+    if (hw_bus_is_mmio(addr)) {
+        cpu_sync_clock();
+        hw_bus_write32(addr, v);
         return;
     }
     ram_write32(addr, v);
 }
 
+// ---------- Word blocks (LDM/STM) ----------
+// Page-table only: a NULL page (MMIO, unbound, watched) or a block running
+// off its page makes these refuse, and the caller goes word by word.
+static inline uint8_t *block_span(uint32_t addr, unsigned n) {
+    uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (!pg || (addr & MEM_PAGE_MASK) + 4u * n > MEM_PAGE_SIZE) return NULL;
+    return pg + (addr & MEM_PAGE_MASK);
+}
+
+bool mem_read_block32(uint32_t addr, uint32_t *dst, unsigned n) {
+    const uint8_t *p = block_span(addr, n);
+    if (!p) return false;
+    for (unsigned i = 0; i < n; ++i) dst[i] = ld_le32(p + 4u * i);
+    return true;
+}
+
+bool mem_write_block32(uint32_t addr, const uint32_t *src, unsigned n) {
+    uint8_t *p = block_span(addr, n);
+    if (!p) return false;
+    for (unsigned i = 0; i < n; ++i) st_le32(p + 4u * i, src[i]);
+    if (n) tcache_note_write(addr, 4u * n);
+    return true;
+}
+
+const uint8_t *mem_host_ptr(uint32_t addr, size_t len) {
+    const uint8_t *pg = g_mem->page[addr >> MEM_PAGE_SHIFT];
+    if (pg && len && (addr & MEM_PAGE_MASK) + len <= MEM_PAGE_SIZE)
+        return pg + (addr & MEM_PAGE_MASK);
+
+    if (!len || !ram_ok(addr, len)) return NULL;
+    if (hw_bus_range_mapped(addr, len)) return NULL;
+    return g_mem->ram_base + addr;
+}
+
 // ---------- Bulk copy helpers ----------
 bool mem_copy_in(uint32_t dst_addr, const void *src, size_t len) {
     if (!len) return true;
     if (!src) return false;
 
     // Disallow writing into MMIO windows via bulk copy
-    if (in_disk0(dst_addr) || (len && in_disk0(dst_addr + (uint32_t)(len - 1))) ||
-        in_uart0(dst_addr) || (len && in_uart0(dst_addr + (uint32_t)(len - 1)))) {
-        return false;
-    }
+    if (hw_bus_range_mapped(dst_addr, len)) return false;
 
     if (!ram_ok(dst_addr, len)) return false;
-    memcpy(g_ram_base + dst_addr, src, len);
+    memcpy(g_mem->ram_base + dst_addr, src, len);
+    tcache_invalidate_range(dst_addr, len);
     return true;
 }
 
@@ -193,12 +305,9 @@ bool mem_copy_out(void *dst, uint32_t src_addr, size_t len) {
     if (!dst) return false;
 
     // Disallow reading from MMIO via bulk copy
-    if (in_disk0(src_addr) || (len && in_disk0(src_addr + (uint32_t)(len - 1))) ||
-        in_uart0(src_addr) || (len && in_uart0(src_addr + (uint32_t)(len - 1)))) {
-        return false;
-    }
+    if (hw_bus_range_mapped(src_addr, len)) return false;
 
     if (!ram_ok(src_addr, len)) return false;
-    memcpy(dst, g_ram_base + src_addr, len);
+    memcpy(dst, g_mem->ram_base + src_addr, len);
     return true;
 }
@@ -0,0 +1,353 @@
+// src/profile.c — guest execution profiler
+// Counting happens once per block, not per instruction: the threaded loop
+// reports each run of straight-line ops it retired, the stepping paths
+// report single instructions. Per-address counts are only expanded from the
+// block counts when a report is printed.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "profile.h"
+#include "cpu.h"
+#include "mem.h"       // mem_fetch32()
+#include "disasm.h"
+#include "log.h"
+
+#define PROF_STACK_MAX   256u       // shadow call stack depth
+#define PROF_TAB_MIN     1024u      // initial slots per table (power of 2)
+
+// One open-addressed table shape serves every count: key (a, b), values n, m.
+//   blocks: a = start pc, b = length,  n = executions
+//   edges:  a = call site, b = target, n = calls
+//   funcs:  a = entry,     b = 0,      n = calls, m = inclusive instructions
+typedef struct { uint32_t a, b; uint64_t n, m; } prof_ent;
+typedef struct { prof_ent *e; uint32_t cap, used; } prof_tab;
+
+typedef struct { uint32_t entry, ret; uint64_t start; } prof_frame;
+typedef struct { uint32_t addr; char *name; } prof_sym;
+
+struct profile_ctx {
+    prof_tab   blocks, edges, funcs;
+    uint64_t   instrs, calls, returns;
+
+    prof_frame stack[PROF_STACK_MAX];
+    uint32_t   depth;
+
+    prof_sym  *syms;                // sorted by addr
+    uint32_t   nsyms;
+};
+
+VM_TLS profile_ctx *g_prof;
+
+// -----------------------------------------------------------------------------
+// Tables
+// -----------------------------------------------------------------------------
+static inline uint32_t tab_hash(uint32_t a, uint32_t b) {
+    return (a * 0x9E3779B1u) ^ (b * 0x85EBCA77u) ^ (a >> 15);
+}
+
+static void tab_free(prof_tab *t) {
+    free(t->e);
+    memset(t, 0, sizeof *t);
+}
+
+static bool tab_grow(prof_tab *t) {
+    uint32_t cap = t->cap ? t->cap * 2u : PROF_TAB_MIN;
+    prof_ent *e = (prof_ent*)calloc(cap, sizeof *e);
+    if (!e) return false;
+    for (uint32_t i = 0; i < t->cap; i++) {
+        const prof_ent *o = &t->e[i];
+        if (!o->n) continue;
+        uint32_t h = tab_hash(o->a, o->b) & (cap - 1u);
+        while (e[h].n) h = (h + 1u) & (cap - 1u);
+        e[h] = *o;
+    }
+    free(t->e);
+    t->e = e;
+    t->cap = cap;
+    return true;
+}
+
+// Entry for (a, b), created with n = 0 if new; NULL only if out of memory.
+// Callers bump n right away, which is what marks the slot used.
+static prof_ent *tab_get(prof_tab *t, uint32_t a, uint32_t b) {
+    if (2u * (t->used + 1u) > t->cap && !tab_grow(t)) return NULL;
+    uint32_t h = tab_hash(a, b) & (t->cap - 1u);
+    for (;;) {
+        prof_ent *e = &t->e[h];
+        if (!e->n) {
+            e->a = a; e->b = b; e->m = 0;
+            t->used++;
+            return e;
+        }
+        if (e->a == a && e->b == b) return e;
+        h = (h + 1u) & (t->cap - 1u);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Lifetime
+// -----------------------------------------------------------------------------
+profile_ctx *profile_create(void) {
+    return (profile_ctx*)calloc(1, sizeof(profile_ctx));
+}
+
+void profile_reset(profile_ctx *p) {
+    if (!p) return;
+    tab_free(&p->blocks);
+    tab_free(&p->edges);
+    tab_free(&p->funcs);
+    p->instrs = p->calls = p->returns = 0;
+    p->depth = 0;
+}
+
+void profile_destroy(profile_ctx *p) {
+    if (!p) return;
+    if (g_prof == p) g_prof = NULL;
+    profile_reset(p);
+    for (uint32_t i = 0; i < p->nsyms; i++) free(p->syms[i].name);
+    free(p->syms);
+    free(p);
+}
+
+void profile_bind(profile_ctx *p) {
+    g_prof = p;
+}
+
+// -----------------------------------------------------------------------------
+// Collection
+// -----------------------------------------------------------------------------
+enum { PROF_NONE, PROF_CALL, PROF_RET };
+
+static int branch_kind(uint32_t i) {
+    if ((i >> 28) == 0xFu)                        // BLX <imm>
+        return ((i & 0x0E000000u) == 0x0A000000u) ? PROF_CALL : PROF_NONE;
+    if ((i & 0x0F000000u) == 0x0B000000u) return PROF_CALL;   // BL
+    if ((i & 0x0FFFFFF0u) == 0x012FFF30u) return PROF_CALL;   // BLX Rm
+    if ((i & 0x0FFFFFFFu) == 0x012FFF1Eu) return PROF_RET;    // BX LR
+    if ((i & 0x0FFFFFFFu) == 0x01A0F00Eu) return PROF_RET;    // MOV PC, LR
+    if ((i & 0x0E108000u) == 0x08108000u) return PROF_RET;    // LDM {..,PC}
+    if ((i & 0x0FFFFFFFu) == 0x049DF004u) return PROF_RET;    // POP {PC}
+    return PROF_NONE;
+}
+
+static void prof_call(profile_ctx *p, uint32_t site, uint32_t target) {
+    prof_ent *e = tab_get(&p->edges, site, target);
+    if (e) e->n++;
+    prof_ent *f = tab_get(&p->funcs, target, 0);
+    if (f) f->n++;
+    p->calls++;
+
+    if (p->depth == PROF_STACK_MAX) {             // keep the innermost frames
+        memmove(p->stack, p->stack + 1, (PROF_STACK_MAX - 1u) * sizeof p->stack[0]);
+        p->depth--;
+    }
+    p->stack[p->depth++] = (prof_frame){ target, site + 4u, p->instrs };
+}
+
+// A return pops back to the frame whose return address it hit; frames above
+// it (tail calls, longjmp) are closed too. Returns that match nothing
+// (exceptions, frames lost off the bottom) leave the stack alone.
+static void prof_return(profile_ctx *p, uint32_t to) {
+    uint32_t k = p->depth;
+    while (k && p->stack[k - 1u].ret != to) k--;
+    if (!k) return;
+    p->returns++;
+    while (p->depth >= k) {
+        const prof_frame *fr = &p->stack[--p->depth];
+        prof_ent *f = tab_get(&p->funcs, fr->entry, 0);
+        if (f) { if (!f->n) f->n = 1; f->m += p->instrs - fr->start; }
+    }
+}
+
+void profile_block(uint32_t pc, uint32_t n) {
+    profile_ctx *p = g_prof;
+    if (!p || !n) return;
+    p->instrs += n;
+    prof_ent *e = tab_get(&p->blocks, pc, n);
+    if (e) e->n++;
+
+    // Only a taken branch out of the last instruction can be a call/return.
+    uint32_t last = pc + 4u * (n - 1u);
+    if (cpu.halted || cpu.r[15] == last + 4u) return;
+    switch (branch_kind(mem_fetch32(last))) {
+    case PROF_CALL: prof_call(p, last, cpu.r[15]); break;
+    case PROF_RET:  prof_return(p, cpu.r[15]);      break;
+    default: break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Symbols
+// -----------------------------------------------------------------------------
+static int sym_cmp(const void *x, const void *y) {
+    const prof_sym *a = (const prof_sym*)x, *b = (const prof_sym*)y;
+    return (a->addr > b->addr) - (a->addr < b->addr);
+}
+
+// Symbol lines in a GNU ld map are "<spaces>0x<addr><spaces><name>";
+// assignments ("_end = .") and section lines don't match.
+static bool map_symbol(const char *s, uint32_t *addr, char *name, size_t name_sz) {
+    if (!isspace((unsigned char)*s)) return false;
+    while (isspace((unsigned char)*s)) s++;
+    if (s[0] != '0' || (s[1] != 'x' && s[1] != 'X')) return false;
+    char *end;
+    unsigned long long v = strtoull(s, &end, 16);
+    if (end == s + 2 || !isspace((unsigned char)*end) || v > 0xFFFFFFFFull) return false;
+    s = end;
+    while (isspace((unsigned char)*s)) s++;
+    if (!(isalpha((unsigned char)*s) || *s == '_' || *s == '.' || *s == '$')) return false;
+    size_t n = 0;
+    while (s[n] && (isalnum((unsigned char)s[n]) || s[n] == '_' || s[n] == '.' || s[n] == '$')) n++;
+    const char *rest = s + n;
+    while (isspace((unsigned char)*rest)) rest++;
+    if (*rest || n >= name_sz) return false;
+    memcpy(name, s, n);
+    name[n] = '\0';
+    *addr = (uint32_t)v;
+    return true;
+}
+
+bool profile_load_map(profile_ctx *p, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        log_printf("[PROFILE] cannot open map '%s'\n", path);
+        return false;
+    }
+    char line[512], name[256];
+    uint32_t addr, added = 0, cap = p->nsyms;
+    while (fgets(line, sizeof line, f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!map_symbol(line, &addr, name, sizeof name)) continue;
+        if (p->nsyms == cap) {
+            uint32_t ncap = cap ? cap * 2u : 64u;
+            prof_sym *s = (prof_sym*)realloc(p->syms, ncap * sizeof *s);
+            if (!s) break;
+            p->syms = s;
+            cap = ncap;
+        }
+        char *dup = (char*)malloc(strlen(name) + 1u);
+        if (!dup) break;
+        strcpy(dup, name);
+        p->syms[p->nsyms++] = (prof_sym){ addr, dup };
+        added++;
+    }
+    fclose(f);
+    qsort(p->syms, p->nsyms, sizeof *p->syms, sym_cmp);
+    log_printf("[PROFILE] %u symbols from %s\n", added, path);
+    return true;
+}
+
+// "name" or "name+0xOFF" for the closest symbol at or below addr, "" if none.
+static const char *sym_name(const profile_ctx *p, uint32_t addr, char *buf, size_t sz) {
+    uint32_t lo = 0, hi = p->nsyms;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2u;
+        if (p->syms[mid].addr <= addr) lo = mid + 1u; else hi = mid;
+    }
+    if (!lo) { buf[0] = '\0'; return buf; }
+    const prof_sym *s = &p->syms[lo - 1u];
+    if (addr == s->addr) snprintf(buf, sz, "%s", s->name);
+    else                 snprintf(buf, sz, "%s+0x%X", s->name, addr - s->addr);
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+static int ent_cmp_n(const void *x, const void *y) {
+    const prof_ent *a = (const prof_ent*)x, *b = (const prof_ent*)y;
+    if (a->n != b->n) return a->n < b->n ? 1 : -1;
+    return (a->a > b->a) - (a->a < b->a);
+}
+
+static int ent_cmp_m(const void *x, const void *y) {
+    const prof_ent *a = (const prof_ent*)x, *b = (const prof_ent*)y;
+    if (a->m != b->m) return a->m < b->m ? 1 : -1;
+    return (a->a > b->a) - (a->a < b->a);
+}
+
+// Used entries of t, sorted; caller frees. *n gets the count.
+static prof_ent *tab_sorted(const prof_tab *t, int (*cmp)(const void*, const void*), uint32_t *n) {
+    *n = 0;
+    prof_ent *out = (prof_ent*)malloc((t->used ? t->used : 1u) * sizeof *out);
+    if (!out) return NULL;
+    for (uint32_t i = 0; i < t->cap; i++)
+        if (t->e[i].n) out[(*n)++] = t->e[i];
+    qsort(out, *n, sizeof *out, cmp);
+    return out;
+}
+
+static double pct(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+void profile_report(const profile_ctx *p, unsigned top) {
+    if (!p) { log_printf("[PROFILE] no profile\n"); return; }
+    char sa[128], sb[128], dis[128];
+    uint32_t n;
+
+    log_printf("[PROFILE] %llu instructions, %u blocks, %llu calls, %llu returns\n",
+               (unsigned long long)p->instrs, p->blocks.used,
+               (unsigned long long)p->calls, (unsigned long long)p->returns);
+
+    // Blocks weighted by instructions retired in them.
+    prof_ent *b = tab_sorted(&p->blocks, ent_cmp_n, &n);
+    if (b) {
+        for (uint32_t i = 0; i < n; i++) b[i].m = b[i].n * b[i].b;
+        qsort(b, n, sizeof *b, ent_cmp_m);
+        log_printf("Hot blocks:\n      instrs      %%       runs  len  start     symbol\n");
+        for (uint32_t i = 0; i < n && i < top; i++)
+            log_printf("%12llu %6.2f %10llu %4u  %08X  %s\n",
+                       (unsigned long long)b[i].m, pct(b[i].m, p->instrs),
+                       (unsigned long long)b[i].n, b[i].b, b[i].a,
+                       sym_name(p, b[i].a, sa, sizeof sa));
+    }
+
+    // Per-address counts expanded from the blocks.
+    prof_tab pcs = {0};
+    for (uint32_t i = 0; b && i < n; i++)
+        for (uint32_t k = 0; k < b[i].b; k++) {
+            prof_ent *e = tab_get(&pcs, b[i].a + 4u * k, 0);
+            if (e) e->n += b[i].n;
+        }
+    free(b);
+    prof_ent *a = tab_sorted(&pcs, ent_cmp_n, &n);
+    if (a) {
+        log_printf("Hot addresses:\n       count      %%  addr      instr     symbol                disasm\n");
+        for (uint32_t i = 0; i < n && i < top; i++) {
+            uint32_t instr = mem_fetch32(a[i].a);
+            disasm_line(a[i].a, instr, dis, sizeof dis);
+            log_printf("%12llu %6.2f  %08X  %08X  %-20s  %s\n",
+                       (unsigned long long)a[i].n, pct(a[i].n, p->instrs), a[i].a, instr,
+                       sym_name(p, a[i].a, sa, sizeof sa), dis);
+        }
+    }
+    free(a);
+    tab_free(&pcs);
+
+    // Functions by inclusive instructions (completed calls only).
+    prof_ent *f = tab_sorted(&p->funcs, ent_cmp_m, &n);
+    if (f && n) {
+        log_printf("Functions (inclusive):\n      instrs      %%      calls  entry     symbol\n");
+        for (uint32_t i = 0; i < n && i < top; i++)
+            log_printf("%12llu %6.2f %10llu  %08X  %s\n",
+                       (unsigned long long)f[i].m, pct(f[i].m, p->instrs),
+                       (unsigned long long)f[i].n, f[i].a, sym_name(p, f[i].a, sa, sizeof sa));
+    }
+    free(f);
+
+    prof_ent *e = tab_sorted(&p->edges, ent_cmp_n, &n);
+    if (e && n) {
+        log_printf("Call edges:\n       calls  site      target    caller -> callee\n");
+        for (uint32_t i = 0; i < n && i < top; i++)
+            log_printf("%12llu  %08X  %08X  %s -> %s\n",
+                       (unsigned long long)e[i].n, e[i].a, e[i].b,
+                       sym_name(p, e[i].a, sa, sizeof sa), sym_name(p, e[i].b, sb, sizeof sb));
+    }
+    free(e);
+}
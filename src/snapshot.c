@@ -0,0 +1,53 @@
+// src/snapshot.c — little-endian stream helpers for VM snapshots
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "snapshot.h"
+
+void snap_put(snap_io *s, const void *p, size_t n) {
+    if (s->ok && n && fwrite(p, 1, n, s->f) != n) s->ok = false;
+}
+
+void snap_get(snap_io *s, void *p, size_t n) {
+    if (s->ok && n && fread(p, 1, n, s->f) != n) s->ok = false;
+}
+
+void snap_put_u32(snap_io *s, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    snap_put(s, b, sizeof b);
+}
+
+void snap_put_u64(snap_io *s, uint64_t v) {
+    snap_put_u32(s, (uint32_t)v);
+    snap_put_u32(s, (uint32_t)(v >> 32));
+}
+
+uint32_t snap_get_u32(snap_io *s) {
+    uint8_t b[4] = {0};
+    snap_get(s, b, sizeof b);
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+uint64_t snap_get_u64(snap_io *s) {
+    uint64_t lo = snap_get_u32(s);
+    uint64_t hi = snap_get_u32(s);
+    return lo | (hi << 32);
+}
+
+void snap_section_begin(snap_io *s, uint32_t tag) {
+    snap_put_u32(s, tag);
+    s->sect_start = ftell(s->f);
+    snap_put_u32(s, 0);                 // length, patched by snap_section_end
+}
+
+void snap_section_end(snap_io *s) {
+    if (!s->ok) return;
+    long end = ftell(s->f);
+    if (end < 0 || s->sect_start < 0 || fseek(s->f, s->sect_start, SEEK_SET) != 0) {
+        s->ok = false;
+        return;
+    }
+    snap_put_u32(s, (uint32_t)(end - s->sect_start - 4));
+    if (fseek(s->f, end, SEEK_SET) != 0) s->ok = false;
+}
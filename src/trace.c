@@ -0,0 +1,239 @@
+// src/trace.c — binary instruction trace (ring buffer + writer thread)
+// The CPU thread is the only producer and the writer thread the only
+// consumer, so the ring needs no lock: each side owns one index and
+// publishes it with a release store. The producer never allocates; when the
+// ring is full it waits for the writer rather than dropping records.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>     // sched_yield
+#include <time.h>      // nanosleep
+
+#include "trace.h"
+#include "cpu.h"
+#include "cpu_flags.h" // cpu_flags_sync()
+#include "mem.h"       // mem_set_watch()
+#include "disasm.h"
+#include "log.h"
+
+#define TRACE_RING_WORDS (1u << 20)        // 4 MiB per trace (power of 2)
+#define TRACE_MEM_MAX    32u               // accesses kept per instruction
+#define TRACE_REC_MAX    (3u + 16u + 3u * TRACE_MEM_MAX)
+
+struct trace_ctx {
+    uint32_t  *ring;
+    uint32_t   head;                       // written by the CPU thread
+    uint32_t   tail;                       // written by the writer thread
+    bool       stop;
+    bool       io_error;
+    FILE      *f;
+    pthread_t  writer;
+    uint64_t   records;
+
+    // record being built for the current instruction
+    uint32_t   mem[3u * TRACE_MEM_MAX];
+    uint32_t   n_mem;
+    bool       mem_lost;
+};
+
+// Trace of the instruction executing on this thread (NULL outside trace_step).
+static VM_TLS trace_ctx *g_trace_cur;
+
+static inline uint32_t load_acq(const uint32_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline void     store_rel(uint32_t *p, uint32_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+// -----------------------------------------------------------------------------
+// Writer thread
+// -----------------------------------------------------------------------------
+static void *trace_writer(void *arg) {
+    trace_ctx *t = (trace_ctx*)arg;
+    for (;;) {
+        uint32_t head = load_acq(&t->head);
+        uint32_t tail = t->tail;
+        if (head == tail) {
+            if (__atomic_load_n(&t->stop, __ATOMIC_ACQUIRE) && load_acq(&t->head) == tail) break;
+            struct timespec ts = { 0, 200000 };     // 200 us
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        // Up to the end of the buffer, then wrap on the next pass.
+        uint32_t at = tail & (TRACE_RING_WORDS - 1u);
+        uint32_t n  = head - tail;
+        if (n > TRACE_RING_WORDS - at) n = TRACE_RING_WORDS - at;
+        if (fwrite(t->ring + at, sizeof(uint32_t), n, t->f) != n) t->io_error = true;
+        store_rel(&t->tail, tail + n);
+    }
+    return NULL;
+}
+
+// -----------------------------------------------------------------------------
+// Producer side
+// -----------------------------------------------------------------------------
+static void trace_watch(uint32_t addr, uint32_t value, unsigned size, bool write) {
+    trace_ctx *t = g_trace_cur;
+    if (!t) return;
+    if (t->n_mem >= TRACE_MEM_MAX) { t->mem_lost = true; return; }
+    uint32_t *m = &t->mem[3u * t->n_mem++];
+    m[0] = addr;
+    m[1] = value;
+    m[2] = size | (write ? TRACE_MEM_WRITE : 0u);
+}
+
+static void ring_put(trace_ctx *t, const uint32_t *w, uint32_t n) {
+    uint32_t head = t->head;
+    while (TRACE_RING_WORDS - (head - load_acq(&t->tail)) < n)
+        sched_yield();                      // full: let the writer catch up
+    for (uint32_t i = 0; i < n; i++)
+        t->ring[(head + i) & (TRACE_RING_WORDS - 1u)] = w[i];
+    store_rel(&t->head, head + n);
+}
+
+trace_ctx *trace_start(const char *path) {
+    trace_ctx *t = (trace_ctx*)calloc(1, sizeof *t);
+    if (!t) return NULL;
+    t->ring = (uint32_t*)malloc(TRACE_RING_WORDS * sizeof(uint32_t));
+    t->f    = path ? fopen(path, "wb") : NULL;
+    if (!t->ring || !t->f) {
+        log_printf("[TRACE] cannot start trace to '%s'\n", path ? path : "(null)");
+        if (t->f) fclose(t->f);
+        free(t->ring);
+        free(t);
+        return NULL;
+    }
+
+    uint32_t hdr[2] = { TRACE_VERSION, 0x01020304u };
+    fwrite(TRACE_MAGIC, 1, 8, t->f);
+    fwrite(hdr, sizeof hdr[0], 2, t->f);
+
+    if (pthread_create(&t->writer, NULL, trace_writer, t) != 0) {
+        log_printf("[TRACE] cannot start writer thread\n");
+        fclose(t->f);
+        free(t->ring);
+        free(t);
+        return NULL;
+    }
+    mem_set_watch(trace_watch);
+    return t;
+}
+
+bool trace_stop(trace_ctx *t) {
+    if (!t) return true;
+    mem_set_watch(NULL);
+    __atomic_store_n(&t->stop, true, __ATOMIC_RELEASE);
+    pthread_join(t->writer, NULL);
+    bool ok = !t->io_error;
+    if (fclose(t->f) != 0) ok = false;
+    free(t->ring);
+    free(t);
+    return ok;
+}
+
+uint64_t trace_records(const trace_ctx *t) {
+    return t ? t->records : 0;
+}
+
+void trace_step(trace_ctx *t) {
+    uint32_t before[16];
+    cpu_flags_sync();
+    memcpy(before, cpu.r, 15 * sizeof(uint32_t));
+    before[15] = cpu.cpsr;
+    uint32_t pc    = cpu.r[15];
+    uint32_t instr = mem_fetch32(pc);
+
+    t->n_mem    = 0;
+    t->mem_lost = false;
+    g_trace_cur = t;
+    cpu_step();
+    g_trace_cur = NULL;
+    cpu_flags_sync();
+
+    uint32_t rec[TRACE_REC_MAX];
+    uint32_t n = 3, info = 0;
+    for (int r = 0; r < 15; r++) {
+        if (cpu.r[r] == before[r]) continue;
+        info |= 1u << r;
+        rec[n++] = cpu.r[r];
+    }
+    if (cpu.cpsr != before[15]) { info |= TRACE_INFO_CPSR; rec[n++] = cpu.cpsr; }
+    memcpy(&rec[n], t->mem, 3u * t->n_mem * sizeof(uint32_t));
+    n += 3u * t->n_mem;
+    info |= t->n_mem << 16;
+    if (t->mem_lost)      info |= TRACE_INFO_MEM_LOST;
+    if (cpu_is_halted())  info |= TRACE_INFO_HALTED;
+
+    rec[0] = pc;
+    rec[1] = instr;
+    rec[2] = info;
+    ring_put(t, rec, n);
+    t->records++;
+}
+
+// -----------------------------------------------------------------------------
+// Offline decoder
+// -----------------------------------------------------------------------------
+static bool read_words(FILE *f, uint32_t *w, uint32_t n) {
+    return fread(w, sizeof(uint32_t), n, f) == n;
+}
+
+bool trace_decode(const char *in_path, const char *out_path) {
+    FILE *in = fopen(in_path, "rb");
+    if (!in) {
+        log_printf("[TRACE] cannot open '%s'\n", in_path);
+        return false;
+    }
+    char magic[8];
+    uint32_t hdr[2];
+    if (fread(magic, 1, 8, in) != 8 || memcmp(magic, TRACE_MAGIC, 8) != 0 ||
+        !read_words(in, hdr, 2) || hdr[0] != TRACE_VERSION || hdr[1] != 0x01020304u) {
+        log_printf("[TRACE] '%s' is not a version %u trace from this host\n", in_path, TRACE_VERSION);
+        fclose(in);
+        return false;
+    }
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        log_printf("[TRACE] cannot create '%s'\n", out_path);
+        fclose(in);
+        return false;
+    }
+
+    bool ok = true;
+    uint64_t count = 0;
+    uint32_t rec[3];
+    while (read_words(in, rec, 3)) {
+        uint32_t pc = rec[0], instr = rec[1], info = rec[2];
+        char buf[128];
+        disasm_line(pc, instr, buf, sizeof buf);
+        fprintf(out, "%08X:       %08X        %s\n", pc, instr, buf);
+
+        uint32_t v;
+        for (int r = 0; r < 15 && ok; r++) {
+            if (!(info & (1u << r))) continue;
+            if ((ok = read_words(in, &v, 1)))
+                fprintf(out, "                  r%d <= 0x%08X\n", r, v);
+        }
+        if (ok && (info & TRACE_INFO_CPSR) && (ok = read_words(in, &v, 1))) {
+            fprintf(out, "                  CPSR <= 0x%08X\n", v);
+        }
+        for (uint32_t i = 0; i < TRACE_INFO_NMEM(info) && ok; i++) {
+            uint32_t m[3];
+            if (!(ok = read_words(in, m, 3))) break;
+            fprintf(out, "                  %s%u [0x%08X] %s 0x%0*X\n",
+                    (m[2] & TRACE_MEM_WRITE) ? "W" : "R", (m[2] & 0xFFu) * 8u, m[0],
+                    (m[2] & TRACE_MEM_WRITE) ? "<=" : "=>", (int)(m[2] & 0xFFu) * 2, m[1]);
+        }
+        if (!ok) break;
+        if (info & TRACE_INFO_MEM_LOST) fprintf(out, "                  (more accesses not recorded)\n");
+        if (info & TRACE_INFO_HALTED)   fprintf(out, "                  HALT\n");
+        count++;
+    }
+    if (!ok) log_printf("[TRACE] '%s' ends mid-record\n", in_path);
+    log_printf("[TRACE] %llu instructions decoded\n", (unsigned long long)count);
+
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return ok;
+}
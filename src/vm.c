@@ -9,6 +9,7 @@
 
 #include "vm.h"
 #include "cpu.h"
+#include "cpu_flags.h"   // cpu_flags_sync()
 #include "board.h"       // DTB_ADDR
 #include "dtb_blob.h"
 #include "mem.h"
@@ -16,8 +17,26 @@
 #include "log.h"
 #include "debug.h"
 #include "hw_bus.h"
+#include "tcache.h"      // drop predecoded blocks over loaded images
 #include "dev_rtc.h"     // RTC mapping helpers
 #include "dev_nvram.h"   // NVRAM mapping helpers
+#include "dev_disk.h"    // disk0 snapshot hooks
+#include "hw.h"          // guest-cycle clock
+#include "dev_uart.h"
+#include "dev_intc.h"    // interrupt controller
+#include "dev_timer.h"
+#include "disk_manager.h" // disk_shutdown()
+#include "snapshot.h"
+#include "trace.h"
+#include "profile.h"
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#include <process.h>  // _getpid
+#define vm_getpid() _getpid()
+#else
+#include <unistd.h>   // getpid
+#define vm_getpid() getpid()
+#endif
 
 typedef struct VM {
     CPU         cpu;
@@ -26,32 +45,41 @@ typedef struct VM {
     uint64_t    cycle;
     bool        halted;
     debug_flags_t debug;
+    cpu_engine_t  engine;       // run loop, bound by vm_activate()
 
-    struct {
-        uint32_t base, size;
-        vm_mmio_read_fn  rfn;
-        vm_mmio_write_fn wfn;
-        void    *ctx;
-    } mmio[16];
-    int n_mmio;
 	bool devices_inited;    // <-- add this line
+
+    // Per-VM core/device state, bound to the calling thread by vm_activate().
+    mem_ctx    *mem;
+    tc_state   *tc;
+    hw_ctx     *hw;
+
+    trace_ctx  *trace;      // binary trace in progress, NULL = off
+    profile_ctx *prof;      // counts + symbols, kept after "profile off"
+    bool        prof_on;
+
+    // Translation cache on disk (vm_tcache_*): images loaded so far.
+    char        tc_dir[260];        // "" = off
+    uint64_t    img_hash;           // over every vm_load_binary(), in order
+    uint32_t    img_lo, img_hi;     // span they cover (lo == hi: none)
+    uint32_t    tc_loaded;          // blocks the cache file supplied
+
+    char        nvram_path[260];    // NVRAM backing file, "" = memory only
 } VM;
 
+// Directory new VMs start with (vm_tcache_default_dir).
+static char g_tc_default_dir[260];
+
 // --------- forward declarations ----------
 
+static void vm_tcache_note_image(VM* vm, uint32_t addr, size_t size);
+
 // --- device/DTB setup helpers (local to vm.c) ---
 static void vm_map_rtc(void);
-static void vm_map_nvram(void);
+static void vm_map_nvram(VM* vm);
 static void vm_place_dtb(struct VM* vm);
 static void vm_init_devices_and_boot(struct VM* vm);
 
-// TEMP: ensure prototype is visible even if hw_bus.h is stale
-bool hw_bus_map_region(const char* name,
-                       uint32_t base,
-                       uint32_t size,
-                       uint32_t (*read32)(uint32_t addr),
-                       void (*write32)(uint32_t addr, uint32_t value));
-
 
 // ---------- helper utils? ----------
 
@@ -75,10 +103,33 @@ static inline void vm_trace_objdump_line(uint32_t pc, uint32_t instr) {
 VM* vm_create(void) {
     VM *vm = (VM*)calloc(1, sizeof(VM));
     if (!vm) return NULL;
+    vm->mem = mem_ctx_create();
+    vm->tc  = tcache_create();
+    vm->hw  = hw_ctx_create();
+    if (!vm->mem || !vm->tc || !vm->hw) {
+        log_printf("[ERROR] vm_create: out of memory\n");
+        vm_destroy(vm);
+        return NULL;
+    }
+    snprintf(vm->tc_dir, sizeof vm->tc_dir, "%s", g_tc_default_dir);
+    vm->engine = CPU_ENGINE_DEFAULT;
+    vm_activate(vm);
     vm_reset(vm);
     return vm;
 }
 
+// Point this thread's CPU core, memory, translation cache and devices at vm.
+// Every vm_* entry point does this itself; a thread drives one VM at a time.
+void vm_activate(VM* vm) {
+    if (!vm) return;
+    mem_ctx_bind(vm->mem);
+    tcache_bind(vm->tc);
+    hw_ctx_bind(vm->hw);
+    profile_bind(vm->prof_on ? vm->prof : NULL);
+    debug_flags = vm->debug;
+    cpu_set_engine(vm->engine);
+}
+
 // Attach/allocate RAM later. Returns false if RAM already attached.
 bool vm_add_ram(VM* vm, size_t ram_size) {
     if (!vm || ram_size == 0) return false;
@@ -93,7 +144,7 @@ bool vm_add_ram(VM* vm, size_t ram_size) {
     }
     vm->ram_size = ram_size;
 
-    // Bridge to current mem.c singleton:
+    vm_activate(vm);
 	mem_init();                        // initialize memory subsystem once
 	mem_bind(vm->ram, vm->ram_size);   // then bind the VM's RAM buffer
 
@@ -112,6 +163,16 @@ size_t vm_ram_size(const VM* vm) { return vm ? vm->ram_size : 0; }
 
 void vm_destroy(VM* vm) {
     if (!vm) return;
+    if (vm->hw) {
+        vm_activate(vm);
+        vm_trace_stop(vm);
+        vm_tcache_save(vm);        // only if this run decoded more than the file had
+        disk_shutdown();           // unmap images before the slot table goes
+    }
+    profile_destroy(vm->prof);
+    hw_ctx_destroy(vm->hw);
+    tcache_destroy(vm->tc);
+    mem_ctx_destroy(vm->mem);
     free(vm->ram);
     free(vm);
 }
@@ -123,8 +184,7 @@ void vm_reset(VM* vm) {
     else                         vm->cpu.r[13] = 0;
     vm->cpu.r[15] = ENTRY_POINT;
     vm->cycle = 0;
-    vm->halted = false;
-    cpu_clear_halt();              // <-- clear old halts in the core
+    vm->halted = false;            // memset above also cleared the core's halt latch
 }
 
 // ---- run control ----
@@ -140,7 +200,7 @@ bool vm_step(VM* vm)
 {
     if (!vm || !vm->ram || vm->ram_size == 0) return false;
 
-    mem_bind(vm->ram, vm->ram_size);
+    vm_activate(vm);
     cpu = vm->cpu;
 
     if (vm->debug & DBG_DISASM) {
@@ -151,9 +211,11 @@ bool vm_step(VM* vm)
 		log_printf("%08X:       %08X        %s\n", pc, instr, buf);
     }
 
-    cpu_step();
+    if (vm->trace) trace_step(vm->trace);
+    else           cpu_step();
     vm->cycle++;
 
+    cpu_flags_sync();   // CPSR in vm->cpu is read directly (regs, get_cpsr)
     vm->cpu = cpu;
     return !cpu_is_halted();
 }
@@ -162,10 +224,19 @@ bool vm_run(VM* vm, uint64_t max_cycles)
 {
     if (!vm || !vm->ram || vm->ram_size == 0) return false;
 
-    mem_bind(vm->ram, vm->ram_size);
+    vm_activate(vm);
     cpu = vm->cpu;
 
     uint64_t c = 0;
+
+    // Threaded engine: per-instruction debug output is decided once here,
+    // not inside the loop; any of these flags (or a binary trace) keeps the
+    // stepping loop.
+    if (vm->engine == CPU_ENGINE_THREADED_LOOP && !vm->trace &&
+        !(vm->debug & (DBG_DISASM | DBG_TRACE | DBG_K12 | DBG_K12STATS))) {
+        c = cpu_run_threaded(max_cycles);
+    }
+
     while (!cpu_is_halted() && (max_cycles == 0 || c < max_cycles)) {
 
         if (vm->debug & DBG_DISASM) {
@@ -176,15 +247,71 @@ bool vm_run(VM* vm, uint64_t max_cycles)
 			log_printf("%08X:       %08X        %s\n", pc, instr, buf);
         }
 
-        cpu_step();
+        if (vm->trace) trace_step(vm->trace);
+        else           cpu_step();
         c++;
     }
 
+    cpu_flags_sync();   // CPSR in vm->cpu is read directly (regs, get_cpsr)
     vm->cpu = cpu;
     vm->cycle += c;
     return !cpu_is_halted();
 }
 
+// ---- binary trace ----
+bool vm_trace_start(VM* vm, const char* path) {
+    if (!vm || !path) return false;
+    vm_activate(vm);
+    vm_trace_stop(vm);
+    vm->trace = trace_start(path);
+    if (!vm->trace) return false;
+    log_printf("[TRACE] recording to %s\n", path);
+    return true;
+}
+
+bool vm_trace_stop(VM* vm) {
+    if (!vm || !vm->trace) return true;
+    vm_activate(vm);
+    uint64_t n = trace_records(vm->trace);
+    bool ok = trace_stop(vm->trace);
+    vm->trace = NULL;
+    log_printf("[TRACE] stopped: %" PRIu64 " instructions%s\n", n, ok ? "" : " (write errors)");
+    return ok;
+}
+
+// ---- profiler ----
+static bool vm_profile_ensure(VM* vm) {
+    if (!vm->prof) vm->prof = profile_create();
+    return vm->prof != NULL;
+}
+
+bool vm_profile_start(VM* vm) {
+    if (!vm || !vm_profile_ensure(vm)) return false;
+    profile_reset(vm->prof);
+    vm->prof_on = true;
+    vm_activate(vm);
+    log_printf("[PROFILE] on\n");
+    return true;
+}
+
+void vm_profile_stop(VM* vm) {
+    if (!vm) return;
+    vm->prof_on = false;
+    vm_activate(vm);
+    log_printf("[PROFILE] off\n");
+}
+
+bool vm_profile_load_map(VM* vm, const char* path) {
+    if (!vm || !path || !vm_profile_ensure(vm)) return false;
+    return profile_load_map(vm->prof, path);
+}
+
+void vm_profile_report(VM* vm, unsigned top) {
+    if (!vm) return;
+    vm_activate(vm);
+    profile_report(vm->prof, top);
+}
+
 void vm_halt(VM* vm) { vm->halted = true; }
 bool vm_is_halted(const VM* vm) { return vm->halted; }
 
@@ -193,13 +320,16 @@ bool vm_load_image(VM* vm, const void* data, size_t len, uint32_t addr) {
     if (!vm || !data) return false;
     if (!vm_require_ram(vm, "vm_load_image")) return false;
     if (addr > vm->ram_size || len > vm->ram_size - addr) return false;
+    vm_activate(vm);
     memcpy(vm->ram + addr, data, len);
+    tcache_invalidate_range(addr, len);
     return true;
 }
 
 bool vm_read_mem(VM* vm, uint32_t addr, void* out, size_t len) {
     if (!vm || !out) return false;
     if (!vm_require_ram(vm, "vm_read_mem")) return false;
+    vm_activate(vm);
     uint8_t *p = (uint8_t*)out;
     for (size_t i = 0; i < len; i++) p[i] = mem_read8(addr + (uint32_t)i);
     return true;
@@ -208,6 +338,7 @@ bool vm_read_mem(VM* vm, uint32_t addr, void* out, size_t len) {
 bool vm_write_mem(VM* vm, uint32_t addr, const void* in, size_t len) {
     if (!vm || !in) return false;
     if (!vm_require_ram(vm, "vm_write_mem")) return false;
+    vm_activate(vm);
     const uint8_t *p = (const uint8_t*)in;
     for (size_t i = 0; i < len; i++) mem_write8(addr + (uint32_t)i, p[i]);
     return true;
@@ -223,14 +354,16 @@ void vm_set_reg(VM* vm, int idx, uint32_t value) {
     vm->cpu.r[idx] = value;
 }
 uint32_t vm_get_cpsr(const VM* vm) { return vm ? vm->cpu.cpsr : 0; }
+uint64_t vm_cycles(const VM* vm)   { return vm ? vm->cycle : 0; }
 void     vm_set_cpsr(VM* vm, uint32_t v) { if (vm) vm->cpu.cpsr = v; }
 
 // ---- MMIO registry ----
+// Windows live in the bus map (hw_bus.c), which is what mem.c dispatches on.
 bool vm_map_mmio(VM* vm, uint32_t base, uint32_t size,
                  vm_mmio_read_fn rfn, vm_mmio_write_fn wfn, void* ctx) {
-    if (!vm || vm->n_mmio >= (int)(sizeof vm->mmio / sizeof vm->mmio[0])) return false;
-    vm->mmio[vm->n_mmio++] = (typeof(vm->mmio[0])){ base, size, rfn, wfn, ctx };
-    return true;
+    if (!vm) return false;
+    vm_activate(vm);
+    return hw_bus_map_mmio("mmio", base, size, rfn, wfn, ctx);
 }
 
 // If your vm.h prototype is: int vm_load_binary(VM *vm, const char *path, uint32_t addr);
@@ -273,12 +406,15 @@ bool vm_load_binary(VM* vm, const char* path, uint32_t addr) {
 
     size_t n = fread(vm->ram + addr, 1, size, f);
     fclose(f);
+    vm_activate(vm);
+    tcache_invalidate_range(addr, n);
     if (n != size) {
         log_printf("Short read loading '%s' (got %zu of %zu)\n", path, n, size);
         return false;
     }
 
     log_printf("[LOAD] %s @ 0x%08X (%zu bytes)\n", path, addr, size);
+    vm_tcache_note_image(vm, addr, size);
     return true;
 }
 
@@ -296,13 +432,28 @@ void vm_dump_regs(VM* vm) {
 void vm_set_debug(VM *vm, debug_flags_t flags) {
     if (!vm) return;
     vm->debug = flags;
-    debug_flags = flags;  // keep CPU/handlers in sync
+    vm_activate(vm);      // keeps this thread's CPU/handlers in sync
     // log_printf("[DEBUG] debug_flags set to 0x%08X\n", flags); // optional
 }
 
+debug_flags_t vm_get_debug(const VM *vm) {
+    return vm ? vm->debug : DBG_NONE;
+}
+
+void vm_set_engine(VM *vm, cpu_engine_t engine) {
+    if (!vm) return;
+    vm->engine = engine;
+    vm_activate(vm);
+}
+
+cpu_engine_t vm_get_engine(const VM *vm) {
+    return vm ? vm->engine : CPU_ENGINE_DEFAULT;
+}
+
 void vm_clear_halt(VM *vm) {
-    (void)vm;          // if you don’t need it yet, silence unused
-    cpu_clear_halt();  // delegate to CPU
+    if (!vm) return;
+    vm->cpu.halted = false;   // the core's latch travels with the VM's CPU
+    cpu_clear_halt();
 }
 
 static void vm_map_rtc(void) {
@@ -352,21 +503,324 @@ static void vm_place_dtb(struct VM* vm) {
 
 // Call once during startup, after RAM is ready and before you start executing:
 static void vm_init_devices_and_boot(struct VM* vm) {
-    static bool g_devices_inited = false;
-    if (!g_devices_inited) {
+    if (!vm->devices_inited) {
         vm_map_rtc();
-        vm_map_nvram();
-        g_devices_inited = true;
+        vm_map_nvram(vm);
+        dev_uart_init(UART0_BASE);
+        dev_intc_init(INTC_BASE_ADDR);
+        dev_timer_init(TIMER_BASE_ADDR);
+        vm->devices_inited = true;
     }
     // Place (or refresh) the DTB image each time RAM is (re)bound,
     // so guest always sees a valid blob at DTB_ADDR.
     vm_place_dtb(vm);
 }
 
-static void vm_map_nvram(void) {
-    dev_nvram_init("nvram.bin");
+static void vm_map_nvram(VM* vm) {
+    dev_nvram_init(vm->nvram_path);
     hw_bus_map_region("nvram", NVRAM_BASE_ADDR, NVRAM_MMIO_SIZE,
                       /*read32=*/dev_nvram_read32,
                       /*write32=*/dev_nvram_write32);
 }
 
+// ---- translation cache on disk ----
+// <dir>/<image hash>.tc: "ARMVMTC\0", u32 version, u64 execute_rules_hash(),
+// u64 image hash, u32 lo, u32 hi, then tcache_save()'s block list. The image
+// hash (FNV-1a) covers the address, size and bytes of every binary loaded
+// into the VM, in order, so a file only ever meets the code it was made
+// from; blocks are validated word by word again as they are installed.
+#define TC_FILE_MAGIC   "ARMVMTC"
+#define TC_FILE_VERSION 1u
+
+static uint64_t tc_hash_bytes(uint64_t h, const void *p, size_t n) {
+    const uint8_t *b = (const uint8_t*)p;
+    for (size_t i = 0; i < n; ++i) { h ^= b[i]; h *= 0x100000001B3ull; }
+    return h;
+}
+
+static void tc_file_path(const VM* vm, char *out, size_t cap) {
+    snprintf(out, cap, "%s/%016" PRIx64 ".tc", vm->tc_dir, vm->img_hash);
+}
+
+static void vm_tcache_load(VM* vm) {
+    char path[300];
+    tc_file_path(vm, path, sizeof path);
+    FILE *f = fopen(path, "rb");
+    if (!f) return;                    // not cached yet
+    snap_io s = { .f = f, .ok = true, .sect_start = -1 };
+    char magic[8];
+    snap_get(&s, magic, sizeof magic);
+    uint32_t ver   = snap_get_u32(&s);
+    uint64_t rules = snap_get_u64(&s);
+    uint64_t img   = snap_get_u64(&s);
+    uint32_t lo    = snap_get_u32(&s);
+    uint32_t hi    = snap_get_u32(&s);
+    int n = -1;
+    if (s.ok && memcmp(magic, TC_FILE_MAGIC, 8) == 0 && ver == TC_FILE_VERSION &&
+        rules == execute_rules_hash() && img == vm->img_hash &&
+        lo == vm->img_lo && hi == vm->img_hi)
+        n = tcache_load(&s);
+    fclose(f);
+    if (n < 0) {
+        log_printf("[TCACHE] ignoring stale or corrupt %s\n", path);
+        return;
+    }
+    vm->tc_loaded = (uint32_t)n;
+    log_printf("[TCACHE] %d blocks from %s\n", n, path);
+}
+
+static void vm_tcache_note_image(VM* vm, uint32_t addr, size_t size) {
+    uint32_t end = addr + (uint32_t)size;
+    uint32_t hdr[2] = { addr, (uint32_t)size };
+    if (vm->img_lo == vm->img_hi) { vm->img_hash = 0xCBF29CE484222325ull; vm->img_lo = addr; vm->img_hi = end; }
+    if (addr < vm->img_lo) vm->img_lo = addr;
+    if (end  > vm->img_hi) vm->img_hi = end;
+    vm->img_hash = tc_hash_bytes(vm->img_hash, hdr, sizeof hdr);
+    vm->img_hash = tc_hash_bytes(vm->img_hash, vm->ram + addr, size);
+    vm->tc_loaded = 0;
+    if (vm->tc_dir[0]) vm_tcache_load(vm);
+}
+
+void vm_nvram_file(VM* vm, const char* path) {
+    if (!vm) return;
+    snprintf(vm->nvram_path, sizeof vm->nvram_path, "%s", path ? path : "");
+    if (!vm->devices_inited) return;   // vm_add_ram() picks it up
+    vm_activate(vm);
+    dev_nvram_init(vm->nvram_path);
+}
+
+void vm_tcache_default_dir(const char* dir) {
+    snprintf(g_tc_default_dir, sizeof g_tc_default_dir, "%s", dir ? dir : "");
+}
+
+void vm_tcache_dir(VM* vm, const char* dir) {
+    if (!vm) return;
+    snprintf(vm->tc_dir, sizeof vm->tc_dir, "%s", dir ? dir : "");
+}
+
+bool vm_tcache_save(VM* vm) {
+    if (!vm || !vm->tc_dir[0] || vm->img_lo == vm->img_hi) return false;
+    vm_activate(vm);
+
+    // Written under a private name (process id plus VM address) and renamed
+    // into place, so VMs on other threads or processes only ever open a
+    // complete file.
+    char path[300], tmp[360];
+    tc_file_path(vm, path, sizeof path);
+    snprintf(tmp, sizeof tmp, "%s.%ld.%p.tmp", path, (long)vm_getpid(), (void*)vm);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        log_printf("[TCACHE] cannot create '%s': %s\n", tmp, strerror(errno));
+        return false;
+    }
+    snap_io s = { .f = f, .ok = true, .sect_start = -1 };
+    snap_put(&s, TC_FILE_MAGIC, 8);
+    snap_put_u32(&s, TC_FILE_VERSION);
+    snap_put_u64(&s, execute_rules_hash());
+    snap_put_u64(&s, vm->img_hash);
+    snap_put_u32(&s, vm->img_lo);
+    snap_put_u32(&s, vm->img_hi);
+    uint32_t n = tcache_save(&s, vm->img_lo, vm->img_hi);
+    bool ok = s.ok;
+    if (fclose(f) != 0) ok = false;
+    if (!ok || n <= vm->tc_loaded) {   // failed, or nothing the file lacks
+        remove(tmp);
+        if (!ok) log_printf("[TCACHE] write to '%s' failed\n", tmp);
+        return ok;
+    }
+    remove(path);                      // rename() won't replace on Windows
+    if (rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    vm->tc_loaded = n;
+    log_printf("[TCACHE] saved %u blocks to %s\n", n, path);
+    return true;
+}
+
+// ---- snapshots ----
+// Sections: CPU (registers, PSRs, halt state), TIME (instruction count and
+// device clock), RAM (size, then every non-zero 4 KiB page as index+data),
+// then one section per device. Disk contents stay in the image/overlay.
+#define SNAP_PAGE 4096u
+#define SNAP_RAM_END 0xFFFFFFFFu
+
+enum {
+    SNAP_CPU  = SNAP_TAG('C','P','U',' '),
+    SNAP_TIME = SNAP_TAG('T','I','M','E'),
+    SNAP_RAM  = SNAP_TAG('R','A','M',' '),
+    SNAP_DSK0 = SNAP_TAG('D','S','K','0'),
+    SNAP_RTC  = SNAP_TAG('R','T','C',' '),
+    SNAP_NVRM = SNAP_TAG('N','V','R','M'),
+    SNAP_INTC = SNAP_TAG('I','N','T','C'),
+    SNAP_TIMR = SNAP_TAG('T','I','M','R'),
+    SNAP_END  = SNAP_TAG('E','N','D',' '),
+};
+
+static bool page_is_zero(const uint8_t *p) {
+    static const uint8_t zero[SNAP_PAGE];
+    return memcmp(p, zero, SNAP_PAGE) == 0;
+}
+
+bool vm_snapshot_save(VM* vm, const char* path) {
+    if (!vm || !path || !vm_require_ram(vm, "vm_snapshot_save")) return false;
+    vm_activate(vm);
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        log_printf("[SNAPSHOT] cannot create '%s': %s\n", path, strerror(errno));
+        return false;
+    }
+    snap_io s = { .f = f, .ok = true, .sect_start = -1 };
+    snap_put(&s, SNAP_MAGIC, 8);
+    snap_put_u32(&s, SNAP_VERSION);
+
+    const CPU *c = &vm->cpu;       // flags already folded by vm_run/vm_step
+    snap_section_begin(&s, SNAP_CPU);
+    for (int i = 0; i < 16; i++) snap_put_u32(&s, c->r[i]);
+    snap_put_u32(&s, c->cpsr);
+    snap_put_u32(&s, c->spsr);
+    snap_put_u32(&s, c->spsr_svc);
+    snap_put_u32(&s, c->lr_svc);
+    snap_put_u32(&s, c->sp_svc);
+    snap_put_u32(&s, c->halted);
+    snap_put_u32(&s, vm->halted);
+    snap_put_u32(&s, c->sp_irq);
+    snap_put_u32(&s, c->lr_irq);
+    snap_put_u32(&s, c->spsr_irq);
+    snap_section_end(&s);
+
+    snap_section_begin(&s, SNAP_TIME);
+    snap_put_u64(&s, vm->cycle);
+    snap_put_u64(&s, hw_bus_now());
+    snap_section_end(&s);
+
+    size_t pages = 0;
+    snap_section_begin(&s, SNAP_RAM);
+    snap_put_u64(&s, vm->ram_size);
+    for (size_t off = 0; off < vm->ram_size && s.ok; off += SNAP_PAGE) {
+        size_t n = vm->ram_size - off < SNAP_PAGE ? vm->ram_size - off : SNAP_PAGE;
+        uint8_t tail[SNAP_PAGE];
+        const uint8_t *p = vm->ram + off;
+        if (n < SNAP_PAGE) {       // partial last page: pad with zeros
+            memset(tail, 0, sizeof tail);
+            memcpy(tail, p, n);
+            p = tail;
+        }
+        if (page_is_zero(p)) continue;
+        snap_put_u32(&s, (uint32_t)(off / SNAP_PAGE));
+        snap_put(&s, p, SNAP_PAGE);
+        pages++;
+    }
+    snap_put_u32(&s, SNAP_RAM_END);
+    snap_section_end(&s);
+
+    snap_section_begin(&s, SNAP_DSK0); dev_disk0_snapshot_save(&s); snap_section_end(&s);
+    snap_section_begin(&s, SNAP_RTC);  dev_rtc_snapshot_save(&s);   snap_section_end(&s);
+    snap_section_begin(&s, SNAP_NVRM); dev_nvram_snapshot_save(&s); snap_section_end(&s);
+    snap_section_begin(&s, SNAP_INTC); dev_intc_snapshot_save(&s);  snap_section_end(&s);
+    snap_section_begin(&s, SNAP_TIMR); dev_timer_snapshot_save(&s); snap_section_end(&s);
+    snap_section_begin(&s, SNAP_END);  snap_section_end(&s);
+
+    bool ok = s.ok;
+    if (fclose(f) != 0) ok = false;
+    if (!ok) {
+        log_printf("[SNAPSHOT] write to '%s' failed\n", path);
+        return false;
+    }
+    log_printf("[SNAPSHOT] saved %s (%zu non-zero RAM pages, cycle=%" PRIu64 ")\n",
+               path, pages, vm->cycle);
+    return true;
+}
+
+static bool snap_load_ram(VM* vm, snap_io *s) {
+    uint64_t size = snap_get_u64(s);
+    if (size != vm->ram_size) {
+        log_printf("[SNAPSHOT] RAM size mismatch: snapshot %" PRIu64 ", VM %zu\n",
+                   size, vm->ram_size);
+        return false;
+    }
+    memset(vm->ram, 0, vm->ram_size);
+    for (;;) {
+        uint32_t idx = snap_get_u32(s);
+        if (!s->ok) return false;
+        if (idx == SNAP_RAM_END) return true;
+        uint64_t off = (uint64_t)idx * SNAP_PAGE;
+        if (off >= vm->ram_size) return false;
+        uint8_t page[SNAP_PAGE];
+        snap_get(s, page, SNAP_PAGE);
+        size_t n = vm->ram_size - off < SNAP_PAGE ? (size_t)(vm->ram_size - off) : SNAP_PAGE;
+        memcpy(vm->ram + off, page, n);
+    }
+}
+
+bool vm_snapshot_load(VM* vm, const char* path) {
+    if (!vm || !path || !vm_require_ram(vm, "vm_snapshot_load")) return false;
+    vm_activate(vm);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        log_printf("[SNAPSHOT] cannot open '%s': %s\n", path, strerror(errno));
+        return false;
+    }
+    snap_io s = { .f = f, .ok = true, .sect_start = -1 };
+    char magic[8];
+    snap_get(&s, magic, sizeof magic);
+    uint32_t ver = snap_get_u32(&s);
+    if (!s.ok || memcmp(magic, SNAP_MAGIC, 8) != 0 || ver != SNAP_VERSION) {
+        log_printf("[SNAPSHOT] '%s' is not a version %u snapshot\n", path, SNAP_VERSION);
+        fclose(f);
+        return false;
+    }
+
+    bool ok = true, done = false;
+    while (ok && !done) {
+        uint32_t tag = snap_get_u32(&s);
+        uint32_t len = snap_get_u32(&s);
+        long start = ftell(f);
+        if (!s.ok || start < 0) { ok = false; break; }
+
+        switch (tag) {
+        case SNAP_CPU: {
+            CPU *c = &vm->cpu;
+            memset(c, 0, sizeof *c);
+            for (int i = 0; i < 16; i++) c->r[i] = snap_get_u32(&s);
+            c->cpsr     = snap_get_u32(&s);
+            c->spsr     = snap_get_u32(&s);
+            c->spsr_svc = snap_get_u32(&s);
+            c->lr_svc   = snap_get_u32(&s);
+            c->sp_svc   = snap_get_u32(&s);
+            c->halted   = snap_get_u32(&s) != 0;
+            vm->halted  = snap_get_u32(&s) != 0;
+            if (ftell(f) - start < (long)len) {      // IRQ bank (absent in older files)
+                c->sp_irq   = snap_get_u32(&s);
+                c->lr_irq   = snap_get_u32(&s);
+                c->spsr_irq = snap_get_u32(&s);
+            }
+            cpu = *c;
+            break;
+        }
+        case SNAP_TIME:
+            vm->cycle = snap_get_u64(&s);
+            hw_sched_set_now(snap_get_u64(&s));
+            break;
+        case SNAP_RAM:  ok = snap_load_ram(vm, &s);          break;
+        case SNAP_DSK0: ok = dev_disk0_snapshot_load(&s);    break;
+        case SNAP_RTC:  ok = dev_rtc_snapshot_load(&s);      break;
+        case SNAP_NVRM: ok = dev_nvram_snapshot_load(&s);    break;
+        case SNAP_INTC: ok = dev_intc_snapshot_load(&s);     break;
+        case SNAP_TIMR: ok = dev_timer_snapshot_load(&s);    break;
+        case SNAP_END:  done = true;                         break;
+        default:        break;     // unknown section: skipped below
+        }
+        ok = ok && s.ok && fseek(f, start + (long)len, SEEK_SET) == 0;
+    }
+    fclose(f);
+
+    // RAM was rewritten behind the mem layer's back.
+    tcache_flush();
+    if (!ok || !done) {
+        log_printf("[SNAPSHOT] '%s' is truncated or corrupt; VM state is undefined\n", path);
+        return false;
+    }
+    log_printf("[SNAPSHOT] loaded %s (cycle=%" PRIu64 ")\n", path, vm->cycle);
+    return true;
+}
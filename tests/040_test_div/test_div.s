@@ -0,0 +1,37 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* UDIV / SDIV: quotients round toward zero, divide by zero gives 0,
+       INT_MIN / -1 wraps to INT_MIN. Flags are untouched (CPSR stays 0). */
+    .global _start
+_start:
+    movw    r8, #0x0064
+    movt    r8, #0x0000
+    movw    r9, #0x0007
+    movt    r9, #0x0000
+    udiv    r0, r8, r9
+    movw    r10, #0xFF9C          /* -100 */
+    movt    r10, #0xFFFF
+    sdiv    r1, r10, r9
+    movw    r11, #0xFFF9          /* -7 */
+    movt    r11, #0xFFFF
+    sdiv    r2, r10, r11
+    movw    r12, #0x0000
+    movt    r12, #0x0000
+    udiv    r3, r8, r12
+    sdiv    r4, r10, r12
+    movw    r8, #0x0000
+    movt    r8, #0x8000
+    movw    r9, #0xFFFF
+    movt    r9, #0xFFFF
+    sdiv    r5, r8, r9
+    udiv    r6, r9, r11
+    movw    r10, #0xBEEF
+    movt    r10, #0xDEAD
+    movw    r11, #0x0010
+    movt    r11, #0x0000
+    udiv    r7, r10, r11
+
+    /* halt for harness */
+    bkpt    #0x1234
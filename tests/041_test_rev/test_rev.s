@@ -0,0 +1,23 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* REV, REV16, REVSH (sign-extends the swapped low half) and RBIT on
+       two patterns; r0-r3 from 0x12345678, r4-r7 from 0x80FF01A5. */
+    .global _start
+_start:
+    movw    r8, #0x5678
+    movt    r8, #0x1234
+    movw    r9, #0x01A5
+    movt    r9, #0x80FF
+    rev     r0, r8
+    rev16   r1, r8
+    revsh   r2, r8
+    rbit    r3, r8
+    rev     r4, r9
+    rev16   r5, r9
+    revsh   r6, r9
+    rbit    r7, r9
+
+    /* halt for harness */
+    bkpt    #0x1234
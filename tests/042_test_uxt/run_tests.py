@@ -0,0 +1,89 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_uxt"
+
+CHECKS = [
+    # setup
+    ("Loaded image",  "[LOAD] test_uxt.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+
+    # decoder picked the new rules
+    ("UXTB decode", "[K12] UXTB match"),
+    ("SXTB decode", "[K12] SXTB match"),
+    ("UXTH decode", "[K12] UXTH match"),
+    ("SXTH decode", "[K12] SXTH match"),
+    ("UXT(A)B decode", "[K12] UXT(A)B match"),
+    ("SXT(A)H decode", "[K12] SXT(A)H match"),
+    ("SXT(A)B decode", "[K12] SXT(A)B match"),
+    ("UXT(A)H decode", "[K12] UXT(A)H match"),
+    ("SXT(A)B16 decode", "[K12] SXT(A)B16 match"),
+    ("UXT(A)B16 decode", "[K12] UXT(A)B16 match"),
+
+    # results
+    ("Regs r0", "r0  = 0x000000F3"),
+    ("Regs r1", "r1  = 0xFFFFFFF3"),
+    ("Regs r2", "r2  = 0x0000F2F3"),
+    ("Regs r3", "r3  = 0xFFFFF2F3"),
+    ("Regs r4", "r4  = 0x000000F2"),
+    ("Regs r5", "r5  = 0xFFFF8081"),
+    ("Regs r6", "r6  = 0x0001807F"),
+    ("Regs r7", "r7  = 0x00017FF2"),
+    ("Regs r10", "r10 = 0x000201F1"),
+    ("Regs r11", "r11 = 0xFF80FFF2"),
+    ("Regs r12", "r12 = 0x008280F2"),
+    ("Regs r15 tail", "r15 = 0x0000803C"),
+    ("CPSR line",     "CPSR = 0x00000000"),
+]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
@@ -0,0 +1,26 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Zero/sign extends: the plain forms, ROR #8/#16/#24, the accumulating
+       UXTAB/SXTAB/UXTAH forms and the dual-byte B16 forms. */
+    .global _start
+_start:
+    movw    r8, #0xF2F3
+    movt    r8, #0x8081
+    movw    r9, #0x7FFF
+    movt    r9, #0x0001
+    uxtb    r0, r8
+    sxtb    r1, r8
+    uxth    r2, r8
+    sxth    r3, r8
+    uxtb    r4, r8, ror #8
+    sxth    r5, r8, ror #16
+    uxtab   r6, r9, r8, ror #24
+    sxtab   r7, r9, r8
+    uxtah   r10, r9, r8, ror #8
+    sxtb16  r11, r8, ror #8
+    uxtab16 r12, r9, r8
+
+    /* halt for harness */
+    bkpt    #0x1234
@@ -0,0 +1,22 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* UBFX / SBFX: low byte, mid field, top nibble, single bit and the full
+       32-bit field; SBFX sign-extends from the field's top bit. */
+    .global _start
+_start:
+    movw    r8, #0xD2C3
+    movt    r8, #0xF0E1
+    ubfx    r0, r8, #0, #8
+    ubfx    r1, r8, #4, #12
+    ubfx    r2, r8, #28, #4
+    ubfx    r3, r8, #0, #32
+    sbfx    r4, r8, #0, #8
+    sbfx    r5, r8, #4, #12
+    sbfx    r6, r8, #28, #4
+    sbfx    r7, r8, #1, #1
+    sbfx    r9, r8, #0, #32
+
+    /* halt for harness */
+    bkpt    #0x1234
@@ -0,0 +1,75 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_pkh"
+
+CHECKS = [
+    # setup
+    ("Loaded image",  "[LOAD] test_pkh.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+
+    # decoder picked the new rules
+    ("PKHBT/PKHTB decode", "[K12] PKHBT/PKHTB match"),
+
+    # results
+    ("Regs r0", "r0  = 0x87652222"),
+    ("Regs r1", "r1  = 0xABCD2222"),
+    ("Regs r2", "r2  = 0x765A2222"),
+    ("Regs r3", "r3  = 0x11118765"),
+    ("Regs r4", "r4  = 0x1111FFFF"),
+    ("Regs r5", "r5  = 0x111165AB"),
+    ("Regs r15 tail", "r15 = 0x00008028"),
+    ("CPSR line",     "CPSR = 0x00000000"),
+]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
@@ -0,0 +1,21 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* PKHBT (bottom of Rn, top of Rm LSL) and PKHTB (top of Rn, bottom of
+       Rm ASR, where #32 is encoded as 0). */
+    .global _start
+_start:
+    movw    r8, #0x2222
+    movt    r8, #0x1111
+    movw    r9, #0xABCD
+    movt    r9, #0x8765
+    pkhbt   r0, r8, r9
+    pkhbt   r1, r8, r9, lsl #16
+    pkhbt   r2, r8, r9, lsl #4
+    pkhtb   r3, r8, r9, asr #16
+    pkhtb   r4, r8, r9, asr #32
+    pkhtb   r5, r8, r9, asr #8
+
+    /* halt for harness */
+    bkpt    #0x1234
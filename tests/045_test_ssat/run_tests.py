@@ -0,0 +1,81 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_ssat"
+
+CHECKS = [
+    # setup
+    ("Loaded image",  "[LOAD] test_ssat.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+
+    # decoder picked the new rules
+    ("SSAT decode", "[K12] SSAT match"),
+    ("USAT decode", "[K12] USAT match"),
+    ("SSAT16 decode", "[K12] SSAT16 match"),
+    ("USAT16 decode", "[K12] USAT16 match"),
+
+    # results
+    ("Regs r0", "r0  = 0x0000007F"),
+    ("Regs r1", "r1  = 0xFFFFFF80"),
+    ("Regs r2", "r2  = 0x00001230"),
+    ("Regs r3", "r3  = 0x000000FF"),
+    ("Regs r4", "r4  = 0x00000000"),
+    ("Regs r5", "r5  = 0x0000000F"),
+    ("Regs r6", "r6  = 0x00000000"),
+    ("Regs r7", "r7  = 0x007FFF80"),
+    ("Regs r11", "r11 = 0x00FF0000"),
+    ("Regs r15 tail", "r15 = 0x0000803C"),
+    ("CPSR line",     "CPSR = 0x08000000"),
+]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
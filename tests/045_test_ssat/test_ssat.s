@@ -0,0 +1,26 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* SSAT / USAT with LSL and ASR shifts, SSAT16 / USAT16 per halfword.
+       Clamping sets the sticky Q bit, so CPSR ends as 0x08000000. */
+    .global _start
+_start:
+    movw    r8, #0x0123
+    movt    r8, #0x0000
+    movw    r9, #0xFED4          /* -300 */
+    movt    r9, #0xFFFF
+    movw    r10, #0x8001
+    movt    r10, #0x7FFF
+    ssat    r0, #8, r8
+    ssat    r1, #8, r9
+    ssat    r2, #16, r8, lsl #4
+    usat    r3, #8, r8
+    usat    r4, #8, r9
+    usat    r5, #4, r8, asr #4
+    ssat    r6, #32, r10, asr #32
+    ssat16  r7, #8, r10
+    usat16  r11, #8, r10
+
+    /* halt for harness */
+    bkpt    #0x1234
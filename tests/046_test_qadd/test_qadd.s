@@ -0,0 +1,27 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* QADD / QSUB / QDADD / QDSUB: signed saturating add and subtract,
+       the D forms saturate 2*Rn first. Saturation sets Q (CPSR 0x08000000). */
+    .global _start
+_start:
+    movw    r8, #0xFFF0
+    movt    r8, #0x7FFF
+    movw    r9, #0x0020
+    movt    r9, #0x0000
+    movw    r10, #0x0010
+    movt    r10, #0x8000
+    movw    r11, #0x0005
+    movt    r11, #0x0000
+    qadd    r0, r11, r9
+    qadd    r1, r8, r9
+    qsub    r2, r10, r9
+    qsub    r3, r11, r9
+    qdadd   r4, r11, r9
+    qdadd   r5, r9, r8
+    qdsub   r6, r11, r9
+    qdsub   r7, r9, r10
+
+    /* halt for harness */
+    bkpt    #0x1234
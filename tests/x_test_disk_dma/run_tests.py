@@ -0,0 +1,77 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_disk_dma"
+
+CHECKS = [
+    # setup
+    ("Disk attached", "[DISK] disk0 attached: test_disk_dma.img (4096 bytes)"),
+    ("Loaded image",  "[LOAD] test_disk_dma.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+
+    # the transfer
+    ("DMA command",   "[DISK] CMD write val=0x85 LBA=2 COUNT=3"),
+    ("DMA done",      "[DISK] DMA READ LBA=2 COUNT=3 to 0x00100000 done"),
+
+    # results
+    ("Sector 2",      "r0  = 0xD0020000"),
+    ("Sector 3",      "r1  = 0xD0030000"),
+    ("Sector 4",      "r2  = 0xD0040000"),
+    ("Last word",     "r3  = 0xD004007F"),
+    ("Past the end",  "r4  = 0x00000000"),
+    ("STATUS idle",   "r6  = 0x00000000"),
+    ("Regs r15 tail", "r15 = 0x0000804C"),
+    ("CPSR line",     "CPSR = 0x40000000"),
+]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
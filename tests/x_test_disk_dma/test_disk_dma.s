@@ -0,0 +1,38 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* DMA read of three sectors (LBA 2..4) from test_disk_dma.img into RAM
+       at 0x00100000, polling STATUS until BUSY clears. Every word of the
+       image is 0xD0000000 | sector << 16 | word index.
+
+       r0-r2 = first word of each sector, r3 = last word of the last sector,
+       r4 = word after the transfer (untouched), r6 = final STATUS */
+    .global _start
+_start:
+    movw    r8, #0x0000
+    movt    r8, #0x0B00          /* disk0 */
+    movw    r9, #0x0000
+    movt    r9, #0x0010          /* DMA buffer */
+
+    mov     r1, #2
+    str     r1, [r8, #0x04]      /* LBA */
+    mov     r1, #3
+    str     r1, [r8, #0x08]      /* COUNT */
+    str     r9, [r8, #0x14]      /* DMA address */
+    mov     r1, #0x85
+    str     r1, [r8, #0x0C]      /* CMD: DMA read */
+
+poll:
+    ldr     r6, [r8, #0x10]      /* STATUS */
+    tst     r6, #1
+    bne     poll
+
+    ldr     r0, [r9]
+    ldr     r1, [r9, #0x200]
+    ldr     r2, [r9, #0x400]
+    ldr     r3, [r9, #0x5FC]
+    ldr     r4, [r9, #0x600]
+
+    /* halt for harness */
+    bkpt    #0x1234
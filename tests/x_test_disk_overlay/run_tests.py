@@ -0,0 +1,102 @@
+import subprocess
+import hashlib
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_disk_overlay"
+BASE  = f"{TEST_NAME}.img"
+DELTA = f"{TEST_NAME}.cow"     # created by the run, removed afterwards
+
+CHECKS = [
+    # setup
+    ("Base read-only", "[DISK] disk0 attached: test_disk_overlay.img (4096 bytes) [RO]"),
+    ("Fresh overlay", "[DISK] disk0 overlay: test_disk_overlay.cow (0 sectors written)"),
+    ("Loaded image",  "[LOAD] test_disk_overlay.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+
+    # transfers
+    ("DMA write",     "[DISK] DMA WRITE LBA=1 COUNT=1 from 0x00100000 done"),
+    ("DMA read back", "[DISK] DMA READ LBA=0 COUNT=3 to 0x00110000 done"),
+
+    # guest view: sector 1 from the delta, its neighbours from the base
+    ("Sector 0",      "r0  = 0xE0000000"),
+    ("Written word",  "r1  = 0x0BADC0DE"),
+    ("Rest of sector","r2  = 0xE0010001"),
+    ("Sector 2",      "r3  = 0xE0020000"),
+    ("Regs r15 tail", "r15 = 0x00008094"),
+    ("CPSR line",     "CPSR = 0x40000000"),
+]
+
+def digest(path):
+    with open(path, "rb") as f:
+        return hashlib.sha256(f.read()).hexdigest()
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    if os.path.exists(DELTA):
+        os.remove(DELTA)
+    base_before = digest(BASE)
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    # the guest's write went to the delta, never to the base
+    if digest(BASE) != base_before:
+        print("  ❌ Check failed: base image unchanged")
+        passed = False
+    else:
+        print("  ✅ base image unchanged")
+    delta = open(DELTA, "rb").read() if os.path.exists(DELTA) else b""
+    if bytes.fromhex("DEC0AD0B") not in delta:
+        print("  ❌ Check failed: write stored in the delta")
+        passed = False
+    else:
+        print("  ✅ write stored in the delta")
+    if os.path.exists(DELTA):
+        os.remove(DELTA)
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
@@ -0,0 +1,63 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Copy-on-write overlay: read sector 1, change its first word, DMA it
+       back (the write lands in test_disk_overlay.cow), then read sectors
+       0..2 again. Every word of the base image is 0xE0000000 | sector << 16
+       | word index; run_tests.py checks the base file is unchanged.
+
+       r0 = sector 0 word 0, r1 = sector 1 word 0 (rewritten),
+       r2 = sector 1 word 1, r3 = sector 2 word 0 */
+    .global _start
+_start:
+    movw    r8, #0x0000
+    movt    r8, #0x0B00          /* disk0 */
+    movw    r9, #0x0000
+    movt    r9, #0x0010          /* sector buffer */
+    movw    r10, #0x0000
+    movt    r10, #0x0011         /* read-back buffer */
+
+    /* DMA read LBA 1 */
+    mov     r1, #1
+    str     r1, [r8, #0x04]
+    str     r1, [r8, #0x08]
+    str     r9, [r8, #0x14]
+    mov     r1, #0x85
+    str     r1, [r8, #0x0C]
+wait_read:
+    ldr     r6, [r8, #0x10]
+    tst     r6, #1
+    bne     wait_read
+
+    /* patch word 0, DMA write LBA 1 */
+    movw    r1, #0xC0DE
+    movt    r1, #0x0BAD
+    str     r1, [r9]
+    mov     r1, #0x86
+    str     r1, [r8, #0x0C]
+wait_write:
+    ldr     r6, [r8, #0x10]
+    tst     r6, #1
+    bne     wait_write
+
+    /* DMA read LBA 0..2 */
+    mov     r1, #0
+    str     r1, [r8, #0x04]
+    mov     r1, #3
+    str     r1, [r8, #0x08]
+    str     r10, [r8, #0x14]
+    mov     r1, #0x85
+    str     r1, [r8, #0x0C]
+wait_back:
+    ldr     r6, [r8, #0x10]
+    tst     r6, #1
+    bne     wait_back
+
+    ldr     r0, [r10]
+    ldr     r1, [r10, #0x200]
+    ldr     r2, [r10, #0x204]
+    ldr     r3, [r10, #0x400]
+
+    /* halt for harness */
+    bkpt    #0x1234
@@ -0,0 +1,93 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+
+TEST_NAME = "test_engine_equiv"
+
+# Same image run twice: threaded engine (tcache, fused ops, JIT once the loop
+# is hot) and the step engine as the reference. No per-instruction debug
+# flags, so the threaded run really takes the fast paths.
+RUNS = [
+    ("threaded", f"{TEST_NAME}.script",      f"{TEST_NAME}.log"),
+    ("step",     f"{TEST_NAME}_step.script", f"{TEST_NAME}_step.log"),
+]
+
+CHECKS = [
+    ("Engine threaded", "[CPU] engine set to threaded"),
+    ("Debug off",       "[DEBUG] debug_flags set to 0x00000000"),
+    ("Loaded image",    "[LOAD] test_engine_equiv.bin @ 0x00008000"),
+    ("Checksum r5",     "r5  = 0x96A9E1A0"),
+    ("Last mix r4",     "r4  = 0x12D53C34"),
+    ("Patched mov r9",  "r9  = 0x00000002"),
+    ("SMC passes r10",  "r10 = 0x00000005"),
+    ("Halted at BKPT",  "r15 = 0x000080B0"),
+]
+
+def reg_dump(log):
+    # r0..r15 lines plus the CPSR/cycle line
+    return [l for l in log.splitlines() if l.startswith(("r0 ", "r4 ", "r8 ", "r12 ", "CPSR"))]
+
+def run_vm(script_path, log_path):
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return None
+    if os.path.exists(log_path):
+        os.remove(log_path)
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return None
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return None
+    with open(log_path, "r") as f:
+        return f.read()
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    if not os.path.exists(f"{TEST_NAME}.bin"):
+        print(f"❌ Missing binary: {TEST_NAME}.bin")
+        return False
+
+    logs = {}
+    for engine, script_path, log_path in RUNS:
+        log = run_vm(script_path, log_path)
+        if log is None:
+            return False
+        logs[engine] = log
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in logs["threaded"]:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    fast, ref = reg_dump(logs["threaded"]), reg_dump(logs["step"])
+    if not ref or fast != ref:
+        print("  ❌ Check failed: threaded registers/CPSR match step engine")
+        for a, b in zip(fast, ref):
+            if a != b:
+                print(f"     threaded: {a}\n     step:     {b}")
+        passed = False
+    else:
+        print("  ✅ threaded registers/CPSR match step engine")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
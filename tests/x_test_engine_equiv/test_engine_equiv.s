@@ -0,0 +1,73 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Engine equivalence: the same image under the threaded engine (tcache
+       blocks, MOVW+MOVT / CMP+Bcc / LDR+ADD fused pairs, the word decode
+       memo, JIT once a block is hot) and under the step engine must end
+       with identical registers, CPSR and cycle count.
+       - fill:  64 words of (i*i) ^ 0x5A5AA5A5 at 0x00100000
+       - sum:   checksum them with flag-setting, conditional and carry ops
+                and a call per word (hot enough to be translated)
+       - smc:   rewrite an instruction that already ran; the new one must
+                be picked up (r10 = 1 + 2 + 2) */
+
+    .global _start
+_start:
+    movw    sp, #0x0000
+    movt    sp, #0x0020          /* stack top 0x00200000 */
+    movw    r6, #0x0000
+    movt    r6, #0x0010          /* data base 0x00100000 */
+    mov     r0, #0
+    mov     r5, #0               /* checksum */
+    mov     r10, #0
+    mov     r12, #0
+
+fill:
+    mla     r1, r0, r0, r12
+    movw    r2, #0xA5A5          /* MOVW+MOVT pair */
+    movt    r2, #0x5A5A
+    eor     r1, r1, r2
+    str     r1, [r6, r0, lsl #2]
+    add     r0, r0, #1
+    cmp     r0, #64              /* CMP+Bcc pair */
+    bne     fill
+    mov     r7, r6
+    mov     r0, #64
+
+sum:
+    ldr     r1, [r7]             /* LDR+ADD pair */
+    add     r7, r7, #4
+    add     r5, r5, r1
+    eors    r3, r5, r1, ror #7
+    addmi   r5, r5, #1
+    ldrb    r4, [r7, #-2]
+    adc     r5, r5, r4
+    bl      mix
+    subs    r0, r0, #1
+    bne     sum
+
+smc:
+patch:
+    mov     r9, #1               /* rewritten to #2 below */
+    add     r10, r10, r9
+    movw    r3, #:lower16:patch
+    movt    r3, #:upper16:patch
+    movw    r2, #0x9002
+    movt    r2, #0xE3A0          /* mov r9, #2 */
+    str     r2, [r3]
+    cmp     r10, #5
+    bne     smc                  /* 1 + 2 + 2 */
+    str     r5, [r6, #0x100]
+    b       done
+
+mix:
+    push    {lr}
+    mov     r4, r5, lsr #3
+    teq     r4, r1
+    orrne   r5, r5, #0x100
+    pop     {pc}
+
+done:
+    /* halt for harness */
+    bkpt    #0x1234
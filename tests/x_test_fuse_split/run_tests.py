@@ -0,0 +1,97 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+
+TEST_NAME = "test_fuse_split"
+
+# Same image run three times: threaded engine with the JIT (debug=none),
+# threaded engine on the interpreter (debug=disk logs nothing here but keeps
+# the JIT off) and the step engine, which never fuses, as the reference.
+RUNS = [
+    ("threaded", f"{TEST_NAME}.script",        f"{TEST_NAME}.log"),
+    ("interp",   f"{TEST_NAME}_interp.script", f"{TEST_NAME}_interp.log"),
+    ("step",     f"{TEST_NAME}_step.script",   f"{TEST_NAME}_step.log"),
+]
+
+CHECKS = [
+    ("Engine threaded", "[CPU] engine set to threaded"),
+    ("Debug off",       "[DEBUG] debug_flags set to 0x00000000"),
+    ("Loaded image",    "[LOAD] test_fuse_split.bin @ 0x00008000"),
+    ("Halted at BKPT",  "r15 = 0x000081DC"),
+    ("Checksum",        "r0  = 0xCB1465F1"),
+    ("MOVW+MOVT",       "r2  = 0xDEADBEEF"),
+    ("MOVT entered",    "r3  = 0x567800FF"),
+    ("Loop count",      "r10 = 0x00000100"),
+    ("Cycle count",     "cycle=27404"),
+]
+
+def reg_dump(log):
+    # r0..r15 lines plus the CPSR/cycle line
+    return [l for l in log.splitlines() if l.startswith(("r0 ", "r4 ", "r8 ", "r12 ", "CPSR"))]
+
+def run_vm(script_path, log_path):
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return None
+    if os.path.exists(log_path):
+        os.remove(log_path)
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return None
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return None
+    with open(log_path, "r") as f:
+        return f.read()
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    if not os.path.exists(f"{TEST_NAME}.bin"):
+        print(f"❌ Missing binary: {TEST_NAME}.bin")
+        return False
+
+    logs = {}
+    for engine, script_path, log_path in RUNS:
+        log = run_vm(script_path, log_path)
+        if log is None:
+            return False
+        logs[engine] = log
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in logs["threaded"]:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    ref = reg_dump(logs["step"])
+    for engine in ("threaded", "interp"):
+        fast = reg_dump(logs[engine])
+        if not ref or fast != ref:
+            print(f"  ❌ Check failed: {engine} registers/CPSR match step engine")
+            for a, b in zip(fast, ref):
+                if a != b:
+                    print(f"     {engine}: {a}\n     step:     {b}")
+            passed = False
+        else:
+            print(f"  ✅ {engine} registers/CPSR match step engine")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,144 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Fused pairs split across block boundaries. Blocks hold 32 ops, so
+       each pair below puts its first op in the last slot of the block the
+       even iterations run and its second op at the start of the next one;
+       the odd iterations start one op later and fuse the pair in-block.
+       A periodic timer (LOAD=7, no IRQ) cuts runs at device deadlines,
+       which splits pairs inside blocks too, and one MOVT is also entered
+       by a branch that skips its MOVW. The checksum in r5 must match the
+       step engine, which never fuses. */
+    .global _start
+_start:
+    mov     r5, #0               /* checksum */
+    mov     r10, #0              /* iteration */
+    movw    r7, #0x8000          /* LDR walks the code words */
+    movw    r4, #0x5000
+    movt    r4, #0xF000          /* timer */
+    mov     r1, #7
+    str     r1, [r4]             /* LOAD */
+    mov     r1, #3
+    str     r1, [r4, #8]         /* CTRL: ENABLE | PERIODIC */
+
+loop:
+    mov     r3, r10
+    tst     r10, #1
+    bne     mid                  /* odd iterations enter the pair at MOVT */
+    movw    r3, #0x1234
+mid:
+    movt    r3, #0x5678
+    add     r5, r5, r3
+
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    movw    r2, #0xBEEF          /* op 31 of the block at 0x8030 */
+    movt    r2, #0xDEAD
+    add     r5, r5, r2
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #1
+    cmp     r10, #0x80           /* op 31 of the block at the MOVT */
+    blo     low
+    eor     r5, r5, #0xFF
+
+low:
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #5
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #7
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #2
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #4
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #6
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #1
+    eor     r5, r5, r5, ror #7
+    add     r5, r5, #3
+    eor     r5, r5, r5, ror #7
+    ldr     r1, [r7]             /* op 31 of the block at low */
+    add     r7, r7, #4
+    add     r5, r5, r1
+    and     r7, r7, #0xFF
+    orr     r7, r7, #0x8000
+
+    add     r10, r10, #1
+    cmp     r10, #0x100
+    bne     loop
+
+    mov     r0, r5
+    ldr     r11, [r4, #0x10]     /* NOW_LO */
+
+    /* halt for harness */
+    bkpt    #0x1234
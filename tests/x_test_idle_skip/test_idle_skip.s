@@ -0,0 +1,29 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Idle poll: start a one-shot timer for 2,000,000 cycles and spin on
+       STATUS until it expires. The threaded engine fast-forwards the loop
+       to just before the expiry, the step engine runs every iteration; the
+       registers, the clock read after the loop (r2 = NOW_LO) and the cycle
+       count must come out the same. */
+    .global _start
+_start:
+    movw    r4, #0x5000
+    movt    r4, #0xF000          /* timer */
+    movw    r1, #0x8480
+    movt    r1, #0x001E          /* 2000000 */
+    str     r1, [r4]             /* LOAD */
+    mov     r1, #1
+    str     r1, [r4, #8]         /* CTRL: ENABLE, one-shot, no IRQ */
+
+poll:
+    ldr     r0, [r4, #0x0C]      /* STATUS */
+    tst     r0, #1
+    beq     poll
+
+    ldr     r2, [r4, #0x10]      /* NOW_LO */
+    ldr     r3, [r4, #8]         /* CTRL: ENABLE cleared */
+
+    /* halt for harness */
+    bkpt    #0x1234
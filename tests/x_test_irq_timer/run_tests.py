@@ -0,0 +1,82 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_irq_timer"
+
+CHECKS = [
+    # setup
+    ("Loaded image",  "[LOAD] test_irq_timer.bin @ 0x00008000"),
+    ("PC start",      "r15 <= 0x00008000"),
+    ("WFI decode",    "[K12] WFI match"),
+
+    # IRQ entry through the vector, return to the insn after WFI
+    ("Vector fetch",  "[LDR lit] pc <= [0x00000038] => 0x00008064"),
+    ("Resumed",       "[TRACE] PC=0x00008054 Instr=0xE594600C"),
+
+    # handler view
+    ("IAR line 0",    "r0  = 0x00000000"),
+    ("Banked LR",     "r8  = 0x00008058"),
+    ("IRQ mode",      "r9  = 0x00000092"),
+    ("SPSR",          "r10 = 0x00000000"),
+    ("One IRQ",       "r11 = 0x00000001"),
+
+    # after return
+    ("Timer one-shot", "r3  = 0x00000004"),
+    ("INTC ACTIVE",   "r6  = 0x00000000"),
+    ("INTC PENDING",  "r7  = 0x00000000"),
+    ("LR not banked", "r14 = 0x0000AAAA"),
+    ("Regs r15 tail", "r15 = 0x00008060"),
+    ("CPSR line",     "CPSR = 0x00000000"),
+]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
@@ -0,0 +1,59 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* One-shot timer IRQ through the interrupt controller: program the
+       timer for 1000 cycles, enable line 0 (IRQ_TIMER0), sleep in WFI, take
+       the IRQ, acknowledge it through IAR/EOIR, clear the timer and return
+       with SUBS PC, LR, #4.
+
+       r8  = banked LR seen in the handler (after_wfi + 4)
+       r9  = CPSR in the handler (IRQ mode, I set)
+       r10 = SPSR in the handler (the interrupted CPSR)
+       r11 = number of IRQs taken
+       r14 = 0x0000AAAA: the interrupted mode's LR is untouched */
+    .global _start
+_start:
+    /* vector 0x18: ldr pc, [pc, #0x18] loads the handler address from 0x38 */
+    mov     r0, #0x18
+    movw    r1, #0xF018
+    movt    r1, #0xE59F
+    str     r1, [r0]
+    movw    r1, #:lower16:irq_handler
+    movt    r1, #:upper16:irq_handler
+    str     r1, [r0, #0x20]
+
+    movw    lr, #0xAAAA
+    mov     r11, #0
+    movw    r4, #0x4000
+    movt    r4, #0xF000          /* INTC */
+    movw    r5, #0x5000
+    movt    r5, #0xF000          /* timer */
+
+    mov     r1, #1
+    str     r1, [r4, #0x10]      /* ENABLE_SET: line 0 */
+    str     r1, [r4]             /* CTRL: forward to the CPU */
+    mov     r1, #1000
+    str     r1, [r5]             /* LOAD */
+    mov     r1, #5
+    str     r1, [r5, #8]         /* CTRL: ENABLE | IRQ_EN, one-shot */
+    wfi
+
+after_wfi:
+    ldr     r6, [r4, #0x0C]      /* ACTIVE: 0 after EOIR */
+    ldr     r7, [r4, #0x08]      /* PENDING: 0, line dropped */
+    ldr     r3, [r5, #8]         /* CTRL: one-shot cleared ENABLE */
+
+    /* halt for harness */
+    bkpt    #0x1234
+
+irq_handler:
+    ldr     r0, [r4, #0x20]      /* IAR: line 0, now active */
+    mov     r1, #1
+    str     r1, [r5, #0x0C]      /* STATUS: clear EXPIRED, line goes low */
+    str     r0, [r4, #0x24]      /* EOIR */
+    mov     r8, lr
+    mrs     r9, cpsr
+    mrs     r10, spsr
+    add     r11, r11, #1
+    subs    pc, lr, #4
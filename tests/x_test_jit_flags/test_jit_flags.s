@@ -0,0 +1,27 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* A hot loop (100 passes, past JIT_HOT) around a compare-class word
+       with S clear. The interpreter's TST/TEQ/CMP/CMN set the flags
+       whatever S says; a translated block has to do the same. The threaded
+       engine (tcache + JIT) must end with exactly the step engine's
+       registers and CPSR. */
+
+    .global _start
+_start:
+    mov     r11, #0
+    mov     r13, #100
+    mov     r8, #0
+
+loop:
+    subs    r13, r13, #1          /* N=0 Z=0 C=1 until the last pass */
+    mov     r1, #0x80000000
+    .word   0xE128F001            /* msr APSR_nzcvq, r1: decodes as TEQ r8, r1 (S=0) */
+    mrs     r12, apsr             /* flags the compare left */
+    add     r11, r11, r12
+    cmp     r13, #0
+    bne     loop
+
+    /* halt for harness */
+    bkpt    #0x0000
@@ -0,0 +1,86 @@
+import subprocess
+import os
+import sys
+
+VM = "arm-vm.exe"
+TEST_NAME = "test_snapshot"
+SNAP = f"{TEST_NAME}.snap"     # written by the run, removed afterwards
+
+CHECKS = [
+    # setup
+    ("Loaded image",  "[LOAD] test_snapshot.bin @ 0x00008000"),
+    ("Saved",         "[SNAPSHOT] saved test_snapshot.snap (2 non-zero RAM pages, cycle=50)"),
+    ("Loaded",        "[SNAPSHOT] loaded test_snapshot.snap (cycle=50)"),
+
+    # both runs end here
+    ("Loop count",    "r0  = 0x00000064"),
+    ("Guest clock",   "r2  = 0x000002C1"),
+    ("RAM word",      "r3  = 0xF7B6BCD6"),
+    ("Regs r15 tail", "r15 = 0x00008038"),
+    ("CPSR line",     "CPSR = 0x60000000  cycle=708"),
+]
+
+def reg_dumps(log):
+    # one r0/r4/r8/r12/CPSR block per "regs"
+    lines = [l for l in log.splitlines() if l.startswith(("r0 ", "r4 ", "r8 ", "r12 ", "CPSR"))]
+    return [lines[i:i + 5] for i in range(0, len(lines), 5)]
+
+def run_test():
+    print(f"Running {TEST_NAME}...")
+
+    script_path = f"{TEST_NAME}.script"
+    bin_path = f"{TEST_NAME}.bin"
+    log_path = f"{TEST_NAME}.log"
+
+    if not os.path.exists(script_path):
+        print(f"❌ Missing script: {script_path}")
+        return False
+
+    if not os.path.exists(bin_path):
+        print(f"❌ Missing binary: {bin_path}")
+        return False
+
+    try:
+        subprocess.run(
+            [VM],
+            stdin=open(script_path, "r"),
+            stdout=subprocess.PIPE,
+            stderr=subprocess.STDOUT,
+            text=True
+        )
+    except FileNotFoundError:
+        print(f"❌ Error: '{VM}' not found in PATH.")
+        return False
+
+    if not os.path.exists(log_path):
+        print(f"❌ Missing log file: {log_path}")
+        return False
+
+    with open(log_path, "r") as f:
+        log = f.read()
+
+    passed = True
+    for label, expected in CHECKS:
+        if expected not in log:
+            print(f"  ❌ Check failed: {label}")
+            print(f"     Missing: {expected}")
+            passed = False
+        else:
+            print(f"  ✅ {label}")
+
+    # the run after "snapshot load" repeats the one after "snapshot save"
+    dumps = reg_dumps(log)
+    if len(dumps) != 2 or dumps[0] != dumps[1]:
+        print("  ❌ Check failed: run after load matches run after save")
+        passed = False
+    else:
+        print("  ✅ run after load matches run after save")
+    if os.path.exists(SNAP):
+        os.remove(SNAP)
+
+    print(f"{TEST_NAME}: {'✅ passed' if passed else '❌ failed'}\n")
+    return passed
+
+if __name__ == "__main__":
+    success = run_test()
+    sys.exit(0 if success else 1)
\ No newline at end of file
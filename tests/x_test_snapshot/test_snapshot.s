@@ -0,0 +1,30 @@
+    .syntax unified
+    .arch armv7-a
+    .arm
+
+    /* Snapshot round trip: the script steps 50 instructions into the loop,
+       saves a snapshot, runs to the end, loads the snapshot and runs again.
+       Both runs must end with the same registers, the same RAM word (r3)
+       and the same guest clock (r2 = timer NOW_LO). */
+    .global _start
+_start:
+    movw    r6, #0x0000
+    movt    r6, #0x0010          /* accumulator in RAM */
+    movw    r4, #0x5000
+    movt    r4, #0xF000          /* timer */
+    mov     r0, #0
+
+loop:
+    ldr     r1, [r6]
+    add     r1, r1, r0
+    eor     r1, r1, r1, lsl #5
+    str     r1, [r6]
+    add     r0, r0, #1
+    cmp     r0, #100
+    bne     loop
+
+    ldr     r2, [r4, #0x10]      /* NOW_LO */
+    ldr     r3, [r6]
+
+    /* halt for harness */
+    bkpt    #0x1234